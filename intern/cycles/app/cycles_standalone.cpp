@@ -20,6 +20,7 @@
 #include "scene/camera.h"
 #include "scene/integrator.h"
 #include "scene/scene.h"
+#include "scene/stats.h"
 #include "session/buffers.h"
 #include "session/session.h"
 
@@ -55,6 +56,7 @@ struct Options {
   SceneParams scene_params;
   SessionParams session_params;
   bool quiet;
+  bool server;
   bool show_help, interactive, pause;
   string output_filepath;
   string output_pass;
@@ -125,14 +127,18 @@ static void scene_init()
   options.scene->camera->compute_auto_viewplane();
 }
 
-static void session_init()
+static void session_create()
 {
   options.output_pass = "combined";
   options.session = new Session(options.session_params, options.scene_params);
 
   if (!options.output_filepath.empty()) {
-    options.session->set_output_driver(make_unique<OIIOOutputDriver>(
-        options.output_filepath, options.output_pass, session_print));
+    unique_ptr<OIIOOutputDriver> output_driver = make_unique<OIIOOutputDriver>(
+        options.output_filepath, options.output_pass, session_print);
+    if (options.session_params.use_tile_streaming) {
+      output_driver->set_streaming_tile_size(options.session_params.tile_size);
+    }
+    options.session->set_output_driver(move(output_driver));
   }
 
   if (options.session_params.background && !options.quiet)
@@ -149,14 +155,35 @@ static void session_init()
   Pass *pass = options.scene->create_node<Pass>();
   pass->set_name(ustring(options.output_pass.c_str()));
   pass->set_type(PASS_COMBINED);
+}
+
+static void session_init()
+{
+  session_create();
 
   options.session->reset(options.session_params, session_buffer_params());
   options.session->start();
 }
 
+static void session_print_stats(FILE *file)
+{
+  if (!options.session_params.use_profiling) {
+    return;
+  }
+
+  RenderStats stats;
+  options.session->collect_statistics(&stats);
+  fprintf(file, "Render statistics:\n%s\n", stats.full_report().c_str());
+}
+
 static void session_exit()
 {
   if (options.session) {
+    /* Server mode prints statistics after every job instead. */
+    if (options.session_params.background && !options.server) {
+      session_print_stats(stdout);
+    }
+
     delete options.session;
     options.session = NULL;
   }
@@ -167,6 +194,156 @@ static void session_exit()
   }
 }
 
+/* Server Mode
+ *
+ * Render jobs are read line by line from standard input, so that the session, scene, images,
+ * BVH and loaded kernels are reused between frames instead of paying for them in a new process
+ * each time. Every job may apply an XML file with changes to the scene, for example an updated
+ * camera or integrator, and writes to its own output file:
+ *
+ *   render output=frame.exr [scene=changes.xml] [samples=N] [width=W] [height=H]
+ *   quit
+ *
+ * One status line per job is written to standard output, other messages go to standard error. */
+
+static void server_print(const string &str)
+{
+  fprintf(stderr, "%s\n", str.c_str());
+}
+
+static bool server_render_job(const vector<string> &tokens, string &output, string &error)
+{
+  string scene_filepath;
+  int samples = options.session_params.samples;
+  int width = options.width, height = options.height;
+
+  output = options.output_filepath;
+
+  for (size_t i = 1; i < tokens.size(); i++) {
+    const size_t separator = tokens[i].find('=');
+    if (separator == string::npos) {
+      error = "invalid argument \"" + tokens[i] + "\"";
+      return false;
+    }
+
+    const string key = tokens[i].substr(0, separator);
+    const string value = tokens[i].substr(separator + 1);
+
+    if (key == "scene") {
+      scene_filepath = value;
+    }
+    else if (key == "output") {
+      output = value;
+    }
+    else if (key == "samples") {
+      samples = atoi(value.c_str());
+    }
+    else if (key == "width") {
+      width = atoi(value.c_str());
+    }
+    else if (key == "height") {
+      height = atoi(value.c_str());
+    }
+    else {
+      error = "unknown argument \"" + key + "\"";
+      return false;
+    }
+  }
+
+  if (output.empty()) {
+    error = "no output file path specified";
+    return false;
+  }
+  if (samples <= 0 || width <= 0 || height <= 0) {
+    error = "invalid number of samples or resolution";
+    return false;
+  }
+  if (!scene_filepath.empty() && !path_exists(scene_filepath)) {
+    error = "scene file \"" + scene_filepath + "\" not found";
+    return false;
+  }
+
+  /* Apply changes to the scene, only modified nodes are updated on the device. */
+  {
+    thread_scoped_lock scene_lock(options.scene->mutex);
+
+    if (!scene_filepath.empty()) {
+      xml_read_file(options.scene, scene_filepath.c_str());
+    }
+
+    options.width = width;
+    options.height = height;
+
+    Camera *cam = options.scene->camera;
+    cam->set_full_width(options.width);
+    cam->set_full_height(options.height);
+    cam->compute_auto_viewplane();
+    cam->need_flags_update = true;
+    cam->need_device_update = true;
+  }
+
+  unique_ptr<OIIOOutputDriver> output_driver = make_unique<OIIOOutputDriver>(
+      output, options.output_pass, server_print);
+  if (options.session_params.use_tile_streaming) {
+    output_driver->set_streaming_tile_size(options.session_params.tile_size);
+  }
+  options.session->set_output_driver(move(output_driver));
+
+  options.session_params.samples = samples;
+  options.session->progress.reset();
+  options.session->reset(options.session_params, session_buffer_params());
+  options.session->start();
+  options.session->wait();
+
+  if (options.session->progress.get_error()) {
+    error = options.session->progress.get_error_message();
+    return false;
+  }
+
+  return true;
+}
+
+static void server_run()
+{
+  session_create();
+
+  char line[4096];
+  int job = 0;
+
+  while (fgets(line, sizeof(line), stdin)) {
+    vector<string> tokens;
+    string_split(tokens, line, " \t\r\n");
+
+    if (tokens.empty()) {
+      continue;
+    }
+    else if (tokens[0] == "quit") {
+      break;
+    }
+    else if (tokens[0] != "render") {
+      printf("error unknown command \"%s\"\n", tokens[0].c_str());
+      fflush(stdout);
+      continue;
+    }
+
+    const double start_time = time_dt();
+    string output, error;
+
+    if (server_render_job(tokens, output, error)) {
+      session_print_stats(stderr);
+      printf("done %d %s %.2f\n", job, output.c_str(), time_dt() - start_time);
+    }
+    else {
+      printf("error %d %s\n", job, error.c_str());
+    }
+    fflush(stdout);
+
+    job++;
+  }
+
+  session_exit();
+}
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
 static void display_info(Progress &progress)
 {
@@ -354,6 +531,7 @@ static void options_parse(int argc, const char **argv)
   options.filepath = "";
   options.session = NULL;
   options.quiet = false;
+  options.server = false;
   options.session_params.use_auto_tile = false;
   options.session_params.tile_size = 0;
 
@@ -378,6 +556,8 @@ static void options_parse(int argc, const char **argv)
   ArgParse ap;
   bool help = false, debug = false, version = false;
   int verbosity = 1;
+  int texture_cache_size = 0;
+  string bvh_refit = "instanced";
 
   ap.options("Usage: cycles [options] file.xml",
              "%*",
@@ -397,6 +577,10 @@ static void options_parse(int argc, const char **argv)
              "--quiet",
              &options.quiet,
              "In background mode, don't print progress messages",
+             "--server",
+             &options.server,
+             "Keep running and read render jobs from standard input, reusing the scene between "
+             "jobs",
              "--samples %d",
              &options.session_params.samples,
              "Number of samples to render",
@@ -415,6 +599,37 @@ static void options_parse(int argc, const char **argv)
              "--tile-size %d",
              &options.session_params.tile_size,
              "Tile size in pixels",
+             "--tile-streaming",
+             &options.session_params.use_tile_streaming,
+             "Write tiles to a tiled OpenEXR output file as they finish, without keeping the full "
+             "frame in memory (requires --tile-size)",
+             "--bvh-refit %s",
+             &bvh_refit,
+             "BVH refit policy: never, instanced, topology",
+             "--bvh-cache",
+             &options.scene_params.use_bvh_disk_cache,
+             "Reuse geometry BVHs from the disk cache across frames and sessions",
+             "--texture-cache-size %d",
+             &texture_cache_size,
+             "Load textures on demand with a tiled cache of this size in megabytes (CPU only)",
+             "--texture-disk-cache",
+             &options.scene_params.use_texture_disk_cache,
+             "Memory map textures from the disk cache instead of loading image files (CPU only)",
+             "--compact-mesh",
+             &options.scene_params.use_compact_mesh,
+             "Store mesh vertex positions and normals quantized, to reduce memory usage (CPU only, "
+             "uses BVH2 instead of Embree)",
+             "--tessellation-cache",
+             &options.scene_params.use_tessellation_cache,
+             "Reuse diced and displaced meshes across frames while the dicing camera changes less "
+             "than the tolerance",
+             "--tessellation-cache-tolerance %f",
+             &options.scene_params.tessellation_cache_tolerance,
+             "Relative change in on-screen size below which cached tessellation is reused",
+             "--profile",
+             &options.session_params.use_profiling,
+             "Collect per-kernel time, ray counts and shader evaluations and print them after "
+             "rendering (CPU only)",
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -476,10 +691,33 @@ static void options_parse(int argc, const char **argv)
   options.session_params.background = true;
 #endif
 
+  if (options.server) {
+    /* Standard output is used for job status. */
+    options.session_params.background = true;
+    options.quiet = true;
+  }
+
   if (options.session_params.tile_size > 0) {
     options.session_params.use_auto_tile = true;
   }
 
+  if (options.session_params.use_tile_streaming && options.session_params.tile_size <= 0) {
+    fprintf(stderr, "Tile streaming requires a tile size\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (bvh_refit == "never")
+    options.scene_params.bvh_refit_policy = BVH_REFIT_NEVER;
+  else if (bvh_refit == "instanced")
+    options.scene_params.bvh_refit_policy = BVH_REFIT_INSTANCED;
+  else if (bvh_refit == "topology")
+    options.scene_params.bvh_refit_policy = BVH_REFIT_TOPOLOGY_UNCHANGED;
+
+  if (texture_cache_size > 0) {
+    options.scene_params.use_texture_cache = true;
+    options.scene_params.texture_cache_size = texture_cache_size;
+  }
+
   /* find matching device */
   DeviceType device_type = Device::type_from_string(devicename.c_str());
   vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK(device_type));
@@ -506,6 +744,10 @@ static void options_parse(int argc, const char **argv)
     exit(EXIT_FAILURE);
   }
 #endif
+  else if (!(bvh_refit == "never" || bvh_refit == "instanced" || bvh_refit == "topology")) {
+    fprintf(stderr, "Unknown BVH refit policy: %s\n", bvh_refit.c_str());
+    exit(EXIT_FAILURE);
+  }
   else if (options.session_params.samples < 0) {
     fprintf(stderr, "Invalid number of samples: %d\n", options.session_params.samples);
     exit(EXIT_FAILURE);
@@ -526,6 +768,11 @@ int main(int argc, const char **argv)
   path_init();
   options_parse(argc, argv);
 
+  if (options.server) {
+    server_run();
+    return 0;
+  }
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (options.session_params.background) {
 #endif
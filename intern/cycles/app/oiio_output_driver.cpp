@@ -16,6 +16,8 @@
 
 #include "app/oiio_output_driver.h"
 
+#include "session/tile.h"
+
 CCL_NAMESPACE_BEGIN
 
 OIIOOutputDriver::OIIOOutputDriver(const string_view filepath,
@@ -27,15 +29,30 @@ OIIOOutputDriver::OIIOOutputDriver(const string_view filepath,
 
 OIIOOutputDriver::~OIIOOutputDriver()
 {
+  /* Rendering could have been canceled before all tiles were written. */
+  close_streaming_output();
+}
+
+void OIIOOutputDriver::set_streaming_tile_size(const int tile_size)
+{
+  streaming_tile_size_ = tile_size;
 }
 
 void OIIOOutputDriver::write_render_tile(const Tile &tile)
 {
-  /* Only write the full buffer, no intermediate tiles. */
-  if (!(tile.size == tile.full_size)) {
+  if (tile.size == tile.full_size) {
+    write_full_image(tile);
     return;
   }
 
+  /* Only write the full buffer, no intermediate tiles, unless streaming. */
+  if (streaming_tile_size_ > 0) {
+    write_streaming_tile(tile);
+  }
+}
+
+void OIIOOutputDriver::write_full_image(const Tile &tile)
+{
   log_(string_printf("Writing image %s", filepath_.c_str()));
 
   unique_ptr<ImageOutput> image_output(ImageOutput::create(filepath_));
@@ -68,4 +85,117 @@ void OIIOOutputDriver::write_render_tile(const Tile &tile)
   image_output->close();
 }
 
+bool OIIOOutputDriver::open_streaming_output(const Tile &tile)
+{
+  log_(string_printf("Writing tiled image %s", filepath_.c_str()));
+
+  streaming_output_ = unique_ptr<ImageOutput>(ImageOutput::create(filepath_));
+  if (streaming_output_ == nullptr) {
+    log_("Failed to create image file");
+    return false;
+  }
+
+  if (!streaming_output_->supports("tiles")) {
+    log_("Image format does not support tiles, use an OpenEXR output file for tile streaming");
+    streaming_output_ = nullptr;
+    return false;
+  }
+
+  const int width = tile.full_size.x;
+  const int height = tile.full_size.y;
+
+  /* The render tile size is a multiple of the image tile size, see
+   * TileManager::compute_render_tile_size(). */
+  const int image_tile_size = min(TileManager::IMAGE_TILE_SIZE, streaming_tile_size_);
+
+  /* Render tiles are laid out from the bottom of the image, and the image is written top-down.
+   * Extend the data window above the display window, so that image tile boundaries match the
+   * flipped render tile boundaries. */
+  streaming_pad_y_ = int(align_up(height, image_tile_size)) - height;
+
+  ImageSpec spec(width, height + streaming_pad_y_, 4, TypeDesc::FLOAT);
+  spec.y = -streaming_pad_y_;
+  spec.full_x = 0;
+  spec.full_y = 0;
+  spec.full_width = width;
+  spec.full_height = height;
+  spec.tile_width = image_tile_size;
+  spec.tile_height = image_tile_size;
+  /* Tiles arrive bottom-up and in any order with multiple devices. OpenEXR keeps tiles that are
+   * written out of the file line order in memory until they can be flushed, which with the default
+   * increasing Y order would be nearly the full frame. */
+  spec.attribute("openexr:lineOrder", "randomY");
+
+  if (!streaming_output_->open(filepath_, spec)) {
+    log_("Failed to create image file");
+    streaming_output_ = nullptr;
+    return false;
+  }
+
+  streaming_num_pixels_written_ = 0;
+
+  return true;
+}
+
+void OIIOOutputDriver::close_streaming_output()
+{
+  if (!streaming_output_) {
+    return;
+  }
+
+  streaming_output_->close();
+  streaming_output_ = nullptr;
+}
+
+void OIIOOutputDriver::write_streaming_tile(const Tile &tile)
+{
+  if (!streaming_output_) {
+    if (!open_streaming_output(tile)) {
+      return;
+    }
+  }
+
+  const int width = tile.size.x;
+  const int height = tile.size.y;
+
+  vector<float> tile_pixels(width * height * 4);
+  if (!tile.get_pass_pixels(pass_, 4, tile_pixels.data())) {
+    log_("Failed to read render pass pixels");
+    return;
+  }
+
+  /* Convert from bottom-up to top-down convention. The top-most tiles also cover the padding rows
+   * of the data window, which are left black. */
+  const int x_begin = tile.offset.x;
+  const int y_end = tile.full_size.y - tile.offset.y;
+  const int y_begin = (y_end == height) ? -streaming_pad_y_ : y_end - height;
+  const int num_rows = y_end - y_begin;
+
+  vector<float> pixels(width * num_rows * 4, 0.0f);
+  for (int y = 0; y < height; y++) {
+    const float *src = tile_pixels.data() + y * width * 4;
+    float *dst = pixels.data() + (num_rows - 1 - y) * width * 4;
+    memcpy(dst, src, sizeof(float) * width * 4);
+  }
+
+  if (!streaming_output_->write_tiles(x_begin,
+                                      x_begin + width,
+                                      y_begin,
+                                      y_end,
+                                      0,
+                                      1,
+                                      TypeDesc::FLOAT,
+                                      pixels.data())) {
+    log_(string_printf("Failed to write tile: %s", streaming_output_->geterror().c_str()));
+    return;
+  }
+
+  /* Close the file once all tiles are written, so that it is complete on disk without waiting for
+   * the driver to be destroyed. */
+  streaming_num_pixels_written_ += int64_t(width) * height;
+  if (streaming_num_pixels_written_ >= int64_t(tile.full_size.x) * tile.full_size.y) {
+    close_streaming_output();
+  }
+}
+
 CCL_NAMESPACE_END
@@ -31,12 +31,31 @@ class OIIOOutputDriver : public OutputDriver {
   OIIOOutputDriver(const string_view filepath, const string_view pass, LogFunction log);
   virtual ~OIIOOutputDriver();
 
+  /* Write render tiles into a tiled image as they finish, instead of only writing the full frame.
+   * The tile size must be the one passed to the session, so that render tiles are aligned on the
+   * tiles of the image file. */
+  void set_streaming_tile_size(const int tile_size);
+
   void write_render_tile(const Tile &tile) override;
 
  protected:
+  void write_full_image(const Tile &tile);
+  void write_streaming_tile(const Tile &tile);
+
+  bool open_streaming_output(const Tile &tile);
+  void close_streaming_output();
+
   string filepath_;
   string pass_;
   LogFunction log_;
+
+  /* Streaming output state. */
+  int streaming_tile_size_ = 0;
+  unique_ptr<ImageOutput> streaming_output_;
+  /* Number of rows added at the top of the data window, so that flipped render tiles are aligned
+   * on image tile boundaries. */
+  int streaming_pad_y_ = 0;
+  int64_t streaming_num_pixels_written_ = 0;
 };
 
 CCL_NAMESPACE_END
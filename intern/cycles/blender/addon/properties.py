@@ -61,6 +61,14 @@ enum_bvh_types = (
     ('STATIC_BVH', "Static BVH", "Any object modification requires a complete BVH rebuild, but renders faster"),
 )
 
+enum_bvh_refit_policies = (
+    ('NEVER', "Never", "Always rebuild the BVH of modified geometry"),
+    ('INSTANCED', "Instanced", "Refit the BVH of instanced geometry when its topology did not change"),
+    ('TOPOLOGY_UNCHANGED', "Topology Unchanged",
+     "Refit the BVH of any geometry when its topology did not change, keeping deforming geometry instanced "
+     "in a static BVH. Faster updates of deforming objects in animations, at the cost of slightly slower render time"),
+)
+
 enum_filter_types = (
     ('BOX', "Box", "Box filter"),
     ('GAUSSIAN', "Gaussian", "Gaussian filter"),
@@ -392,6 +400,27 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default=0.01,
     )
 
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Sample lights by their estimated contribution to the shading point using a hierarchy of lights, "
+        "instead of by area and count only. Reduces noise in scenes with many lights, at the cost of slower light selection",
+        default=False,
+    )
+
+    use_guiding: BoolProperty(
+        name="Path Guiding",
+        description="Learn the distribution of incoming light while rendering and use it to guide bounce directions. "
+        "Reduces noise in scenes with difficult indirect lighting, such as interiors lit through small openings "
+        "(CPU only)",
+        default=False,
+    )
+    guiding_probability: FloatProperty(
+        name="Guiding Probability",
+        description="Probability of sampling a bounce direction from the learned light distribution instead of the BSDF",
+        min=0.0, max=0.95,
+        default=0.5,
+    )
+
     use_adaptive_sampling: BoolProperty(
         name="Use Adaptive Sampling",
         description="Automatically reduce the number of samples per pixel based on estimated noise level",
@@ -576,6 +605,22 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default=4.0,
     )
 
+    use_tessellation_cache: BoolProperty(
+        name="Tessellation Cache",
+        description="Reuse diced and displaced meshes from the previous update when the mesh, its displacement "
+        "shaders and dicing rate are unchanged, and the camera moved only a little. Final renders of an animation "
+        "only reuse them between frames with Persistent Data enabled",
+        default=False,
+    )
+    tessellation_cache_tolerance: FloatProperty(
+        name="Tessellation Cache Tolerance",
+        description="Reuse cached tessellation as long as the size of the geometry on screen changed by less than "
+        "this fraction. Zero only reuses it when the dicing camera is unchanged",
+        min=0.0, max=1.0,
+        default=0.1,
+        subtype='FACTOR',
+    )
+
     film_exposure: FloatProperty(
         name="Exposure",
         description="Image brightness scale",
@@ -657,6 +702,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_bvh_types,
         default='DYNAMIC_BVH',
     )
+    bvh_refit_policy: EnumProperty(
+        name="BVH Refit",
+        description="When to refit the BVH of modified geometry instead of rebuilding it",
+        items=enum_bvh_refit_policies,
+        default='INSTANCED',
+    )
     debug_use_spatial_splits: BoolProperty(
         name="Use Spatial Splits",
         description="Use BVH spatial splits: longer builder time, faster render",
@@ -667,6 +718,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Use special type BVH optimized for hair (uses more ram but renders faster)",
         default=True,
     )
+    use_bvh_disk_cache: BoolProperty(
+        name="Use BVH Disk Cache",
+        description="Store geometry BVHs on disk and reuse them for unchanged geometry in following frames and renders. "
+        "Not used for Embree and OptiX",
+        default=False,
+    )
     debug_bvh_time_steps: IntProperty(
         name="BVH Time Steps",
         description="Split BVH primitives by this number of time steps to speed up render time in cost of memory",
@@ -805,6 +862,27 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=8, max=16384,
     )
 
+    use_texture_cache: BoolProperty(
+        name="Use Texture Cache",
+        description="Load image textures on demand in tiles when rendering on the CPU, keeping texture memory within the cache size",
+        default=False,
+    )
+
+    texture_cache_size: IntProperty(
+        name="Texture Cache Size",
+        description="Maximum memory used by image texture tiles, in megabytes",
+        default=4096,
+        min=64, max=1048576,
+        subtype='UNSIGNED',
+    )
+
+    use_texture_disk_cache: BoolProperty(
+        name="Use Texture Disk Cache",
+        description="Store image textures converted for rendering on disk, and memory map them in following renders instead of loading the image files. "
+        "Only used for CPU rendering",
+        default=False,
+    )
+
     # Various fine-tuning debug flags
 
     def _devices_update_callback(self, context):
@@ -822,6 +900,11 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_bvh_layouts,
         default='EMBREE',
     )
+    debug_use_cpu_wavefront: BoolProperty(
+        name="Wavefront",
+        description="Batch paths by the next kernel to execute instead of tracing one path at a time",
+        default=False,
+    )
 
     debug_use_cuda_adaptive_compile: BoolProperty(name="Adaptive Compile", default=False)
 
@@ -314,6 +314,14 @@ class CYCLES_RENDER_PT_sampling_advanced(CyclesButtonsPanel, Panel):
         col.prop(cscene, "min_light_bounces")
         col.prop(cscene, "min_transparent_bounces")
         col.prop(cscene, "light_sampling_threshold", text="Light Threshold")
+        col.prop(cscene, "use_light_tree")
+
+        col = layout.column(align=True)
+        col.active = use_cpu(context)
+        col.prop(cscene, "use_guiding")
+        sub = col.column(align=True)
+        sub.active = cscene.use_guiding
+        sub.prop(cscene, "guiding_probability", text="Probability")
 
         for view_layer in scene.view_layers:
             if view_layer.samples > 0:
@@ -350,6 +358,13 @@ class CYCLES_RENDER_PT_subdivision(CyclesButtonsPanel, Panel):
 
         col.prop(cscene, "dicing_camera")
 
+        col.separator()
+
+        col.prop(cscene, "use_tessellation_cache")
+        sub = col.column()
+        sub.active = cscene.use_tessellation_cache
+        sub.prop(cscene, "tessellation_cache_tolerance", text="Tolerance")
+
 
 class CYCLES_RENDER_PT_hair(CyclesButtonsPanel, Panel):
     bl_label = "Hair"
@@ -662,6 +677,16 @@ class CYCLES_RENDER_PT_performance_memory(CyclesButtonsPanel, Panel):
         sub.active = cscene.use_auto_tile
         sub.prop(cscene, "tile_size")
 
+        col = layout.column()
+        col.active = use_cpu(context)
+        col.prop(cscene, "use_texture_cache")
+        sub = col.column()
+        sub.active = cscene.use_texture_cache
+        sub.prop(cscene, "texture_cache_size")
+        sub = col.column()
+        sub.active = not cscene.use_texture_cache
+        sub.prop(cscene, "use_texture_disk_cache")
+
 
 class CYCLES_RENDER_PT_performance_acceleration_structure(CyclesButtonsPanel, Panel):
     bl_label = "Acceleration Structure"
@@ -691,9 +716,11 @@ class CYCLES_RENDER_PT_performance_acceleration_structure(CyclesButtonsPanel, Pa
         sub = col.column()
         sub.active = not use_embree
         sub.prop(cscene, "debug_use_hair_bvh")
+        sub.prop(cscene, "use_bvh_disk_cache")
         sub = col.column()
         sub.active = not cscene.debug_use_spatial_splits and not use_embree
         sub.prop(cscene, "debug_bvh_time_steps")
+        col.prop(cscene, "bvh_refit_policy")
 
 
 class CYCLES_RENDER_PT_performance_final_render(CyclesButtonsPanel, Panel):
@@ -1839,6 +1866,7 @@ class CYCLES_RENDER_PT_debug(CyclesDebugButtonsPanel, Panel):
         row.prop(cscene, "debug_use_cpu_avx", toggle=True)
         row.prop(cscene, "debug_use_cpu_avx2", toggle=True)
         col.prop(cscene, "debug_bvh_layout", text="BVH")
+        col.prop(cscene, "debug_use_cpu_wavefront")
 
         col.separator()
 
@@ -223,6 +223,8 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
     return;
   }
 
+  VLOG(1) << "Reusing session with persistent data, only updated data will be synchronized.";
+
   session->progress.reset();
 
   /* peak memory usage should show current render peak, not peak for all renders
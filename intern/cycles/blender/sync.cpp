@@ -129,18 +129,7 @@ void BlenderSync::sync_recalc(BL::Depsgraph &b_depsgraph, BL::SpaceView3D &b_v3d
 
     if (dicing_prop_changed) {
       has_updates_ = true;
-
-      for (const pair<const GeometryKey, Geometry *> &iter : geometry_map.key_to_scene_data()) {
-        Geometry *geom = iter.second;
-        if (geom->is_mesh()) {
-          Mesh *mesh = static_cast<Mesh *>(geom);
-          if (mesh->get_subdivision_type() != Mesh::SUBDIVISION_NONE) {
-            PointerRNA id_ptr;
-            RNA_id_pointer_create((::ID *)iter.first.id, &id_ptr);
-            geometry_map.set_recalc(BL::ID(id_ptr));
-          }
-        }
-      }
+      tag_subdivision_geometry_recalc();
     }
   }
 
@@ -277,6 +266,14 @@ void BlenderSync::sync_data(BL::RenderSettings &b_render,
   sync_shaders(b_depsgraph, b_v3d);
   sync_images();
 
+  /* The dicing camera is synced before the data. Meshes diced for an older dicing camera are
+   * diced again, which the tessellation cache skips when the camera moved only a little, for
+   * example between frames of an animation rendered with persistent data. */
+  if (experimental && scene->params.use_tessellation_cache &&
+      scene->dicing_camera->is_modified()) {
+    tag_subdivision_geometry_recalc();
+  }
+
   geometry_synced.clear(); /* use for objects and motion sync */
 
   if (scene->need_motion() == Scene::MOTION_PASS || scene->need_motion() == Scene::MOTION_NONE ||
@@ -298,6 +295,21 @@ void BlenderSync::sync_data(BL::RenderSettings &b_render,
   has_updates_ = false;
 }
 
+void BlenderSync::tag_subdivision_geometry_recalc()
+{
+  for (const pair<const GeometryKey, Geometry *> &iter : geometry_map.key_to_scene_data()) {
+    Geometry *geom = iter.second;
+    if (geom->is_mesh()) {
+      Mesh *mesh = static_cast<Mesh *>(geom);
+      if (mesh->get_subdivision_type() != Mesh::SUBDIVISION_NONE) {
+        PointerRNA id_ptr;
+        RNA_id_pointer_create((::ID *)iter.first.id, &id_ptr);
+        geometry_map.set_recalc(BL::ID(id_ptr));
+      }
+    }
+  }
+}
+
 /* Integrator */
 
 void BlenderSync::sync_integrator(BL::ViewLayer &b_view_layer, bool background)
@@ -349,6 +361,10 @@ void BlenderSync::sync_integrator(BL::ViewLayer &b_view_layer, bool background)
   }
 
   integrator->set_light_sampling_threshold(get_float(cscene, "light_sampling_threshold"));
+  integrator->set_use_light_tree(get_boolean(cscene, "use_light_tree"));
+
+  integrator->set_use_guiding(get_boolean(cscene, "use_guiding"));
+  integrator->set_guiding_probability(get_float(cscene, "guiding_probability"));
 
   SamplingPattern sampling_pattern = (SamplingPattern)get_enum(
       cscene, "sampling_pattern", SAMPLING_NUM_PATTERNS, SAMPLING_PATTERN_SOBOL);
@@ -786,9 +802,12 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
   else
     params.bvh_type = BVH_TYPE_DYNAMIC;
 
+  params.bvh_refit_policy = (BVHRefitPolicy)get_enum(
+      cscene, "bvh_refit_policy", BVH_NUM_REFIT_POLICIES, BVH_REFIT_INSTANCED);
   params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
   params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
+  params.use_bvh_disk_cache = RNA_boolean_get(&cscene, "use_bvh_disk_cache");
 
   PointerRNA csscene = RNA_pointer_get(&b_scene.ptr, "cycles_curves");
   params.hair_subdivisions = get_int(csscene, "subdivisions");
@@ -809,6 +828,13 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  params.use_texture_cache = get_boolean(cscene, "use_texture_cache");
+  params.texture_cache_size = get_int(cscene, "texture_cache_size");
+  params.use_texture_disk_cache = get_boolean(cscene, "use_texture_disk_cache");
+
+  params.use_tessellation_cache = get_boolean(cscene, "use_tessellation_cache");
+  params.tessellation_cache_tolerance = get_float(cscene, "tessellation_cache_tolerance");
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
@@ -187,6 +187,9 @@ class BlenderSync {
                             bool use_particle_hair,
                             TaskPool *task_pool);
 
+  /* Export meshes with adaptive subdivision again, so that they are diced again. */
+  void tag_subdivision_geometry_recalc();
+
   /* Light */
   void sync_light(BL::Object &b_parent,
                   int persistent_id[OBJECT_PERSISTENT_ID_SIZE],
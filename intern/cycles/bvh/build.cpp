@@ -77,6 +77,8 @@ void BVHBuild::add_reference_triangles(BoundBox &root,
   if (mesh->has_motion_blur()) {
     attr_mP = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
   }
+  /* Bounds must contain the quantized vertex positions the kernel intersects. */
+  const float3 pad = (params.use_compact_mesh) ? mesh->compact_verts_error() : zero_float3();
   const size_t num_triangles = mesh->num_triangles();
   for (uint j = 0; j < num_triangles; j++) {
     Mesh::Triangle t = mesh->get_triangle(j);
@@ -85,6 +87,7 @@ void BVHBuild::add_reference_triangles(BoundBox &root,
       BoundBox bounds = BoundBox::empty;
       t.bounds_grow(verts, bounds);
       if (bounds.valid() && t.valid(verts)) {
+        bounds = BoundBox(bounds.min - pad, bounds.max + pad);
         references.push_back(BVHReference(bounds, j, object_index, primitive_type));
         root.grow(bounds);
         center.grow(bounds.center2());
@@ -105,6 +108,7 @@ void BVHBuild::add_reference_triangles(BoundBox &root,
         t.bounds_grow(vert_steps + step * num_verts, bounds);
       }
       if (bounds.valid()) {
+        bounds = BoundBox(bounds.min - pad, bounds.max + pad);
         references.push_back(BVHReference(bounds, j, object_index, primitive_type));
         root.grow(bounds);
         center.grow(bounds.center2());
@@ -142,6 +146,7 @@ void BVHBuild::add_reference_triangles(BoundBox &root,
         BoundBox bounds = prev_bounds;
         bounds.grow(curr_bounds);
         if (bounds.valid()) {
+          bounds = BoundBox(bounds.min - pad, bounds.max + pad);
           const float prev_time = (float)(bvh_step - 1) * num_bvh_steps_inv_1;
           references.push_back(
               BVHReference(bounds, j, object_index, primitive_type, prev_time, curr_time));
@@ -22,6 +22,7 @@
 #include "scene/object.h"
 
 #include "bvh/build.h"
+#include "bvh/cache.h"
 #include "bvh/node.h"
 #include "bvh/unaligned.h"
 
@@ -48,6 +49,16 @@ BVH2::BVH2(const BVHParams &params_,
 
 void BVH2::build(Progress &progress, Stats *)
 {
+  /* Reuse BVH from the disk cache if the geometry did not change. */
+  const string cache_key = (params.use_disk_cache) ? bvh_cache_key(params, objects) : "";
+  if (!cache_key.empty()) {
+    progress.set_substatus("Reading BVH from cache");
+    if (bvh_cache_read(cache_key, pack)) {
+      pack_primitives();
+      return;
+    }
+  }
+
   progress.set_substatus("Building BVH");
 
   /* build nodes */
@@ -96,6 +107,10 @@ void BVH2::build(Progress &progress, Stats *)
 
   /* free build nodes */
   root->deleteSubtree();
+
+  if (!cache_key.empty()) {
+    bvh_cache_write(cache_key, pack);
+  }
 }
 
 void BVH2::refit(Progress &progress)
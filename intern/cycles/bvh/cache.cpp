@@ -0,0 +1,292 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bvh/cache.h"
+#include "bvh/bvh.h"
+#include "bvh/params.h"
+
+#include "scene/hair.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+
+#include "util/foreach.h"
+#include "util/log.h"
+#include "util/md5.h"
+#include "util/path.h"
+#include "util/system.h"
+#include "util/thread.h"
+#include "util/time.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Increase when the packed BVH layout or the builder changes, so that old cache files are no
+ * longer used. */
+#define BVH_CACHE_VERSION 1
+#define BVH_CACHE_MAGIC 0x48564243 /* "CBVH" */
+/* Total size of cache files, least recently used files are removed beyond it. */
+#define BVH_CACHE_MAX_SIZE (4ull * 1024 * 1024 * 1024)
+
+/* Key */
+
+static void hash_data(MD5Hash &hash, const void *data, size_t size)
+{
+  /* MD5Hash takes an int size, split large arrays into chunks. */
+  const uint8_t *bytes = (const uint8_t *)data;
+  while (size > 0) {
+    const int chunk_size = (int)std::min(size, (size_t)(1 << 30));
+    hash.append(bytes, chunk_size);
+    bytes += chunk_size;
+    size -= chunk_size;
+  }
+}
+
+template<typename T> static void hash_value(MD5Hash &hash, const T value)
+{
+  hash_data(hash, &value, sizeof(value));
+}
+
+template<typename T> static void hash_array(MD5Hash &hash, const array<T> &data)
+{
+  hash_value(hash, (uint64_t)data.size());
+  hash_data(hash, data.data(), sizeof(T) * data.size());
+}
+
+/* Only hash the XYZ components, the padding of float3 is not guaranteed to be initialized. */
+static void hash_float3(MD5Hash &hash, const float3 *data, size_t size)
+{
+  hash_value(hash, (uint64_t)size);
+
+  float buffer[3 * 1024];
+  while (size > 0) {
+    const size_t chunk_size = std::min(size, (size_t)1024);
+    for (size_t i = 0; i < chunk_size; i++) {
+      buffer[i * 3 + 0] = data[i].x;
+      buffer[i * 3 + 1] = data[i].y;
+      buffer[i * 3 + 2] = data[i].z;
+    }
+    hash_data(hash, buffer, sizeof(float) * 3 * chunk_size);
+    data += chunk_size;
+    size -= chunk_size;
+  }
+}
+
+static void hash_motion_attribute(MD5Hash &hash, const Geometry *geom)
+{
+  const Attribute *attr = (geom->has_motion_blur()) ?
+                              geom->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION) :
+                              NULL;
+
+  hash_value(hash, (attr != NULL));
+  if (attr) {
+    hash_value(hash, (uint)geom->get_motion_steps());
+    if (attr->type == TypeDesc::TypeFloat4) {
+      hash_value(hash, (uint64_t)attr->buffer.size());
+      hash_data(hash, attr->data(), attr->buffer.size());
+    }
+    else {
+      hash_float3(hash, attr->data_float3(), attr->buffer.size() / sizeof(float3));
+    }
+  }
+}
+
+string bvh_cache_key(const BVHParams &params, const vector<Object *> &objects)
+{
+  /* Only geometry level BVH2 is cached, the top level BVH depends on object transforms that
+   * typically change every frame and is fast to build. */
+  if (params.top_level || params.bvh_layout != BVH_LAYOUT_BVH2) {
+    return "";
+  }
+
+  MD5Hash hash;
+
+  hash_value(hash, (int)BVH_CACHE_VERSION);
+  hash_value(hash, (int)sizeof(void *));
+
+  hash_value(hash, params.use_spatial_split);
+  hash_value(hash, params.spatial_split_alpha);
+  hash_value(hash, params.unaligned_split_threshold);
+  hash_value(hash, params.sah_node_cost);
+  hash_value(hash, params.sah_primitive_cost);
+  hash_value(hash, params.min_leaf_size);
+  hash_value(hash, params.max_triangle_leaf_size);
+  hash_value(hash, params.max_motion_triangle_leaf_size);
+  hash_value(hash, params.max_curve_leaf_size);
+  hash_value(hash, params.max_motion_curve_leaf_size);
+  hash_value(hash, params.use_unaligned_nodes);
+  hash_value(hash, params.num_motion_curve_steps);
+  hash_value(hash, params.num_motion_triangle_steps);
+  hash_value(hash, params.use_compact_mesh);
+
+  foreach (const Object *ob, objects) {
+    const Geometry *geom = ob->get_geometry();
+
+    hash_value(hash, ob->visibility_for_tracing());
+    hash_value(hash, (int)geom->geometry_type);
+    hash_value(hash, (int)geom->primitive_type());
+
+    if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
+      const Mesh *mesh = static_cast<const Mesh *>(geom);
+      hash_float3(hash, mesh->get_verts().data(), mesh->get_verts().size());
+      hash_array(hash, mesh->get_triangles());
+    }
+    else if (geom->geometry_type == Geometry::HAIR) {
+      const Hair *hair = static_cast<const Hair *>(geom);
+      hash_float3(hash, hair->get_curve_keys().data(), hair->get_curve_keys().size());
+      hash_array(hash, hair->get_curve_radius());
+      hash_array(hash, hair->get_curve_first_key());
+    }
+    else {
+      return "";
+    }
+
+    hash_motion_attribute(hash, geom);
+  }
+
+  return hash.get_hex();
+}
+
+/* Read and Write */
+
+static string bvh_cache_filepath(const string &key)
+{
+  return path_cache_get(path_join("bvh", "bvh2_" + key + ".bin"));
+}
+
+template<typename T> static void write_array(vector<uint8_t> &binary, const array<T> &data)
+{
+  const uint64_t size = data.size();
+  const uint8_t *size_bytes = (const uint8_t *)&size;
+  binary.insert(binary.end(), size_bytes, size_bytes + sizeof(size));
+
+  const uint8_t *bytes = (const uint8_t *)data.data();
+  binary.insert(binary.end(), bytes, bytes + sizeof(T) * data.size());
+}
+
+template<typename T>
+static bool read_array(const vector<uint8_t> &binary, size_t &offset, array<T> &data)
+{
+  uint64_t size;
+  if (offset + sizeof(size) > binary.size()) {
+    return false;
+  }
+  memcpy(&size, &binary[offset], sizeof(size));
+  offset += sizeof(size);
+
+  if (size > (binary.size() - offset) / sizeof(T)) {
+    return false;
+  }
+
+  data.resize(size);
+  if (size) {
+    memcpy(data.data(), &binary[offset], sizeof(T) * size);
+  }
+  offset += sizeof(T) * size;
+
+  return true;
+}
+
+bool bvh_cache_read(const string &key, PackedBVH &pack)
+{
+  const double start_time = time_dt();
+  const string filepath = bvh_cache_filepath(key);
+
+  vector<uint8_t> binary;
+  if (!path_read_binary(filepath, binary)) {
+    return false;
+  }
+
+  int header[3];
+  if (binary.size() < sizeof(header)) {
+    return false;
+  }
+  memcpy(header, &binary[0], sizeof(header));
+  if (header[0] != BVH_CACHE_MAGIC || header[1] != BVH_CACHE_VERSION) {
+    return false;
+  }
+
+  size_t offset = sizeof(header);
+  if (!(read_array(binary, offset, pack.nodes) && read_array(binary, offset, pack.leaf_nodes) &&
+        read_array(binary, offset, pack.prim_type) &&
+        read_array(binary, offset, pack.prim_index) &&
+        read_array(binary, offset, pack.prim_object) &&
+        read_array(binary, offset, pack.prim_time)) ||
+      offset != binary.size()) {
+    VLOG(1) << "Invalid BVH cache file " << filepath << ", ignoring.";
+    pack = PackedBVH();
+    return false;
+  }
+
+  pack.root_index = header[2];
+
+  /* Mark as recently used, so that it is the last to be removed when trimming the cache. */
+  path_touch(filepath);
+
+  VLOG(2) << "Read BVH from cache " << filepath << " in " << time_dt() - start_time
+          << " seconds.";
+  return true;
+}
+
+bool bvh_cache_write(const string &key, const PackedBVH &pack)
+{
+  const string filepath = bvh_cache_filepath(key);
+
+  const int header[3] = {BVH_CACHE_MAGIC, BVH_CACHE_VERSION, pack.root_index};
+  vector<uint8_t> binary((const uint8_t *)header, (const uint8_t *)header + sizeof(header));
+  write_array(binary, pack.nodes);
+  write_array(binary, pack.leaf_nodes);
+  write_array(binary, pack.prim_type);
+  write_array(binary, pack.prim_index);
+  write_array(binary, pack.prim_object);
+  write_array(binary, pack.prim_time);
+
+  /* Write to a temporary file first, so that other threads or processes never see a partially
+   * written file. Identical geometry may be written from multiple threads at once. */
+  static thread_mutex counter_mutex;
+  static int counter = 0;
+  string temp_filepath;
+  {
+    thread_scoped_lock lock(counter_mutex);
+    temp_filepath = string_printf(
+        "%s.%d.%d.tmp", filepath.c_str(), (int)system_self_process_id(), counter++);
+  }
+
+  if (!path_write_binary(temp_filepath, binary)) {
+    VLOG(1) << "Failed to write BVH cache file " << filepath << ".";
+    path_remove(temp_filepath);
+    return false;
+  }
+
+  if (!path_rename(temp_filepath, filepath)) {
+    /* File may already exist on platforms where rename does not replace it. */
+    path_remove(temp_filepath);
+    return path_exists(filepath);
+  }
+
+  VLOG(2) << "Wrote BVH to cache " << filepath << ", " << string_human_readable_size(binary.size())
+          << ".";
+
+  /* Keep the cache size bounded. Only one thread scans the directory at a time, others skip it
+   * since the cache will be trimmed again after the next write anyway. */
+  static thread_mutex trim_mutex;
+  thread_scoped_lock trim_lock(trim_mutex, std::try_to_lock);
+  if (trim_lock.owns_lock()) {
+    path_cache_trim(path_dirname(filepath), BVH_CACHE_MAX_SIZE);
+  }
+
+  return true;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BVH_CACHE_H__
+#define __BVH_CACHE_H__
+
+#include "util/string.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class BVHParams;
+class Object;
+struct PackedBVH;
+
+/* BVH Disk Cache
+ *
+ * Packed BVH2 structures of geometry are stored in the cache directory, keyed by a hash of
+ * the build parameters and geometry data. This way geometry that did not change does not
+ * need to be built again for following frames and render sessions. */
+
+/* Compute key for the BVH of the given objects, empty if the BVH can not be cached. */
+string bvh_cache_key(const BVHParams &params, const vector<Object *> &objects);
+
+/* Read and write packed BVH for the given key. Arrays derived from object settings like
+ * primitive visibility are not stored and must be filled in after reading. */
+bool bvh_cache_read(const string &key, PackedBVH &pack);
+bool bvh_cache_write(const string &key, const PackedBVH &pack);
+
+CCL_NAMESPACE_END
+
+#endif /* __BVH_CACHE_H__ */
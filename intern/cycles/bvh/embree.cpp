@@ -702,6 +702,10 @@ void BVHEmbree::refit(Progress &progress)
         Mesh *mesh = static_cast<Mesh *>(geom);
         if (mesh->num_triangles() > 0) {
           RTCGeometry geom = rtcGetGeometry(scene, geom_id);
+          if (!params.top_level && params.bvh_refit_policy == BVH_REFIT_TOPOLOGY_UNCHANGED) {
+            /* Static scenes are fully rebuilt on commit otherwise. */
+            rtcSetGeometryBuildQuality(geom, RTC_BUILD_QUALITY_REFIT);
+          }
           set_tri_vertex_buffer(geom, mesh, true);
           rtcSetGeometryUserData(geom, (void *)mesh->prim_offset);
           rtcCommitGeometry(geom);
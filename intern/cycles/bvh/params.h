@@ -52,6 +52,21 @@ enum BVHType {
   BVH_NUM_TYPES,
 };
 
+enum BVHRefitPolicy {
+  /* Always rebuild the BVH of modified geometry. */
+  BVH_REFIT_NEVER = 0,
+  /* Refit the BVH of instanced geometry when its topology did not change. Geometry that has
+   * its transform applied for a static BVH is part of the scene BVH, and so is still rebuilt
+   * with the scene BVH. */
+  BVH_REFIT_INSTANCED = 1,
+  /* Same as above, but also keep geometry that only deforms instanced in a static BVH, so its
+   * BVH can be refit instead of rebuilding it as part of the scene BVH. Meant for animations
+   * with deforming characters, where vertex positions change but topology does not. */
+  BVH_REFIT_TOPOLOGY_UNCHANGED = 2,
+
+  BVH_NUM_REFIT_POLICIES,
+};
+
 /* Names bitflag type to denote which BVH layouts are supported by
  * particular area.
  *
@@ -108,10 +123,18 @@ class BVHParams {
 
   /* Same as in SceneParams. */
   int bvh_type;
+  int bvh_refit_policy;
 
   /* These are needed for Embree. */
   int curve_subdivisions;
 
+  /* Read and write geometry level BVH2 from the disk cache. */
+  bool use_disk_cache;
+
+  /* Mesh vertex positions are quantized for rendering, pad triangle bounds by the
+   * quantization error. Spatial splits are not supported with this. */
+  bool use_compact_mesh;
+
   /* fixed parameters */
   enum { MAX_DEPTH = 64, MAX_SPATIAL_DEPTH = 48, NUM_SPATIAL_BINS = 32 };
 
@@ -141,8 +164,12 @@ class BVHParams {
     num_motion_triangle_steps = 0;
 
     bvh_type = 0;
+    bvh_refit_policy = BVH_REFIT_INSTANCED;
 
     curve_subdivisions = 4;
+
+    use_disk_cache = false;
+    use_compact_mesh = false;
   }
 
   /* SAH costs */
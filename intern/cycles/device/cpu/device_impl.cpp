@@ -255,7 +255,9 @@ void CPUDevice::tex_alloc(device_texture &mem)
   }
 
   texture_info[slot] = mem.info;
-  texture_info[slot].data = (uint64_t)mem.host_pointer;
+  if (!mem.info.use_cache) {
+    texture_info[slot].data = (uint64_t)mem.host_pointer;
+  }
   need_texture_info = true;
 }
 
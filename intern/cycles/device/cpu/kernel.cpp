@@ -35,6 +35,7 @@ CPUKernels::CPUKernels()
       REGISTER_KERNEL(integrator_init_from_camera),
       REGISTER_KERNEL(integrator_init_from_bake),
       REGISTER_KERNEL(integrator_intersect_closest),
+      REGISTER_KERNEL(integrator_intersect_closest_packet),
       REGISTER_KERNEL(integrator_intersect_shadow),
       REGISTER_KERNEL(integrator_intersect_subsurface),
       REGISTER_KERNEL(integrator_intersect_volume_stack),
@@ -42,6 +43,7 @@ CPUKernels::CPUKernels()
       REGISTER_KERNEL(integrator_shade_light),
       REGISTER_KERNEL(integrator_shade_shadow),
       REGISTER_KERNEL(integrator_shade_surface),
+      REGISTER_KERNEL(integrator_shade_surface_raytrace),
       REGISTER_KERNEL(integrator_shade_volume),
       REGISTER_KERNEL(integrator_megakernel),
       /* Shader evaluation. */
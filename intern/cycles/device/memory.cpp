@@ -160,7 +160,7 @@ device_texture::device_texture(Device *device,
                                ImageDataType image_data_type,
                                InterpolationType interpolation,
                                ExtensionType extension)
-    : device_memory(device, name, MEM_TEXTURE), slot(slot)
+    : device_memory(device, name, MEM_TEXTURE), slot(slot), host_external_(false)
 {
   switch (image_data_type) {
     case IMAGE_DATA_TYPE_FLOAT4:
@@ -211,7 +211,7 @@ device_texture::device_texture(Device *device,
 device_texture::~device_texture()
 {
   device_free();
-  host_free();
+  host_release();
 }
 
 /* Host memory allocation. */
@@ -219,9 +219,9 @@ void *device_texture::alloc(const size_t width, const size_t height, const size_
 {
   const size_t new_size = size(width, height, depth);
 
-  if (new_size != data_size) {
+  if (new_size != data_size || host_external_) {
     device_free();
-    host_free();
+    host_release();
     host_pointer = host_alloc(data_elements * datatype_size(data_type) * new_size);
     assert(device_pointer == 0);
   }
@@ -238,9 +238,43 @@ void *device_texture::alloc(const size_t width, const size_t height, const size_
   return host_pointer;
 }
 
+void device_texture::alloc_external(void *pixels,
+                                    const size_t width,
+                                    const size_t height,
+                                    const size_t depth)
+{
+  assert(device_is_cpu());
+
+  device_free();
+  host_release();
+
+  host_pointer = pixels;
+  host_external_ = true;
+
+  data_size = size(width, height, depth);
+  data_width = width;
+  data_height = height;
+  data_depth = depth;
+
+  info.width = width;
+  info.height = height;
+  info.depth = depth;
+}
+
 void device_texture::copy_to_device()
 {
   device_copy_to();
 }
 
+void device_texture::host_release()
+{
+  if (host_external_) {
+    host_pointer = 0;
+    host_external_ = false;
+  }
+  else {
+    host_free();
+  }
+}
+
 CCL_NAMESPACE_END
@@ -620,10 +620,22 @@ class device_texture : public device_memory {
   void *alloc(const size_t width, const size_t height, const size_t depth = 0);
   void copy_to_device();
 
+  /* Use memory owned by someone else as host memory, for example a memory mapped file. It is
+   * not freed by the texture, and must remain valid until the texture is freed or reallocated.
+   * Only for the CPU device, which reads textures directly from host memory. */
+  void alloc_external(void *pixels,
+                      const size_t width,
+                      const size_t height,
+                      const size_t depth = 0);
+
   uint slot;
   TextureInfo info;
 
  protected:
+  bool host_external_;
+
+  void host_release();
+
   size_t size(const size_t width, const size_t height, const size_t depth)
   {
     return width * ((height == 0) ? 1 : height) * ((depth == 0) ? 1 : depth);
@@ -33,6 +33,13 @@ CCL_NAMESPACE_BEGIN
 
 thread_mutex OIDNDenoiser::mutex_;
 
+#ifdef WITH_OPENIMAGEDENOISE
+/* Upper bound of the memory used by a single OIDN filter execution. Images which need more memory
+ * are denoised by the library in overlapping tiles, so that denoising of huge frames does not
+ * allocate network buffers proportional to the frame size. */
+static const int OIDN_MAX_MEMORY_MB = 2048;
+#endif
+
 OIDNDenoiser::OIDNDenoiser(Device *path_trace_device, const DenoiseParams &params)
     : Denoiser(path_trace_device, params)
 {
@@ -178,6 +185,7 @@ class OIDNDenoiseContext {
     oidn_filter.setProgressMonitorFunction(oidn_progress_monitor_function, denoiser_);
     oidn_filter.set("hdr", true);
     oidn_filter.set("srgb", false);
+    oidn_filter.set("maxMemoryMB", OIDN_MAX_MEMORY_MB);
     if (denoise_params_.prefilter == DENOISER_PREFILTER_NONE ||
         denoise_params_.prefilter == DENOISER_PREFILTER_ACCURATE) {
       oidn_filter.set("cleanAux", true);
@@ -211,6 +219,7 @@ class OIDNDenoiseContext {
     oidn::FilterRef oidn_filter = oidn_device.newFilter("RT");
     set_pass(oidn_filter, oidn_pass);
     set_output_pass(oidn_filter, oidn_pass);
+    oidn_filter.set("maxMemoryMB", OIDN_MAX_MEMORY_MB);
     oidn_filter.commit();
     oidn_filter.execute();
 
@@ -62,6 +62,9 @@ PathTrace::PathTrace(Device *device,
   work_balance_infos_.resize(path_trace_works_.size());
   work_balance_do_initial(work_balance_infos_);
 
+  work_stealing_buffers_.resize(path_trace_works_.size() * path_trace_works_.size());
+  work_stealing_buffers_used_.resize(work_stealing_buffers_.size(), false);
+
   render_scheduler.set_need_schedule_rebalance(path_trace_works_.size() > 1);
 }
 
@@ -197,6 +200,8 @@ void PathTrace::render_pipeline(RenderWork render_work)
     return;
   }
 
+  update_guiding_field(render_work);
+
   adaptive_sample(render_work);
   if (render_cancel_.is_requested) {
     return;
@@ -372,28 +377,71 @@ void PathTrace::path_trace(RenderWork &render_work)
   const double start_time = time_dt();
 
   const int num_works = path_trace_works_.size();
+  const int num_samples = render_work.path_trace.num_samples;
+  const int sample_offset = render_work.path_trace.sample_offset;
+  const bool use_stealing = use_work_stealing();
 
-  tbb::parallel_for(0, num_works, [&](int i) {
-    const double work_start_time = time_dt();
-    const int num_samples = render_work.path_trace.num_samples;
+  vector<int64_t> num_pixels(num_works);
+  for (int i = 0; i < num_works; i++) {
+    const BufferParams &params = path_trace_works_[i]->get_effective_buffer_params();
+    num_pixels[i] = int64_t(params.width) * params.height;
+  }
+  work_stealing_scheduler_.reset(
+      num_pixels, render_work.path_trace.start_sample, num_samples, use_stealing);
 
+  tbb::parallel_for(0, num_works, [&](int i) {
     PathTraceWork *path_trace_work = path_trace_works_[i].get();
-
     PathTraceWork::RenderStatistics statistics;
-    path_trace_work->render_samples(statistics,
-                                    render_work.path_trace.start_sample,
-                                    num_samples,
-                                    render_work.path_trace.sample_offset);
 
+    /* Render samples of the own slice first. */
+    const double work_start_time = time_dt();
+    int work_num_samples = 0;
+    int start_sample, samples_num;
+    while (work_stealing_scheduler_.get_work(i, &start_sample, &samples_num)) {
+      path_trace_work->render_samples(statistics, start_sample, samples_num, sample_offset);
+      work_num_samples += samples_num;
+    }
     const double work_time = time_dt() - work_start_time;
-    work_balance_infos_[i].time_spent += work_time;
+
+    /* Balancing compares the time the works need to render the same number of samples of their
+     * slices, so extrapolate the time when some of the samples were stolen. */
+    if (work_num_samples) {
+      work_balance_infos_[i].time_spent += work_time * num_samples / work_num_samples;
+    }
     work_balance_infos_[i].occupancy = statistics.occupancy;
 
-    VLOG(3) << "Rendered " << num_samples << " samples in " << work_time << " seconds ("
-            << work_time / num_samples
+    VLOG(3) << "Rendered " << work_num_samples << " samples in " << work_time << " seconds ("
+            << work_time / max(work_num_samples, 1)
             << " seconds per sample), occupancy: " << statistics.occupancy;
+
+    /* Help works which are still busy. */
+    double steal_time = 0.0;
+    if (use_stealing && path_trace_work->supports_work_stealing()) {
+      const double steal_start_time = time_dt();
+      int victim_index;
+      while (!is_cancel_requested() &&
+             work_stealing_scheduler_.steal_work(i, &victim_index, &start_sample, &samples_num)) {
+        PathTraceWork::RenderStatistics steal_statistics;
+        path_trace_work->render_samples_stolen(
+            steal_statistics,
+            work_stealing_buffers_get(i, victim_index),
+            path_trace_works_[victim_index]->get_effective_buffer_params(),
+            start_sample,
+            samples_num,
+            sample_offset);
+      }
+      steal_time = time_dt() - steal_start_time;
+    }
+
+    work_stealing_scheduler_.add_busy_time(i, work_time + steal_time);
   });
 
+  work_stealing_scheduler_.end_round(time_dt() - start_time);
+
+  if (use_stealing) {
+    work_stealing_accumulate();
+  }
+
   float occupancy_accum = 0.0f;
   for (const WorkBalanceInfo &balance_info : work_balance_infos_) {
     occupancy_accum += balance_info.occupancy;
@@ -405,6 +453,56 @@ void PathTrace::path_trace(RenderWork &render_work)
       render_work, time_dt() - start_time, is_cancel_requested());
 }
 
+void PathTrace::update_guiding_field(const RenderWork &render_work)
+{
+  if (!render_work.path_trace.num_samples || !device_scene_->data.integrator.use_guiding) {
+    return;
+  }
+
+  const double start_time = time_dt();
+
+  /* Guiding is only enabled for CPU devices, where the training data written by the kernels
+   * lives in host memory, so it can be read back without a device copy. */
+  const float *training = device_scene_->guiding_training.data();
+  float *field = device_scene_->guiding_field.data();
+
+  int num_trained_cells = 0;
+  for (int cell = 0; cell < GUIDING_GRID_CELLS; cell++) {
+    const float *cell_training = training + cell * GUIDING_BINS;
+    float *cdf = field + cell * GUIDING_BINS;
+
+    float sum = 0.0f;
+    for (int bin = 0; bin < GUIDING_BINS; bin++) {
+      sum += cell_training[bin];
+    }
+
+    if (!(sum > 0.0f)) {
+      memset(cdf, 0, sizeof(float) * GUIDING_BINS);
+      continue;
+    }
+
+    /* Mix in a small uniform component so sparsely trained bins can still be sampled. */
+    const float uniform = 0.01f * sum / GUIDING_BINS;
+    float accum = 0.0f;
+    for (int bin = 0; bin < GUIDING_BINS; bin++) {
+      accum += cell_training[bin] + uniform;
+      cdf[bin] = accum;
+    }
+    const float inv_accum = 1.0f / accum;
+    for (int bin = 0; bin < GUIDING_BINS - 1; bin++) {
+      cdf[bin] *= inv_accum;
+    }
+    cdf[GUIDING_BINS - 1] = 1.0f;
+
+    num_trained_cells++;
+  }
+
+  device_scene_->guiding_field.copy_to_device();
+
+  VLOG(3) << "Updated path guiding field, " << num_trained_cells << " of " << GUIDING_GRID_CELLS
+          << " cells trained, in " << time_dt() - start_time << " seconds.";
+}
+
 void PathTrace::adaptive_sample(RenderWork &render_work)
 {
   if (!render_work.adaptive_sampling.filter) {
@@ -648,6 +746,94 @@ void PathTrace::update_display(const RenderWork &render_work)
   render_scheduler_.report_display_update_time(render_work, time_dt() - start_time);
 }
 
+bool PathTrace::use_work_stealing() const
+{
+  if (path_trace_works_.size() < 2) {
+    return false;
+  }
+
+  /* Stolen samples are rendered into separate buffers and added to the victim's buffers
+   * afterwards, which is only valid for passes which are plain sums over samples. Adaptive
+   * sampling and baking also read the render buffers from the kernel. */
+  const KernelData &data = device_scene_->data;
+  if (data.film.pass_adaptive_aux_buffer != PASS_UNUSED || data.film.cryptomatte_passes ||
+      data.bake.use) {
+    return false;
+  }
+
+  for (auto &&path_trace_work : path_trace_works_) {
+    if (path_trace_work->supports_work_stealing()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+RenderBuffers *PathTrace::work_stealing_buffers_get(int thief_index, int victim_index)
+{
+  const int num_works = path_trace_works_.size();
+  const int index = thief_index * num_works + victim_index;
+
+  /* Buffers are only accessed by their thief during path tracing, so they can be allocated
+   * here without locking. */
+  unique_ptr<RenderBuffers> &buffers = work_stealing_buffers_[index];
+  const BufferParams &params = path_trace_works_[victim_index]->get_render_buffers()->params;
+
+  if (!buffers) {
+    buffers = make_unique<RenderBuffers>(path_trace_works_[thief_index]->get_device());
+  }
+  if (buffers->params.modified(params) || buffers->buffer.size() == 0) {
+    buffers->reset(params);
+    buffers->zero();
+  }
+
+  work_stealing_buffers_used_[index] = true;
+
+  return buffers.get();
+}
+
+void PathTrace::work_stealing_accumulate()
+{
+  const int num_works = path_trace_works_.size();
+
+  tbb::parallel_for(0, num_works, [&](int victim_index) {
+    PathTraceWork *victim_work = path_trace_works_[victim_index].get();
+    bool need_copy = false;
+
+    for (int thief_index = 0; thief_index < num_works; thief_index++) {
+      const int index = thief_index * num_works + victim_index;
+      if (!work_stealing_buffers_used_[index]) {
+        continue;
+      }
+
+      if (!need_copy) {
+        victim_work->copy_render_buffers_from_device();
+        need_copy = true;
+      }
+
+      RenderBuffers *buffers = work_stealing_buffers_[index].get();
+      buffers->copy_from_device();
+
+      float *dst = victim_work->get_render_buffers()->buffer.data();
+      const float *src = buffers->buffer.data();
+      const size_t size = buffers->buffer.size();
+      DCHECK_EQ(size, victim_work->get_render_buffers()->buffer.size());
+
+      for (size_t i = 0; i < size; i++) {
+        dst[i] += src[i];
+      }
+
+      buffers->zero();
+      work_stealing_buffers_used_[index] = false;
+    }
+
+    if (need_copy) {
+      victim_work->copy_render_buffers_to_device();
+    }
+  });
+}
+
 void PathTrace::rebalance(const RenderWork &render_work)
 {
   static const int kLogLevel = 3;
@@ -714,22 +900,24 @@ void PathTrace::write_tile_buffer(const RenderWork &render_work)
   render_state_.tile_written = true;
 
   const bool has_multiple_tiles = tile_manager_.has_multiple_tiles();
+  const bool is_streaming = tile_manager_.is_streaming();
 
-  /* Write render tile result, but only if not using tiled rendering.
+  /* Write render tile result, but only if not using tiled rendering or when streaming tiles.
    *
    * Tiles are written to a file during rendering, and written to the software at the end
    * of rendering (wither when all tiles are finished, or when rendering was requested to be
-   * canceled).
+   * canceled). When streaming, every tile is final once written and goes to the software
+   * directly.
    *
    * Important thing is: tile should be written to the software via callback only once. */
-  if (!has_multiple_tiles) {
+  if (!has_multiple_tiles || is_streaming) {
     VLOG(3) << "Write tile result via buffer write callback.";
     tile_buffer_write();
   }
 
   /* Write tile to disk, so that the render work's render buffer can be re-used for the next tile.
    */
-  if (has_multiple_tiles) {
+  if (has_multiple_tiles && !is_streaming) {
     VLOG(3) << "Write tile result into .";
     tile_buffer_write_to_disk();
   }
@@ -1188,12 +1376,41 @@ static string denoiser_device_report(const Denoiser *denoiser)
   return device_info_list_report("Denoising on", denoiser_device->info);
 }
 
+static string work_stealing_report(const vector<unique_ptr<PathTraceWork>> &path_trace_works,
+                                   const WorkStealingScheduler &scheduler)
+{
+  if (path_trace_works.size() < 2) {
+    return "";
+  }
+
+  string result = "\nDevice occupancy:\n";
+  result += string_printf(
+      "  %-40s %12s %16s %16s %16s\n", "", "Occupancy", "Samples", "Stolen", "Lost");
+
+  for (int i = 0; i < path_trace_works.size(); i++) {
+    const WorkStealingScheduler::Statistics &statistics = scheduler.get_statistics(i);
+    const double occupancy = (statistics.total_time > 0.0) ?
+                                 statistics.busy_time / statistics.total_time :
+                                 0.0;
+
+    result += string_printf("  %-40s %11.1f%% %16lld %16lld %16lld\n",
+                            path_trace_works[i]->get_device()->info.description.c_str(),
+                            occupancy * 100.0,
+                            (long long)statistics.samples_rendered,
+                            (long long)statistics.samples_stolen,
+                            (long long)statistics.samples_lost);
+  }
+
+  return result;
+}
+
 string PathTrace::full_report() const
 {
   string result = "\nFull path tracing report\n";
 
   result += path_trace_devices_report(path_trace_works_);
   result += denoiser_device_report(denoiser_.get());
+  result += work_stealing_report(path_trace_works_, work_stealing_scheduler_);
 
   /* Report from the render scheduler, which includes:
    * - Render mode (interactive, offline, headless)
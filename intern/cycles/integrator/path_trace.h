@@ -20,6 +20,7 @@
 #include "integrator/pass_accessor.h"
 #include "integrator/path_trace_work.h"
 #include "integrator/work_balancer.h"
+#include "integrator/work_stealing_scheduler.h"
 #include "session/buffers.h"
 #include "util/function.h"
 #include "util/thread.h"
@@ -205,6 +206,7 @@ class PathTrace {
    * of rendering. */
   void init_render_buffers(const RenderWork &render_work);
   void path_trace(RenderWork &render_work);
+  void update_guiding_field(const RenderWork &render_work);
   void adaptive_sample(RenderWork &render_work);
   void denoise(const RenderWork &render_work);
   void cryptomatte_postprocess(const RenderWork &render_work);
@@ -213,6 +215,14 @@ class PathTrace {
   void write_tile_buffer(const RenderWork &render_work);
   void finalize_full_buffer_on_disk(const RenderWork &render_work);
 
+  /* Work stealing between path trace works of a multi-device render.
+   *
+   * Samples stolen from another work are rendered into separate render buffers of the thief,
+   * which are added to the render buffers of the victim once all works are done. */
+  bool use_work_stealing() const;
+  RenderBuffers *work_stealing_buffers_get(int thief_index, int victim_index);
+  void work_stealing_accumulate();
+
   /* Get number of samples in the current state of the render buffers. */
   int get_num_samples_in_buffer();
 
@@ -259,6 +269,12 @@ class PathTrace {
   /* Per-path trace work information needed for multi-device balancing. */
   vector<WorkBalanceInfo> work_balance_infos_;
 
+  /* Scheduler of samples between path trace works, and render buffers for samples stolen from
+   * other works, indexed by `thief_index * num_works + victim_index`. */
+  WorkStealingScheduler work_stealing_scheduler_;
+  vector<unique_ptr<RenderBuffers>> work_stealing_buffers_;
+  vector<uint8_t> work_stealing_buffers_used_;
+
   /* Render buffer parameters of the full frame and current big tile. */
   BufferParams full_params_;
   BufferParams big_tile_params_;
@@ -81,6 +81,16 @@ bool PathTraceWork::has_multiple_works() const
            effective_big_tile_params_.full_y == effective_buffer_params_.full_y);
 }
 
+void PathTraceWork::render_samples_stolen(RenderStatistics & /*statistics*/,
+                                          RenderBuffers * /*buffers*/,
+                                          const BufferParams & /*effective_buffer_params*/,
+                                          int /*start_sample*/,
+                                          int /*samples_num*/,
+                                          int /*sample_offset*/)
+{
+  LOG(FATAL) << "Work stealing is not supported by this path trace work.";
+}
+
 void PathTraceWork::copy_to_render_buffers(RenderBuffers *render_buffers)
 {
   copy_render_buffers_from_device();
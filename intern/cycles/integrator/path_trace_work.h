@@ -60,6 +60,11 @@ class PathTraceWork {
                                    const BufferParams &effective_big_tile_params,
                                    const BufferParams &effective_buffer_params);
 
+  const BufferParams &get_effective_buffer_params() const
+  {
+    return effective_buffer_params_;
+  }
+
   /* Check whether the big tile is being worked on by multiple path trace works. */
   bool has_multiple_works() const;
 
@@ -80,6 +85,23 @@ class PathTraceWork {
                               int samples_num,
                               int sample_offset) = 0;
 
+  /* Check whether this work can render pixels of the slice of another work, which is needed to
+   * steal samples from it. */
+  virtual bool supports_work_stealing() const
+  {
+    return false;
+  }
+
+  /* Render samples of the pixels of another work's slice, described by its effective buffer
+   * parameters. The samples are added to the given render buffers, which are allocated on this
+   * work's device with the buffer parameters of the other work. */
+  virtual void render_samples_stolen(RenderStatistics &statistics,
+                                     RenderBuffers *buffers,
+                                     const BufferParams &effective_buffer_params,
+                                     int start_sample,
+                                     int samples_num,
+                                     int sample_offset);
+
   /* Copy render result from this work to the corresponding place of the GPU display.
    *
    * The `pass_mode` indicates whether to access denoised or noisy version of the display pass. The
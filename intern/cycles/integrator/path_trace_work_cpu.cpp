@@ -28,11 +28,17 @@
 #include "session/buffers.h"
 
 #include "util/atomic.h"
+#include "util/debug.h"
 #include "util/log.h"
 #include "util/tbb.h"
 
+#include <algorithm>
+
 CCL_NAMESPACE_BEGIN
 
+/* Number of paths in flight per thread for wavefront path tracing. */
+static const int WAVEFRONT_NUM_PATHS = 64;
+
 /* Create TBB arena for execution of path tracing and rendering tasks. */
 static inline tbb::task_arena local_tbb_arena_create(const Device *device)
 {
@@ -53,6 +59,17 @@ static inline CPUKernelThreadGlobals *kernel_thread_globals_get(
   return &kernel_thread_globals[thread_index];
 }
 
+/* Get integrator states of the current thread. */
+static inline IntegratorStateCPU *integrator_thread_states_get(
+    array<IntegratorStateCPU> &integrator_thread_states, const int num_states)
+{
+  const int thread_index = tbb::this_task_arena::current_thread_index();
+  DCHECK_GE(thread_index, 0);
+  DCHECK_LE((thread_index + 1) * num_states, integrator_thread_states.size());
+
+  return &integrator_thread_states[thread_index * num_states];
+}
+
 PathTraceWorkCPU::PathTraceWorkCPU(Device *device,
                                    Film *film,
                                    DeviceScene *device_scene,
@@ -67,6 +84,12 @@ void PathTraceWorkCPU::init_execution()
 {
   /* Cache per-thread kernel globals. */
   device_->get_cpu_kernel_thread_globals(kernel_thread_globals_);
+
+  /* Allocate per-thread integrator states once, they are too big to keep multiple of them on
+   * the stack. Each path state is followed by the state used for shadow catcher splitting. */
+  use_wavefront_ = DebugFlags().cpu.wavefront;
+  num_thread_states_ = (use_wavefront_ ? WAVEFRONT_NUM_PATHS : INTEGRATOR_PACKET_SIZE_CPU) * 2;
+  integrator_thread_states_.resize(kernel_thread_globals_.size() * num_thread_states_);
 }
 
 void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
@@ -74,9 +97,34 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
                                       int samples_num,
                                       int sample_offset)
 {
-  const int64_t image_width = effective_buffer_params_.width;
-  const int64_t image_height = effective_buffer_params_.height;
+  render_samples_impl(
+      buffers_.get(), effective_buffer_params_, start_sample, samples_num, sample_offset);
+
+  statistics.occupancy = 1.0f;
+}
+
+void PathTraceWorkCPU::render_samples_stolen(RenderStatistics &statistics,
+                                             RenderBuffers *buffers,
+                                             const BufferParams &effective_buffer_params,
+                                             int start_sample,
+                                             int samples_num,
+                                             int sample_offset)
+{
+  render_samples_impl(buffers, effective_buffer_params, start_sample, samples_num, sample_offset);
+
+  statistics.occupancy = 1.0f;
+}
+
+void PathTraceWorkCPU::render_samples_impl(RenderBuffers *buffers,
+                                           const BufferParams &effective_buffer_params,
+                                           int start_sample,
+                                           int samples_num,
+                                           int sample_offset)
+{
+  const int64_t image_width = effective_buffer_params.width;
+  const int64_t image_height = effective_buffer_params.height;
   const int64_t total_pixels_num = image_width * image_height;
+  float *render_buffer = buffers->buffer.data();
 
   if (device_->profiler.active()) {
     for (CPUKernelThreadGlobals &kernel_globals : kernel_thread_globals_) {
@@ -84,8 +132,46 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
     }
   }
 
+  KernelWorkTile work_tile;
+  work_tile.x = effective_buffer_params.full_x;
+  work_tile.y = effective_buffer_params.full_y;
+  work_tile.w = 1;
+  work_tile.h = 1;
+  work_tile.start_sample = start_sample;
+  work_tile.sample_offset = sample_offset;
+  work_tile.num_samples = 1;
+  work_tile.offset = effective_buffer_params.offset;
+  work_tile.stride = effective_buffer_params.stride;
+
   tbb::task_arena local_arena = local_tbb_arena_create(device_);
   local_arena.execute([&]() {
+    if (use_wavefront_) {
+      /* Render ranges of pixels, large enough to keep all paths of a thread busy. */
+      const int64_t grain_size = divide_up(WAVEFRONT_NUM_PATHS, samples_num);
+
+      tbb::parallel_for(blocked_range<int64_t>(0, total_pixels_num, grain_size),
+                        [&](const blocked_range<int64_t> &range) {
+                          if (is_cancel_requested()) {
+                            return;
+                          }
+
+                          CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(
+                              kernel_thread_globals_);
+                          IntegratorStateCPU *integrator_states = integrator_thread_states_get(
+                              integrator_thread_states_, num_thread_states_);
+
+                          render_samples_wavefront(kernel_globals,
+                                                   integrator_states,
+                                                   work_tile,
+                                                   image_width,
+                                                   range.begin(),
+                                                   range.end(),
+                                                   samples_num,
+                                                   render_buffer);
+                        });
+      return;
+    }
+
     tbb::parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
       if (is_cancel_requested()) {
         return;
@@ -94,20 +180,16 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
       const int y = work_index / image_width;
       const int x = work_index - y * image_width;
 
-      KernelWorkTile work_tile;
-      work_tile.x = effective_buffer_params_.full_x + x;
-      work_tile.y = effective_buffer_params_.full_y + y;
-      work_tile.w = 1;
-      work_tile.h = 1;
-      work_tile.start_sample = start_sample;
-      work_tile.sample_offset = sample_offset;
-      work_tile.num_samples = 1;
-      work_tile.offset = effective_buffer_params_.offset;
-      work_tile.stride = effective_buffer_params_.stride;
+      KernelWorkTile pixel_work_tile = work_tile;
+      pixel_work_tile.x += x;
+      pixel_work_tile.y += y;
 
       CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(kernel_thread_globals_);
+      IntegratorStateCPU *integrator_states = integrator_thread_states_get(
+          integrator_thread_states_, num_thread_states_);
 
-      render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+      render_samples_full_pipeline(
+          kernel_globals, integrator_states, pixel_work_tile, samples_num, render_buffer);
     });
   });
   if (device_->profiler.active()) {
@@ -115,54 +197,260 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
       kernel_globals.stop_profiling();
     }
   }
-
-  statistics.occupancy = 1.0f;
 }
 
 void PathTraceWorkCPU::render_samples_full_pipeline(KernelGlobalsCPU *kernel_globals,
+                                                    IntegratorStateCPU *integrator_states,
                                                     const KernelWorkTile &work_tile,
-                                                    const int samples_num)
+                                                    const int samples_num,
+                                                    float *render_buffer)
 {
   const bool has_bake = device_scene_->data.bake.use;
+  const bool has_shadow_catcher = device_scene_->data.integrator.has_shadow_catcher;
 
-  IntegratorStateCPU integrator_states[2];
-
-  IntegratorStateCPU *state = &integrator_states[0];
-  IntegratorStateCPU *shadow_catcher_state = nullptr;
-
-  if (device_scene_->data.integrator.has_shadow_catcher) {
-    shadow_catcher_state = &integrator_states[1];
-    path_state_init_queues(shadow_catcher_state);
+  /* Paths of a packet are interleaved with their shadow catcher states, as the kernel expects
+   * the shadow catcher state to follow the main path state. */
+  if (has_shadow_catcher) {
+    for (int i = 0; i < INTEGRATOR_PACKET_SIZE_CPU; i++) {
+      path_state_init_queues(&integrator_states[i * 2 + 1]);
+    }
   }
 
   KernelWorkTile sample_work_tile = work_tile;
-  float *render_buffer = buffers_->buffer.data();
 
-  for (int sample = 0; sample < samples_num; ++sample) {
+  /* Render a packet of consecutive samples of the pixel at a time, so that their camera rays
+   * can be intersected together. The rest of the paths is traced one at a time. */
+  for (int sample = 0; sample < samples_num;) {
     if (is_cancel_requested()) {
       break;
     }
 
-    if (has_bake) {
-      if (!kernels_.integrator_init_from_bake(
-              kernel_globals, state, &sample_work_tile, render_buffer)) {
-        break;
+    const int packet_size = min(samples_num - sample, INTEGRATOR_PACKET_SIZE_CPU);
+    int num_states = 0;
+
+    for (; num_states < packet_size; num_states++) {
+      IntegratorStateCPU *state = &integrator_states[num_states * 2];
+
+      if (has_bake) {
+        if (!kernels_.integrator_init_from_bake(
+                kernel_globals, state, &sample_work_tile, render_buffer)) {
+          break;
+        }
       }
+      else {
+        if (!kernels_.integrator_init_from_camera(
+                kernel_globals, state, &sample_work_tile, render_buffer)) {
+          break;
+        }
+      }
+
+      ++sample_work_tile.start_sample;
+    }
+
+    if (num_states == 0) {
+      break;
     }
-    else {
-      if (!kernels_.integrator_init_from_camera(
-              kernel_globals, state, &sample_work_tile, render_buffer)) {
-        break;
+
+    kernels_.integrator_intersect_closest_packet(
+        kernel_globals, integrator_states, num_states, render_buffer);
+
+    for (int i = 0; i < num_states; i++) {
+      IntegratorStateCPU *state = &integrator_states[i * 2];
+
+      kernels_.integrator_megakernel(kernel_globals, state, render_buffer);
+
+      if (has_shadow_catcher) {
+        kernels_.integrator_megakernel(kernel_globals, state + 1, render_buffer);
       }
     }
 
-    kernels_.integrator_megakernel(kernel_globals, state, render_buffer);
+    if (num_states != packet_size) {
+      break;
+    }
+
+    sample += num_states;
+  }
+}
 
-    if (shadow_catcher_state) {
-      kernels_.integrator_megakernel(kernel_globals, shadow_catcher_state, render_buffer);
+/* Next kernel to execute for the path, in the same order as the megakernel. Shadow and AO paths
+ * are handled before the main path continues, as the main path may create new ones. */
+static inline DeviceKernel integrator_state_next_kernel(const IntegratorStateCPU *state)
+{
+  if (state->shadow.shadow_path.queued_kernel) {
+    return (DeviceKernel)state->shadow.shadow_path.queued_kernel;
+  }
+  if (state->ao.shadow_path.queued_kernel) {
+    return (DeviceKernel)state->ao.shadow_path.queued_kernel;
+  }
+  if (state->path.queued_kernel) {
+    return (DeviceKernel)state->path.queued_kernel;
+  }
+  return DEVICE_KERNEL_NUM;
+}
+
+void PathTraceWorkCPU::render_samples_wavefront(KernelGlobalsCPU *kernel_globals,
+                                                IntegratorStateCPU *integrator_states,
+                                                const KernelWorkTile &work_tile,
+                                                const int64_t image_width,
+                                                const int64_t pixel_begin,
+                                                const int64_t pixel_end,
+                                                const int samples_num,
+                                                float *render_buffer)
+{
+  const bool has_bake = device_scene_->data.bake.use;
+  const bool has_shadow_catcher = device_scene_->data.integrator.has_shadow_catcher;
+
+  for (int i = 0; i < num_thread_states_; i++) {
+    path_state_init_queues(&integrator_states[i]);
+  }
+
+  /* Work items are all samples of the pixels in the range, ordered by pixel so that paths in
+   * flight tend to be coherent. */
+  const int64_t work_size = (pixel_end - pixel_begin) * samples_num;
+  int64_t work_index = 0;
+
+  /* Initialize a path from the next work item, returns false if there is no work left. */
+  auto init_path = [&](IntegratorStateCPU *state) {
+    while (work_index < work_size) {
+      const int64_t pixel_offset = work_index / samples_num;
+      const int64_t pixel_index = pixel_begin + pixel_offset;
+      const int sample = work_index - pixel_offset * samples_num;
+      const int y = pixel_index / image_width;
+      const int x = pixel_index - y * image_width;
+
+      KernelWorkTile sample_work_tile = work_tile;
+      sample_work_tile.x += x;
+      sample_work_tile.y += y;
+      sample_work_tile.start_sample += sample;
+
+      ++work_index;
+
+      const bool need_sample = (has_bake) ?
+                                   kernels_.integrator_init_from_bake(
+                                       kernel_globals, state, &sample_work_tile, render_buffer) :
+                                   kernels_.integrator_init_from_camera(
+                                       kernel_globals, state, &sample_work_tile, render_buffer);
+      if (!need_sample) {
+        /* Pixel converged, skip its remaining samples. */
+        work_index = (pixel_offset + 1) * samples_num;
+        continue;
+      }
+
+      if (state->path.queued_kernel) {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  const int num_paths = num_thread_states_ / 2;
+  vector<IntegratorStateCPU *> queue;
+  queue.reserve(num_thread_states_);
+
+  while (!is_cancel_requested()) {
+    /* Start new paths in states whose path and shadow catcher path have finished. */
+    for (int i = 0; i < num_paths && work_index < work_size; i++) {
+      IntegratorStateCPU *state = &integrator_states[i * 2];
+      if (integrator_state_next_kernel(state) == DEVICE_KERNEL_NUM &&
+          (!has_shadow_catcher || integrator_state_next_kernel(state + 1) == DEVICE_KERNEL_NUM)) {
+        init_path(state);
+      }
+    }
+
+    /* Find kernel with the most queued paths. */
+    int num_queued[DEVICE_KERNEL_INTEGRATOR_NUM] = {0};
+    for (int i = 0; i < num_thread_states_; i++) {
+      const DeviceKernel kernel = integrator_state_next_kernel(&integrator_states[i]);
+      if (kernel != DEVICE_KERNEL_NUM) {
+        num_queued[kernel]++;
+      }
+    }
+
+    int max_num_queued = 0;
+    DeviceKernel kernel = DEVICE_KERNEL_NUM;
+    for (int i = 0; i < DEVICE_KERNEL_INTEGRATOR_NUM; i++) {
+      if (num_queued[i] > max_num_queued) {
+        kernel = (DeviceKernel)i;
+        max_num_queued = num_queued[i];
+      }
+    }
+
+    if (kernel == DEVICE_KERNEL_NUM) {
+      break;
+    }
+
+    queue.clear();
+    for (int i = 0; i < num_thread_states_; i++) {
+      if (integrator_state_next_kernel(&integrator_states[i]) == kernel) {
+        queue.push_back(&integrator_states[i]);
+      }
+    }
+
+    /* Sort by shader for better coherence of shader evaluation. */
+    if (kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE ||
+        kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE) {
+      std::stable_sort(queue.begin(),
+                       queue.end(),
+                       [](const IntegratorStateCPU *a, const IntegratorStateCPU *b) {
+                         return a->path.shader_sort_key < b->path.shader_sort_key;
+                       });
     }
 
-    ++sample_work_tile.start_sample;
+    for (IntegratorStateCPU *state : queue) {
+      render_samples_wavefront_kernel(kernel_globals, kernel, state, render_buffer);
+    }
+  }
+}
+
+void PathTraceWorkCPU::render_samples_wavefront_kernel(KernelGlobalsCPU *kernel_globals,
+                                                       const DeviceKernel kernel,
+                                                       IntegratorStateCPU *state,
+                                                       float *render_buffer)
+{
+  switch (kernel) {
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST:
+      kernels_.integrator_intersect_closest(kernel_globals, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_SUBSURFACE:
+      kernels_.integrator_intersect_subsurface(kernel_globals, state);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_VOLUME_STACK:
+      kernels_.integrator_intersect_volume_stack(kernel_globals, state);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_BACKGROUND:
+      kernels_.integrator_shade_background(kernel_globals, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_LIGHT:
+      kernels_.integrator_shade_light(kernel_globals, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE:
+      kernels_.integrator_shade_surface(kernel_globals, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE:
+      kernels_.integrator_shade_surface_raytrace(kernel_globals, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_VOLUME:
+      kernels_.integrator_shade_volume(kernel_globals, state, render_buffer);
+      break;
+    case DEVICE_KERNEL_INTEGRATOR_INTERSECT_SHADOW:
+    case DEVICE_KERNEL_INTEGRATOR_SHADE_SHADOW: {
+      /* Shadow kernels are queued for the shadow path first, then the AO path. */
+      IntegratorShadowStateCPU *shadow_state = (state->shadow.shadow_path.queued_kernel) ?
+                                                   &state->shadow :
+                                                   &state->ao;
+      if (kernel == DEVICE_KERNEL_INTEGRATOR_INTERSECT_SHADOW) {
+        kernels_.integrator_intersect_shadow(kernel_globals, shadow_state);
+      }
+      else {
+        kernels_.integrator_shade_shadow(kernel_globals, shadow_state, render_buffer);
+      }
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unhandled kernel " << device_kernel_as_string(kernel)
+                 << ", should never happen.";
+      break;
   }
 }
 
@@ -23,6 +23,7 @@
 
 #include "integrator/path_trace_work.h"
 
+#include "util/array.h"
 #include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -51,6 +52,18 @@ class PathTraceWorkCPU : public PathTraceWork {
                               int samples_num,
                               int sample_offset) override;
 
+  virtual bool supports_work_stealing() const override
+  {
+    return true;
+  }
+
+  virtual void render_samples_stolen(RenderStatistics &statistics,
+                                     RenderBuffers *buffers,
+                                     const BufferParams &effective_buffer_params,
+                                     int start_sample,
+                                     int samples_num,
+                                     int sample_offset) override;
+
   virtual void copy_to_display(PathTraceDisplay *display,
                                PassMode pass_mode,
                                int num_samples) override;
@@ -64,10 +77,36 @@ class PathTraceWorkCPU : public PathTraceWork {
   virtual void cryptomatte_postproces() override;
 
  protected:
+  /* Render samples of all pixels described by the effective buffer parameters into the given
+   * render buffers. */
+  void render_samples_impl(RenderBuffers *buffers,
+                           const BufferParams &effective_buffer_params,
+                           int start_sample,
+                           int samples_num,
+                           int sample_offset);
+
   /* Core path tracing routine. Renders given work time on the given queue. */
   void render_samples_full_pipeline(KernelGlobalsCPU *kernel_globals,
+                                    IntegratorStateCPU *integrator_states,
                                     const KernelWorkTile &work_tile,
-                                    const int samples_num);
+                                    const int samples_num,
+                                    float *render_buffer);
+
+  /* Wavefront path tracing routine. Renders all samples of a range of pixels, keeping multiple
+   * paths in flight and executing the kernel with the most queued paths for all of them at once,
+   * like the GPU path tracing. */
+  void render_samples_wavefront(KernelGlobalsCPU *kernel_globals,
+                                IntegratorStateCPU *integrator_states,
+                                const KernelWorkTile &work_tile,
+                                const int64_t image_width,
+                                const int64_t pixel_begin,
+                                const int64_t pixel_end,
+                                const int samples_num,
+                                float *render_buffer);
+  void render_samples_wavefront_kernel(KernelGlobalsCPU *kernel_globals,
+                                       const DeviceKernel kernel,
+                                       IntegratorStateCPU *state,
+                                       float *render_buffer);
 
   /* CPU kernels. */
   const CPUKernels &kernels_;
@@ -78,6 +117,14 @@ class PathTraceWorkCPU : public PathTraceWork {
    * accessing it, but some "localization" is required to decouple from kernel globals stored
    * on the device level. */
   vector<CPUKernelThreadGlobals> kernel_thread_globals_;
+
+  /* Per-thread integrator states, each path state followed by the state used for shadow
+   * catcher splitting. */
+  array<IntegratorStateCPU> integrator_thread_states_;
+  int num_thread_states_ = 0;
+
+  /* Use wavefront path tracing instead of the megakernel. */
+  bool use_wavefront_ = false;
 };
 
 CCL_NAMESPACE_END
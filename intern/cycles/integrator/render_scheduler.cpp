@@ -397,7 +397,8 @@ bool RenderScheduler::set_postprocess_render_work(RenderWork *render_work)
   }
 
   if (denoiser_params_.use && !state_.last_work_tile_was_denoised) {
-    render_work->tile.denoise = !tile_manager_.has_multiple_tiles();
+    render_work->tile.denoise = !tile_manager_.has_multiple_tiles() ||
+                                tile_manager_.is_streaming();
     any_scheduled = true;
   }
 
@@ -941,8 +942,9 @@ bool RenderScheduler::work_need_denoise(bool &delayed, bool &ready_to_display)
   }
 
   /* When multiple tiles are used the full frame will be denoised.
-   * Avoid per-tile denoising to save up render time. */
-  if (tile_manager_.has_multiple_tiles()) {
+   * Avoid per-tile denoising to save up render time. When tiles are streamed there is no full
+   * frame, so they are denoised on their own. */
+  if (tile_manager_.has_multiple_tiles() && !tile_manager_.is_streaming()) {
     return false;
   }
 
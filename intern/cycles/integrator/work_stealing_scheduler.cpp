@@ -0,0 +1,145 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "integrator/work_stealing_scheduler.h"
+
+#include "util/log.h"
+#include "util/math.h"
+
+#include <algorithm>
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of chunks the sample range of a work is split into when stealing is used. More chunks
+ * allow finer stealing, but every chunk is a separate render call on the device. */
+static const int WORK_STEALING_NUM_CHUNKS = 4;
+
+void WorkStealingScheduler::reset(const vector<int64_t> &num_pixels,
+                                  int start_sample,
+                                  int samples_num,
+                                  bool use_stealing)
+{
+  thread_scoped_lock lock(mutex_);
+
+  const int num_works = num_pixels.size();
+
+  ranges_.resize(num_works);
+  statistics_.resize(num_works);
+
+  for (int i = 0; i < num_works; i++) {
+    WorkRange &range = ranges_[i];
+    range.num_pixels = num_pixels[i];
+    range.chunk_size = (use_stealing) ? divide_up(samples_num, WORK_STEALING_NUM_CHUNKS) :
+                                        samples_num;
+    range.start = start_sample;
+    range.end = start_sample + samples_num;
+  }
+}
+
+bool WorkStealingScheduler::get_work(int work_index, int *start_sample, int *samples_num)
+{
+  thread_scoped_lock lock(mutex_);
+
+  WorkRange &range = ranges_[work_index];
+  if (range.start >= range.end || range.num_pixels == 0) {
+    return false;
+  }
+
+  *start_sample = range.start;
+  *samples_num = min(range.chunk_size, range.end - range.start);
+  range.start += *samples_num;
+
+  statistics_[work_index].samples_rendered += *samples_num;
+
+  return true;
+}
+
+bool WorkStealingScheduler::steal_work(int thief_index,
+                                       int *victim_index,
+                                       int *start_sample,
+                                       int *samples_num)
+{
+  thread_scoped_lock lock(mutex_);
+
+  const int64_t thief_num_pixels = std::max(ranges_[thief_index].num_pixels, (int64_t)1);
+
+  int best_victim = -1;
+  int best_num_samples = 0;
+
+  for (int i = 0; i < ranges_.size(); i++) {
+    const WorkRange &range = ranges_[i];
+    if (i == thief_index || range.start >= range.end || range.num_pixels == 0) {
+      continue;
+    }
+
+    /* The slices are balanced so that every work renders a sample of its own slice in about the
+     * same time, so the thief renders samples of the victim's slice this much faster than the
+     * victim itself. Split the remaining samples so that both finish at about the same time. */
+    const double rate = (double)thief_num_pixels / (double)range.num_pixels;
+    const int num_samples = (int)((range.end - range.start) * rate / (1.0 + rate));
+
+    if (num_samples > best_num_samples) {
+      best_victim = i;
+      best_num_samples = num_samples;
+    }
+  }
+
+  if (best_victim == -1) {
+    return false;
+  }
+
+  WorkRange &range = ranges_[best_victim];
+  range.end -= best_num_samples;
+
+  *victim_index = best_victim;
+  *start_sample = range.end;
+  *samples_num = best_num_samples;
+
+  statistics_[thief_index].samples_stolen += best_num_samples;
+  statistics_[best_victim].samples_lost += best_num_samples;
+
+  VLOG(3) << "Work " << thief_index << " stole " << best_num_samples << " samples from work "
+          << best_victim << ".";
+
+  return true;
+}
+
+void WorkStealingScheduler::add_busy_time(int work_index, double time)
+{
+  thread_scoped_lock lock(mutex_);
+  statistics_[work_index].busy_time += time;
+}
+
+void WorkStealingScheduler::end_round(double round_time)
+{
+  thread_scoped_lock lock(mutex_);
+  for (Statistics &statistics : statistics_) {
+    statistics.total_time += round_time;
+  }
+}
+
+const WorkStealingScheduler::Statistics &WorkStealingScheduler::get_statistics(
+    int work_index) const
+{
+  /* Statistics only exist once the first round has been scheduled. */
+  static const Statistics empty_statistics;
+  if (work_index >= statistics_.size()) {
+    return empty_statistics;
+  }
+  return statistics_[work_index];
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "util/thread.h"
+#include "util/types.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Scheduler of sample ranges between path trace works of a multi-device render.
+ *
+ * Every work renders the samples of its own slice of the big tile, in chunks taken from the
+ * start of its sample range. A work which runs out of samples and is able to render pixels of
+ * other works steals samples from the end of the range of a work which is still busy, so that
+ * devices do not sit idle waiting for the slowest one at the end of every round. */
+class WorkStealingScheduler {
+ public:
+  struct Statistics {
+    /* Wall time of the rounds the work took part in, and time spent rendering during them.
+     * Their ratio is the occupancy of the device. */
+    double total_time = 0.0;
+    double busy_time = 0.0;
+
+    /* Samples of the slice of this work rendered by the work itself, and samples rendered by
+     * this work for slices of other works. */
+    int64_t samples_rendered = 0;
+    int64_t samples_stolen = 0;
+
+    /* Samples of the slice of this work which were rendered by other works. */
+    int64_t samples_lost = 0;
+  };
+
+  /* Begin a new round which renders the given sample range for every work.
+   *
+   * The number of pixels in the slice of each work is used to estimate how many samples are
+   * worth stealing: rendering a sample of a bigger slice takes the thief longer than the owner.
+   * Without stealing, every work gets its entire sample range at once. */
+  void reset(const vector<int64_t> &num_pixels,
+             int start_sample,
+             int samples_num,
+             bool use_stealing);
+
+  /* Get the next chunk of samples of the given work's own slice.
+   * Returns false when all samples of the slice have been scheduled. */
+  bool get_work(int work_index, int *start_sample, int *samples_num);
+
+  /* Steal samples from the end of the sample range of the work which has the most remaining.
+   * Returns false when there is no work left which is worth stealing. */
+  bool steal_work(int thief_index, int *victim_index, int *start_sample, int *samples_num);
+
+  /* Accumulate statistics of the round. */
+  void add_busy_time(int work_index, double time);
+  void end_round(double round_time);
+
+  const Statistics &get_statistics(int work_index) const;
+
+ protected:
+  struct WorkRange {
+    int64_t num_pixels = 0;
+    int chunk_size = 0;
+
+    /* Samples in [start, end) are not scheduled yet. */
+    int start = 0;
+    int end = 0;
+  };
+
+  thread_mutex mutex_;
+  vector<WorkRange> ranges_;
+  vector<Statistics> statistics_;
+};
+
+CCL_NAMESPACE_END
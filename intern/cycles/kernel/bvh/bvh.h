@@ -138,6 +138,12 @@ CCL_NAMESPACE_BEGIN
 #    endif
 #  endif /* __VOLUME_RECORD_ALL__ */
 
+/* Packet BVH traversal */
+
+#  if defined(__BVH_PACKET__)
+#    include "kernel/bvh/packet.h"
+#  endif
+
 #  undef BVH_FEATURE
 #  undef BVH_NAME_JOIN
 #  undef BVH_NAME_EVAL
@@ -341,6 +347,38 @@ ccl_device_intersect bool scene_intersect(KernelGlobals kg,
 #endif   /* __KERNEL_OPTIX__ */
 }
 
+#ifdef __BVH_PACKET__
+/* Intersect a packet of rays with the same visibility. Returns false when packet traversal is not
+ * supported for the scene, in which case rays must be intersected with scene_intersect. On
+ * success an intersection with prim set to PRIM_NONE is returned for rays that hit nothing. */
+ccl_device_intersect bool scene_intersect_packet(KernelGlobals kg,
+                                                 ccl_private const Ray *rays,
+                                                 const int num_rays,
+                                                 const uint visibility,
+                                                 ccl_private Intersection *isects)
+{
+#  ifdef __EMBREE__
+  if (kernel_data.bvh.scene) {
+    return false;
+  }
+#  endif /* __EMBREE__ */
+
+  if (kernel_data.bvh.have_motion || kernel_data.bvh.have_curves) {
+    return false;
+  }
+
+  int ray_mask = 0;
+  for (int i = 0; i < num_rays; i++) {
+    if (scene_intersect_valid(&rays[i])) {
+      ray_mask |= (1 << i);
+    }
+  }
+
+  bvh_intersect_packet(kg, rays, isects, num_rays, ray_mask, visibility);
+  return true;
+}
+#endif /* __BVH_PACKET__ */
+
 #ifdef __BVH_LOCAL__
 ccl_device_intersect bool scene_intersect_local(KernelGlobals kg,
                                                 ccl_private const Ray *ray,
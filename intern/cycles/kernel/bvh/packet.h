@@ -0,0 +1,287 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Packet BVH traversal
+ *
+ * Traverses a packet of up to 4 rays through the BVH2 together. Nodes are intersected with all
+ * rays at once using SSE, and rays share a single traversal stack where each entry stores the
+ * mask of rays that still need to visit the node. For coherent rays, like the camera rays of
+ * multiple samples in the same pixel, this amortizes node fetches and stack operations over the
+ * packet. Primitives are intersected one ray at a time.
+ *
+ * Only regular traversal without motion blur and curves is supported. */
+
+ccl_device_inline void bvh_packet_transpose(const float3 v[INTEGRATOR_PACKET_SIZE_CPU],
+                                            ccl_private ssef *x,
+                                            ccl_private ssef *y,
+                                            ccl_private ssef *z)
+{
+  *x = ssef(v[0].x, v[1].x, v[2].x, v[3].x);
+  *y = ssef(v[0].y, v[1].y, v[2].y, v[3].y);
+  *z = ssef(v[0].z, v[1].z, v[2].z, v[3].z);
+}
+
+ccl_device_inline ssef bvh_packet_isect_t(ccl_private const Intersection *isects)
+{
+  return ssef(isects[0].t, isects[1].t, isects[2].t, isects[3].t);
+}
+
+/* Intersect child nodes with all rays in the packet, returning the mask of rays that hit each
+ * child. */
+ccl_device_forceinline void bvh_packet_aligned_node_intersect(KernelGlobals kg,
+                                                              const ssef P[3],
+                                                              const ssef idir[3],
+                                                              const ssef &t,
+                                                              const int node_addr,
+                                                              const uint visibility,
+                                                              const int ray_mask,
+                                                              ccl_private int child_mask[2],
+                                                              ccl_private ssef dist[2])
+{
+  const float4 cnodes = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
+  const float4 node0 = kernel_tex_fetch(__bvh_nodes, node_addr + 1);
+  const float4 node1 = kernel_tex_fetch(__bvh_nodes, node_addr + 2);
+  const float4 node2 = kernel_tex_fetch(__bvh_nodes, node_addr + 3);
+
+  const ssef c0lox = (ssef(node0.x) - P[0]) * idir[0];
+  const ssef c0hix = (ssef(node0.z) - P[0]) * idir[0];
+  const ssef c0loy = (ssef(node1.x) - P[1]) * idir[1];
+  const ssef c0hiy = (ssef(node1.z) - P[1]) * idir[1];
+  const ssef c0loz = (ssef(node2.x) - P[2]) * idir[2];
+  const ssef c0hiz = (ssef(node2.z) - P[2]) * idir[2];
+  const ssef c0min = max(max(ssef(0.0f), min(c0lox, c0hix)),
+                         max(min(c0loy, c0hiy), min(c0loz, c0hiz)));
+  const ssef c0max = min(min(t, max(c0lox, c0hix)), min(max(c0loy, c0hiy), max(c0loz, c0hiz)));
+
+  const ssef c1lox = (ssef(node0.y) - P[0]) * idir[0];
+  const ssef c1hix = (ssef(node0.w) - P[0]) * idir[0];
+  const ssef c1loy = (ssef(node1.y) - P[1]) * idir[1];
+  const ssef c1hiy = (ssef(node1.w) - P[1]) * idir[1];
+  const ssef c1loz = (ssef(node2.y) - P[2]) * idir[2];
+  const ssef c1hiz = (ssef(node2.w) - P[2]) * idir[2];
+  const ssef c1min = max(max(ssef(0.0f), min(c1lox, c1hix)),
+                         max(min(c1loy, c1hiy), min(c1loz, c1hiz)));
+  const ssef c1max = min(min(t, max(c1lox, c1hix)), min(max(c1loy, c1hiy), max(c1loz, c1hiz)));
+
+  dist[0] = c0min;
+  dist[1] = c1min;
+
+  const int hit_mask0 = movemask(c0max >= c0min) & ray_mask;
+  const int hit_mask1 = movemask(c1max >= c1min) & ray_mask;
+  child_mask[0] = (__float_as_uint(cnodes.x) & visibility) ? hit_mask0 : 0;
+  child_mask[1] = (__float_as_uint(cnodes.y) & visibility) ? hit_mask1 : 0;
+}
+
+/* Find closest intersection for each ray in the packet. Only rays in ray_mask are traced, the
+ * intersections of other rays are left empty. All rays must use the same visibility. */
+ccl_device_noinline void bvh_intersect_packet(KernelGlobals kg,
+                                              ccl_private const Ray *rays,
+                                              ccl_private Intersection *isects,
+                                              const int num_rays,
+                                              const int ray_mask,
+                                              const uint visibility)
+{
+  PROFILING_INIT_BVH(kg);
+
+  /* Traversal stack, with mask of rays to traverse each node with. */
+  int traversal_stack[BVH_STACK_SIZE];
+  int traversal_mask[BVH_STACK_SIZE];
+  traversal_stack[0] = ENTRYPOINT_SENTINEL;
+  traversal_mask[0] = 0;
+
+  int stack_ptr = 0;
+  int node_addr = kernel_data.bvh.root;
+  int node_mask = ray_mask;
+  int object = OBJECT_NONE;
+
+  /* Ray parameters, per ray for primitive intersection and transposed for node intersection.
+   * Unused slots of the packet are never part of a mask and only need to be initialized. */
+  float3 P[INTEGRATOR_PACKET_SIZE_CPU];
+  float3 dir[INTEGRATOR_PACKET_SIZE_CPU];
+  float3 idir[INTEGRATOR_PACKET_SIZE_CPU];
+  Intersection packet_isects[INTEGRATOR_PACKET_SIZE_CPU];
+
+  for (int i = 0; i < INTEGRATOR_PACKET_SIZE_CPU; i++) {
+    const bool is_used = (i < num_rays);
+    P[i] = (is_used) ? rays[i].P : zero_float3();
+    dir[i] = (is_used) ? bvh_clamp_direction(rays[i].D) : one_float3();
+    idir[i] = bvh_inverse_direction(dir[i]);
+
+    packet_isects[i].t = (is_used) ? rays[i].t : 0.0f;
+    packet_isects[i].u = 0.0f;
+    packet_isects[i].v = 0.0f;
+    packet_isects[i].prim = PRIM_NONE;
+    packet_isects[i].object = OBJECT_NONE;
+  }
+
+  ssef packet_P[3], packet_idir[3];
+  bvh_packet_transpose(P, &packet_P[0], &packet_P[1], &packet_P[2]);
+  bvh_packet_transpose(idir, &packet_idir[0], &packet_idir[1], &packet_idir[2]);
+  ssef packet_t = bvh_packet_isect_t(packet_isects);
+
+  if (node_mask == 0) {
+    node_addr = ENTRYPOINT_SENTINEL;
+  }
+
+  /* traversal loop */
+  while (node_addr != ENTRYPOINT_SENTINEL) {
+    do {
+      /* traverse internal nodes */
+      while (node_addr >= 0 && node_addr != ENTRYPOINT_SENTINEL) {
+        int child_mask[2];
+        ssef dist[2];
+        const float4 cnodes = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
+        PROFILING_BVH_NODE();
+
+        bvh_packet_aligned_node_intersect(kg,
+                                          packet_P,
+                                          packet_idir,
+                                          packet_t,
+                                          node_addr,
+                                          visibility,
+                                          node_mask,
+                                          child_mask,
+                                          dist);
+
+        node_addr = __float_as_int(cnodes.z);
+        int node_addr_child1 = __float_as_int(cnodes.w);
+
+        if (child_mask[0] && child_mask[1]) {
+          /* Both children were intersected, push the farther one. Order is decided by the
+           * first ray that hit both, otherwise by the number of rays. */
+          const int both_mask = child_mask[0] & child_mask[1];
+          bool is_closest_child1;
+          if (both_mask) {
+            const int i = __bsf((uint32_t)both_mask);
+            is_closest_child1 = (dist[1][i] < dist[0][i]);
+          }
+          else {
+            is_closest_child1 = (popcount(child_mask[1]) > popcount(child_mask[0]));
+          }
+
+          int far_mask = child_mask[1];
+          node_mask = child_mask[0];
+          if (is_closest_child1) {
+            int tmp = node_addr;
+            node_addr = node_addr_child1;
+            node_addr_child1 = tmp;
+            far_mask = child_mask[0];
+            node_mask = child_mask[1];
+          }
+
+          ++stack_ptr;
+          kernel_assert(stack_ptr < BVH_STACK_SIZE);
+          traversal_stack[stack_ptr] = node_addr_child1;
+          traversal_mask[stack_ptr] = far_mask;
+        }
+        else if (child_mask[0]) {
+          node_mask = child_mask[0];
+        }
+        else if (child_mask[1]) {
+          node_addr = node_addr_child1;
+          node_mask = child_mask[1];
+        }
+        else {
+          /* Neither child was intersected. */
+          node_addr = traversal_stack[stack_ptr];
+          node_mask = traversal_mask[stack_ptr];
+          --stack_ptr;
+        }
+      }
+
+      /* if node is leaf, fetch triangle list */
+      if (node_addr < 0) {
+        float4 leaf = kernel_tex_fetch(__bvh_leaf_nodes, (-node_addr - 1));
+        int prim_addr = __float_as_int(leaf.x);
+
+        if (prim_addr >= 0) {
+          const int prim_addr2 = __float_as_int(leaf.y);
+          const int leaf_mask = node_mask;
+          PROFILING_BVH_PRIMITIVES((prim_addr2 - prim_addr) * popcount(leaf_mask));
+
+          /* pop */
+          node_addr = traversal_stack[stack_ptr];
+          node_mask = traversal_mask[stack_ptr];
+          --stack_ptr;
+
+          /* primitive intersection, one ray at a time */
+          kernel_assert((__float_as_int(leaf.w) & PRIMITIVE_ALL) == PRIMITIVE_TRIANGLE);
+          for (int mask = leaf_mask; mask; mask &= mask - 1) {
+            const int i = __bsf((uint32_t)mask);
+            for (int addr = prim_addr; addr < prim_addr2; addr++) {
+              triangle_intersect(kg,
+                                 &packet_isects[i],
+                                 P[i],
+                                 dir[i],
+                                 packet_isects[i].t,
+                                 visibility,
+                                 object,
+                                 addr);
+            }
+          }
+
+          packet_t = bvh_packet_isect_t(packet_isects);
+        }
+        else {
+          /* instance push, for all rays that reached the instance */
+          object = kernel_tex_fetch(__prim_object, -prim_addr - 1);
+
+          for (int mask = node_mask; mask; mask &= mask - 1) {
+            const int i = __bsf((uint32_t)mask);
+            packet_isects[i].t *= bvh_instance_push(
+                kg, object, &rays[i], &P[i], &dir[i], &idir[i]);
+          }
+
+          bvh_packet_transpose(P, &packet_P[0], &packet_P[1], &packet_P[2]);
+          bvh_packet_transpose(idir, &packet_idir[0], &packet_idir[1], &packet_idir[2]);
+          packet_t = bvh_packet_isect_t(packet_isects);
+
+          ++stack_ptr;
+          kernel_assert(stack_ptr < BVH_STACK_SIZE);
+          traversal_stack[stack_ptr] = ENTRYPOINT_SENTINEL;
+          traversal_mask[stack_ptr] = node_mask;
+
+          node_addr = kernel_tex_fetch(__object_node, object);
+        }
+      }
+    } while (node_addr != ENTRYPOINT_SENTINEL);
+
+    if (stack_ptr >= 0) {
+      kernel_assert(object != OBJECT_NONE);
+
+      /* instance pop, the mask stored with the sentinel is the one the instance was entered
+       * with */
+      for (int mask = node_mask; mask; mask &= mask - 1) {
+        const int i = __bsf((uint32_t)mask);
+        packet_isects[i].t = bvh_instance_pop(
+            kg, object, &rays[i], &P[i], &dir[i], &idir[i], packet_isects[i].t);
+      }
+
+      bvh_packet_transpose(P, &packet_P[0], &packet_P[1], &packet_P[2]);
+      bvh_packet_transpose(idir, &packet_idir[0], &packet_idir[1], &packet_idir[2]);
+      packet_t = bvh_packet_isect_t(packet_isects);
+
+      object = OBJECT_NONE;
+      node_addr = traversal_stack[stack_ptr];
+      node_mask = traversal_mask[stack_ptr];
+      --stack_ptr;
+    }
+  }
+
+  for (int i = 0; i < num_rays; i++) {
+    isects[i] = packet_isects[i];
+  }
+}
@@ -43,6 +43,8 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
    * - test restrict attribute for pointers
    */
 
+  PROFILING_INIT_BVH(kg);
+
   /* traversal stack in CUDA thread-local memory */
   int traversal_stack[BVH_STACK_SIZE];
   traversal_stack[0] = ENTRYPOINT_SENTINEL;
@@ -75,6 +77,7 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
         int node_addr_child1, traverse_mask;
         float dist[2];
         float4 cnodes = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
+        PROFILING_BVH_NODE();
 
         {
           traverse_mask = NODE_INTERSECT(kg,
@@ -125,6 +128,7 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
 
         if (prim_addr >= 0) {
           const int prim_addr2 = __float_as_int(leaf.y);
+          PROFILING_BVH_PRIMITIVES(prim_addr2 - prim_addr);
           const uint type = __float_as_int(leaf.w);
 
           /* pop */
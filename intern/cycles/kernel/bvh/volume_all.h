@@ -48,6 +48,8 @@ ccl_device_inline
    * - test restrict attribute for pointers
    */
 
+  PROFILING_INIT_BVH(kg);
+
   /* traversal stack in CUDA thread-local memory */
   int traversal_stack[BVH_STACK_SIZE];
   traversal_stack[0] = ENTRYPOINT_SENTINEL;
@@ -81,6 +83,7 @@ ccl_device_inline
         int node_addr_child1, traverse_mask;
         float dist[2];
         float4 cnodes = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
+        PROFILING_BVH_NODE();
 
         traverse_mask = NODE_INTERSECT(kg,
                                        P,
@@ -129,6 +132,7 @@ ccl_device_inline
 
         if (prim_addr >= 0) {
           const int prim_addr2 = __float_as_int(leaf.y);
+          PROFILING_BVH_PRIMITIVES(prim_addr2 - prim_addr);
           const uint type = __float_as_int(leaf.w);
           bool hit;
 
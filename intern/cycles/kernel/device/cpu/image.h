@@ -22,6 +22,8 @@
 #  include <nanovdb/util/SampleFromVoxels.h>
 #endif
 
+#include "util/texture_cache.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Make template functions private so symbols don't conflict between kernels with different
@@ -44,6 +46,68 @@ ccl_device_inline float frac(float x, int *ix)
   return x - (float)i;
 }
 
+/* Access to pixels of an image stored fully in memory. */
+template<typename T> struct TextureArrayAccessor {
+  const T *data;
+  const int width;
+
+  ccl_always_inline TextureArrayAccessor(const TextureInfo &info)
+      : data((const T *)info.data), width(info.width)
+  {
+  }
+
+  ccl_always_inline T fetch(const int x, const int y)
+  {
+    return data[x + y * width];
+  }
+};
+
+/* Access to pixels of an image loaded on demand by the texture cache. The last used tile stays
+ * acquired until the next tile is needed, since neighboring pixels are usually in the same
+ * tile. */
+template<typename T> struct TextureCacheAccessor {
+  TextureCacheImage *image;
+  const int level;
+  const int tile_size_log2;
+  const int tile_mask;
+
+  TextureCacheTile *tile;
+  int tile_x, tile_y;
+
+  ccl_always_inline TextureCacheAccessor(const TextureInfo &info)
+      : image((TextureCacheImage *)info.data),
+        level(image->base_level),
+        tile_size_log2(image->tile_size_log2),
+        tile_mask((1 << image->tile_size_log2) - 1),
+        tile(NULL),
+        tile_x(-1),
+        tile_y(-1)
+  {
+  }
+
+  ccl_always_inline ~TextureCacheAccessor()
+  {
+    if (tile) {
+      TextureCacheImage::release_tile(tile);
+    }
+  }
+
+  ccl_always_inline T fetch(const int x, const int y)
+  {
+    const int tx = x >> tile_size_log2;
+    const int ty = y >> tile_size_log2;
+    if (tx != tile_x || ty != tile_y) {
+      if (tile) {
+        TextureCacheImage::release_tile(tile);
+      }
+      tile = image->acquire_tile(level, tx, ty);
+      tile_x = tx;
+      tile_y = ty;
+    }
+    return ((const T *)tile->pixels)[((y & tile_mask) << tile_size_log2) + (x & tile_mask)];
+  }
+};
+
 template<typename T> struct TextureInterpolator {
 
   static ccl_always_inline float4 read(float4 r)
@@ -93,12 +157,13 @@ template<typename T> struct TextureInterpolator {
     return make_float4(r.x * f, r.y * f, r.z * f, r.w * f);
   }
 
-  static ccl_always_inline float4 read(const T *data, int x, int y, int width, int height)
+  template<typename Accessor>
+  static ccl_always_inline float4 read(Accessor &acc, int x, int y, int width, int height)
   {
     if (x < 0 || y < 0 || x >= width || y >= height) {
       return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
     }
-    return read(data[y * width + x]);
+    return read(acc.fetch(x, y));
   }
 
   static ccl_always_inline int wrap_periodic(int x, int width)
@@ -116,9 +181,12 @@ template<typename T> struct TextureInterpolator {
 
   /* ********  2D interpolation ******** */
 
-  static ccl_always_inline float4 interp_closest(const TextureInfo &info, float x, float y)
+  template<typename Accessor>
+  static ccl_always_inline float4 interp_closest(const TextureInfo &info,
+                                                 Accessor &acc,
+                                                 float x,
+                                                 float y)
   {
-    const T *data = (const T *)info.data;
     const int width = info.width;
     const int height = info.height;
     int ix, iy;
@@ -142,12 +210,15 @@ template<typename T> struct TextureInterpolator {
         kernel_assert(0);
         return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
     }
-    return read(data[ix + iy * width]);
+    return read(acc.fetch(ix, iy));
   }
 
-  static ccl_always_inline float4 interp_linear(const TextureInfo &info, float x, float y)
+  template<typename Accessor>
+  static ccl_always_inline float4 interp_linear(const TextureInfo &info,
+                                                Accessor &acc,
+                                                float x,
+                                                float y)
   {
-    const T *data = (const T *)info.data;
     const int width = info.width;
     const int height = info.height;
     int ix, iy, nix, niy;
@@ -174,15 +245,18 @@ template<typename T> struct TextureInterpolator {
         kernel_assert(0);
         return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
     }
-    return (1.0f - ty) * (1.0f - tx) * read(data, ix, iy, width, height) +
-           (1.0f - ty) * tx * read(data, nix, iy, width, height) +
-           ty * (1.0f - tx) * read(data, ix, niy, width, height) +
-           ty * tx * read(data, nix, niy, width, height);
+    return (1.0f - ty) * (1.0f - tx) * read(acc, ix, iy, width, height) +
+           (1.0f - ty) * tx * read(acc, nix, iy, width, height) +
+           ty * (1.0f - tx) * read(acc, ix, niy, width, height) +
+           ty * tx * read(acc, nix, niy, width, height);
   }
 
-  static ccl_always_inline float4 interp_cubic(const TextureInfo &info, float x, float y)
+  template<typename Accessor>
+  static ccl_always_inline float4 interp_cubic(const TextureInfo &info,
+                                               Accessor &acc,
+                                               float x,
+                                               float y)
   {
-    const T *data = (const T *)info.data;
     const int width = info.width;
     const int height = info.height;
     int ix, iy, nix, niy;
@@ -228,7 +302,7 @@ template<typename T> struct TextureInterpolator {
     /* Some helper macro to keep code reasonable size,
      * let compiler to inline all the matrix multiplications.
      */
-#define DATA(x, y) (read(data, xc[x], yc[y], width, height))
+#define DATA(x, y) (read(acc, xc[x], yc[y], width, height))
 #define TERM(col) \
   (v[col] * \
    (u[0] * DATA(0, col) + u[1] * DATA(1, col) + u[2] * DATA(2, col) + u[3] * DATA(3, col)))
@@ -242,19 +316,30 @@ template<typename T> struct TextureInterpolator {
 #undef DATA
   }
 
-  static ccl_always_inline float4 interp(const TextureInfo &info, float x, float y)
+  template<typename Accessor>
+  static ccl_always_inline float4 interp(const TextureInfo &info, Accessor &acc, float x, float y)
   {
-    if (UNLIKELY(!info.data)) {
-      return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
-    }
     switch (info.interpolation) {
       case INTERPOLATION_CLOSEST:
-        return interp_closest(info, x, y);
+        return interp_closest(info, acc, x, y);
       case INTERPOLATION_LINEAR:
-        return interp_linear(info, x, y);
+        return interp_linear(info, acc, x, y);
       default:
-        return interp_cubic(info, x, y);
+        return interp_cubic(info, acc, x, y);
+    }
+  }
+
+  static ccl_always_inline float4 interp(const TextureInfo &info, float x, float y)
+  {
+    if (UNLIKELY(!info.data)) {
+      return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+    if (info.use_cache) {
+      TextureCacheAccessor<T> acc(info);
+      return interp(info, acc, x, y);
     }
+    TextureArrayAccessor<T> acc(info);
+    return interp(info, acc, x, y);
   }
 
   /* ********  3D interpolation ******** */
@@ -35,6 +35,14 @@ enum ObjectTransform {
 
 enum ObjectVectorTransform { OBJECT_PASS_MOTION_PRE = 0, OBJECT_PASS_MOTION_POST = 1 };
 
+/* Data shared between instances */
+
+ccl_device_inline ccl_global const KernelObjectPrototype *object_prototype(KernelGlobals kg,
+                                                                          int object)
+{
+  return &kernel_tex_fetch(__object_prototypes, kernel_tex_fetch(__objects, object).prototype);
+}
+
 /* Object to world space transformation */
 
 ccl_device_inline Transform object_fetch_transform(KernelGlobals kg,
@@ -42,7 +50,8 @@ ccl_device_inline Transform object_fetch_transform(KernelGlobals kg,
                                                    enum ObjectTransform type)
 {
   if (type == OBJECT_INVERSE_TRANSFORM) {
-    return kernel_tex_fetch(__objects, object).itfm;
+    /* Computed here rather than stored per object, to keep instances small. */
+    return transform_quick_inverse(kernel_tex_fetch(__objects, object).tfm);
   }
   else {
     return kernel_tex_fetch(__objects, object).tfm;
@@ -78,7 +87,7 @@ ccl_device_inline Transform object_fetch_transform_motion(KernelGlobals kg, int
 {
   const uint motion_offset = kernel_tex_fetch(__objects, object).motion_offset;
   ccl_global const DecomposedTransform *motion = &kernel_tex_fetch(__object_motion, motion_offset);
-  const uint num_steps = kernel_tex_fetch(__objects, object).numsteps * 2 + 1;
+  const uint num_steps = object_prototype(kg, object)->numsteps * 2 + 1;
 
   Transform tfm;
   transform_motion_array_interpolate(&tfm, motion, num_steps, time);
@@ -270,8 +279,8 @@ ccl_device_inline float3 object_color(KernelGlobals kg, int object)
   if (object == OBJECT_NONE)
     return make_float3(0.0f, 0.0f, 0.0f);
 
-  ccl_global const KernelObject *kobject = &kernel_tex_fetch(__objects, object);
-  return make_float3(kobject->color[0], kobject->color[1], kobject->color[2]);
+  ccl_global const KernelObjectPrototype *kprototype = object_prototype(kg, object);
+  return make_float3(kprototype->color[0], kprototype->color[1], kprototype->color[2]);
 }
 
 /* Pass ID number of object */
@@ -281,7 +290,7 @@ ccl_device_inline float object_pass_id(KernelGlobals kg, int object)
   if (object == OBJECT_NONE)
     return 0.0f;
 
-  return kernel_tex_fetch(__objects, object).pass_id;
+  return object_prototype(kg, object)->pass_id;
 }
 
 /* Per lamp random number for shader variation */
@@ -345,14 +354,16 @@ ccl_device_inline void object_motion_info(KernelGlobals kg,
                                           ccl_private int *numverts,
                                           ccl_private int *numkeys)
 {
+  ccl_global const KernelObjectPrototype *kprototype = object_prototype(kg, object);
+
   if (numkeys) {
-    *numkeys = kernel_tex_fetch(__objects, object).numkeys;
+    *numkeys = kprototype->numkeys;
   }
 
   if (numsteps)
-    *numsteps = kernel_tex_fetch(__objects, object).numsteps;
+    *numsteps = kprototype->numsteps;
   if (numverts)
-    *numverts = kernel_tex_fetch(__objects, object).numverts;
+    *numverts = kprototype->numverts;
 }
 
 /* Offset to an objects patch map */
@@ -373,7 +384,7 @@ ccl_device_inline float object_volume_density(KernelGlobals kg, int object)
     return 1.0f;
   }
 
-  return kernel_tex_fetch(__objects, object).volume_density;
+  return object_prototype(kg, object)->volume_density;
 }
 
 ccl_device_inline float object_volume_step_size(KernelGlobals kg, int object)
@@ -399,7 +410,7 @@ ccl_device_inline float object_cryptomatte_id(KernelGlobals kg, int object)
   if (object == OBJECT_NONE)
     return 0.0f;
 
-  return kernel_tex_fetch(__objects, object).cryptomatte_object;
+  return object_prototype(kg, object)->cryptomatte_object;
 }
 
 ccl_device_inline float object_cryptomatte_asset_id(KernelGlobals kg, int object)
@@ -407,7 +418,7 @@ ccl_device_inline float object_cryptomatte_asset_id(KernelGlobals kg, int object
   if (object == OBJECT_NONE)
     return 0;
 
-  return kernel_tex_fetch(__objects, object).cryptomatte_asset;
+  return object_prototype(kg, object)->cryptomatte_asset;
 }
 
 /* Particle data from which object was instanced */
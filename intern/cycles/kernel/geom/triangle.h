@@ -24,21 +24,77 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Vertex positions and normals, read either from the full precision arrays or from the compact
+ * mesh storage. In compact mode tri_vindex.w is the index of the mesh bounds instead of the
+ * offset of the triangle vertices. */
+
+ccl_device_inline float3 triangle_compact_vertex(KernelGlobals kg, uint vert, uint bounds)
+{
+  const uint2 data = kernel_tex_fetch(__tri_verts_compact, vert);
+  const float3 bounds_min = kernel_tex_fetch(__tri_verts_compact_bounds, bounds * 2 + 0);
+  const float3 bounds_scale = kernel_tex_fetch(__tri_verts_compact_bounds, bounds * 2 + 1);
+
+  const uint x = data.x & TRIANGLE_COMPACT_MASK;
+  const uint y = ((data.x >> TRIANGLE_COMPACT_BITS) |
+                  (data.y << (32 - TRIANGLE_COMPACT_BITS))) &
+                 TRIANGLE_COMPACT_MASK;
+  const uint z = (data.y >> (2 * TRIANGLE_COMPACT_BITS - 32)) & TRIANGLE_COMPACT_MASK;
+
+  return bounds_min + make_float3((float)x, (float)y, (float)z) * bounds_scale;
+}
+
+ccl_device_inline void triangle_vertices_for_vindex(KernelGlobals kg,
+                                                    const uint4 tri_vindex,
+                                                    float3 P[3])
+{
+#ifdef __KERNEL_CPU__
+  if (kernel_data.bvh.use_compact_mesh) {
+    P[0] = triangle_compact_vertex(kg, tri_vindex.x, tri_vindex.w);
+    P[1] = triangle_compact_vertex(kg, tri_vindex.y, tri_vindex.w);
+    P[2] = triangle_compact_vertex(kg, tri_vindex.z, tri_vindex.w);
+    return;
+  }
+#endif
+
+  P[0] = kernel_tex_fetch(__tri_verts, tri_vindex.w + 0);
+  P[1] = kernel_tex_fetch(__tri_verts, tri_vindex.w + 1);
+  P[2] = kernel_tex_fetch(__tri_verts, tri_vindex.w + 2);
+}
+
+ccl_device_inline float3 triangle_vertex_normal(KernelGlobals kg, uint vert)
+{
+#ifdef __KERNEL_CPU__
+  if (kernel_data.bvh.use_compact_mesh) {
+    /* Octahedral decoding. */
+    const uint data = kernel_tex_fetch(__tri_vnormal_compact, vert);
+    const float u = (float)(data & 0xFFFF) * (2.0f / 65535.0f) - 1.0f;
+    const float v = (float)(data >> 16) * (2.0f / 65535.0f) - 1.0f;
+
+    float3 N = make_float3(u, v, 1.0f - fabsf(u) - fabsf(v));
+    const float t = max(-N.z, 0.0f);
+    N.x += (N.x >= 0.0f) ? -t : t;
+    N.y += (N.y >= 0.0f) ? -t : t;
+    return normalize(N);
+  }
+#endif
+
+  return kernel_tex_fetch(__tri_vnormal, vert);
+}
+
 /* Normal on triangle. */
 ccl_device_inline float3 triangle_normal(KernelGlobals kg, ccl_private ShaderData *sd)
 {
   /* load triangle vertices */
   const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
-  const float3 v0 = kernel_tex_fetch(__tri_verts, tri_vindex.w + 0);
-  const float3 v1 = kernel_tex_fetch(__tri_verts, tri_vindex.w + 1);
-  const float3 v2 = kernel_tex_fetch(__tri_verts, tri_vindex.w + 2);
+  float3 V[3];
+  triangle_vertices_for_vindex(kg, tri_vindex, V);
 
   /* return normal */
   if (sd->object_flag & SD_OBJECT_NEGATIVE_SCALE_APPLIED) {
-    return normalize(cross(v2 - v0, v1 - v0));
+    return normalize(cross(V[2] - V[0], V[1] - V[0]));
   }
   else {
-    return normalize(cross(v1 - v0, v2 - v0));
+    return normalize(cross(V[1] - V[0], V[2] - V[0]));
   }
 }
 
@@ -54,9 +110,9 @@ ccl_device_inline void triangle_point_normal(KernelGlobals kg,
 {
   /* load triangle vertices */
   const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  float3 v0 = kernel_tex_fetch(__tri_verts, tri_vindex.w + 0);
-  float3 v1 = kernel_tex_fetch(__tri_verts, tri_vindex.w + 1);
-  float3 v2 = kernel_tex_fetch(__tri_verts, tri_vindex.w + 2);
+  float3 V[3];
+  triangle_vertices_for_vindex(kg, tri_vindex, V);
+  const float3 v0 = V[0], v1 = V[1], v2 = V[2];
   /* compute point */
   float t = 1.0f - u - v;
   *P = (u * v0 + v * v1 + t * v2);
@@ -78,9 +134,7 @@ ccl_device_inline void triangle_point_normal(KernelGlobals kg,
 ccl_device_inline void triangle_vertices(KernelGlobals kg, int prim, float3 P[3])
 {
   const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  P[0] = kernel_tex_fetch(__tri_verts, tri_vindex.w + 0);
-  P[1] = kernel_tex_fetch(__tri_verts, tri_vindex.w + 1);
-  P[2] = kernel_tex_fetch(__tri_verts, tri_vindex.w + 2);
+  triangle_vertices_for_vindex(kg, tri_vindex, P);
 }
 
 /* Triangle vertex locations and vertex normals */
@@ -91,12 +145,10 @@ ccl_device_inline void triangle_vertices_and_normals(KernelGlobals kg,
                                                      float3 N[3])
 {
   const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  P[0] = kernel_tex_fetch(__tri_verts, tri_vindex.w + 0);
-  P[1] = kernel_tex_fetch(__tri_verts, tri_vindex.w + 1);
-  P[2] = kernel_tex_fetch(__tri_verts, tri_vindex.w + 2);
-  N[0] = kernel_tex_fetch(__tri_vnormal, tri_vindex.x);
-  N[1] = kernel_tex_fetch(__tri_vnormal, tri_vindex.y);
-  N[2] = kernel_tex_fetch(__tri_vnormal, tri_vindex.z);
+  triangle_vertices_for_vindex(kg, tri_vindex, P);
+  N[0] = triangle_vertex_normal(kg, tri_vindex.x);
+  N[1] = triangle_vertex_normal(kg, tri_vindex.y);
+  N[2] = triangle_vertex_normal(kg, tri_vindex.z);
 }
 
 /* Interpolate smooth vertex normal from vertices */
@@ -106,9 +158,9 @@ triangle_smooth_normal(KernelGlobals kg, float3 Ng, int prim, float u, float v)
 {
   /* load triangle vertices */
   const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  float3 n0 = kernel_tex_fetch(__tri_vnormal, tri_vindex.x);
-  float3 n1 = kernel_tex_fetch(__tri_vnormal, tri_vindex.y);
-  float3 n2 = kernel_tex_fetch(__tri_vnormal, tri_vindex.z);
+  float3 n0 = triangle_vertex_normal(kg, tri_vindex.x);
+  float3 n1 = triangle_vertex_normal(kg, tri_vindex.y);
+  float3 n2 = triangle_vertex_normal(kg, tri_vindex.z);
 
   float3 N = safe_normalize((1.0f - u - v) * n2 + u * n0 + v * n1);
 
@@ -120,9 +172,9 @@ ccl_device_inline float3 triangle_smooth_normal_unnormalized(
 {
   /* load triangle vertices */
   const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  float3 n0 = kernel_tex_fetch(__tri_vnormal, tri_vindex.x);
-  float3 n1 = kernel_tex_fetch(__tri_vnormal, tri_vindex.y);
-  float3 n2 = kernel_tex_fetch(__tri_vnormal, tri_vindex.z);
+  float3 n0 = triangle_vertex_normal(kg, tri_vindex.x);
+  float3 n1 = triangle_vertex_normal(kg, tri_vindex.y);
+  float3 n2 = triangle_vertex_normal(kg, tri_vindex.z);
 
   /* ensure that the normals are in object space */
   if (sd->object_flag & SD_OBJECT_TRANSFORM_APPLIED) {
@@ -145,13 +197,12 @@ ccl_device_inline void triangle_dPdudv(KernelGlobals kg,
 {
   /* fetch triangle vertex coordinates */
   const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  const float3 p0 = kernel_tex_fetch(__tri_verts, tri_vindex.w + 0);
-  const float3 p1 = kernel_tex_fetch(__tri_verts, tri_vindex.w + 1);
-  const float3 p2 = kernel_tex_fetch(__tri_verts, tri_vindex.w + 2);
+  float3 P[3];
+  triangle_vertices_for_vindex(kg, tri_vindex, P);
 
   /* compute derivatives of P w.r.t. uv */
-  *dPdu = (p0 - p2);
-  *dPdv = (p1 - p2);
+  *dPdu = (P[0] - P[2]);
+  *dPdv = (P[1] - P[2]);
 }
 
 /* Reading attributes on various triangle elements */
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2011-2022 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "kernel/integrator/shader_eval.h"
+
+#include "kernel/util/color.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Path Guiding
+ *
+ * Incident radiance is learned in a uniform grid over the scene bounds, where every cell holds
+ * a histogram over directions. Paths that hit an emitter or the background after a diffuse or
+ * glossy bounce splat their radiance into the cell of the bounce vertex. Between render passes
+ * the host turns the accumulated training data into a CDF per cell, which the kernel then
+ * samples in a one-sample mixture with the BSDF.
+ *
+ * The field is read-only while a pass is being rendered, so the mixture PDF is exact and the
+ * result stays unbiased regardless of how well the field is trained. */
+
+#ifdef __PATH_GUIDING__
+
+ccl_device_inline int guiding_cell_index(KernelGlobals kg, const float3 P)
+{
+  int index = 0;
+  for (int i = 0; i < 3; i++) {
+    const float t = (P[i] - kernel_data.integrator.guiding_bounds_min[i]) *
+                    kernel_data.integrator.guiding_bounds_inv_size[i];
+    const int cell = clamp(
+        float_to_int(t * GUIDING_GRID_RESOLUTION), 0, GUIDING_GRID_RESOLUTION - 1);
+    index = index * GUIDING_GRID_RESOLUTION + cell;
+  }
+  return index;
+}
+
+/* Equal area mapping of the sphere, bins are uniform in cos(theta) and phi. */
+ccl_device_inline int guiding_direction_bin(const float3 D)
+{
+  const float u = (D.z + 1.0f) * 0.5f;
+  const float v = atan2f(D.y, D.x) * M_1_2PI_F + 0.5f;
+  const int theta_bin = clamp(float_to_int(u * GUIDING_THETA_BINS), 0, GUIDING_THETA_BINS - 1);
+  const int phi_bin = clamp(float_to_int(v * GUIDING_PHI_BINS), 0, GUIDING_PHI_BINS - 1);
+  return theta_bin * GUIDING_PHI_BINS + phi_bin;
+}
+
+/* Probability of a single bin, read from the cell CDF. */
+ccl_device_inline float guiding_bin_probability(ccl_global const float *cdf, const int bin)
+{
+  return (bin == 0) ? cdf[0] : cdf[bin] - cdf[bin - 1];
+}
+
+/* Solid angle PDF of sampling direction D from the cell. */
+ccl_device_inline float guiding_direction_pdf(KernelGlobals kg, const int cell, const float3 D)
+{
+  ccl_global const float *cdf = &kernel_tex_fetch(__guiding_field, cell * GUIDING_BINS);
+  return guiding_bin_probability(cdf, guiding_direction_bin(D)) *
+         (GUIDING_BINS / M_4PI_F);
+}
+
+ccl_device float3 guiding_direction_sample(
+    KernelGlobals kg, const int cell, const float randu, const float randv, ccl_private float *pdf)
+{
+  ccl_global const float *cdf = &kernel_tex_fetch(__guiding_field, cell * GUIDING_BINS);
+
+  /* Binary search for the first bin with CDF above randu. */
+  int first = 0;
+  int len = GUIDING_BINS;
+  while (len > 0) {
+    const int half_len = len >> 1;
+    const int middle = first + half_len;
+    if (randu >= cdf[middle]) {
+      first = middle + 1;
+      len = len - half_len - 1;
+    }
+    else {
+      len = half_len;
+    }
+  }
+  const int bin = min(first, GUIDING_BINS - 1);
+
+  /* Rescale random number to position inside the bin, to preserve stratification. */
+  const float cdf_low = (bin == 0) ? 0.0f : cdf[bin - 1];
+  const float probability = cdf[bin] - cdf_low;
+  const float du = saturatef((randu - cdf_low) / probability);
+
+  const int theta_bin = bin / GUIDING_PHI_BINS;
+  const int phi_bin = bin - theta_bin * GUIDING_PHI_BINS;
+
+  const float z = ((theta_bin + du) * (2.0f / GUIDING_THETA_BINS)) - 1.0f;
+  const float phi = ((phi_bin + randv) * (1.0f / GUIDING_PHI_BINS) - 0.5f) * M_2PI_F;
+  const float r = safe_sqrtf(1.0f - z * z);
+
+  *pdf = probability * (GUIDING_BINS / M_4PI_F);
+  return make_float3(r * cosf(phi), r * sinf(phi), z);
+}
+
+/* Guiding is only used for shaders where all closures can be evaluated, sharp closures and
+ * subsurface scattering are left to the regular BSDF sampling. Returns the cell to guide with,
+ * or GUIDING_CELL_NONE. */
+ccl_device int guiding_surface_cell(KernelGlobals kg, ccl_private const ShaderData *sd)
+{
+  if (!kernel_data.integrator.use_guiding || !(sd->flag & SD_BSDF_HAS_EVAL) ||
+      (sd->flag & SD_BSSRDF)) {
+    return GUIDING_CELL_NONE;
+  }
+
+  for (int i = 0; i < sd->num_closure; i++) {
+    ccl_private const ShaderClosure *sc = &sd->closure[i];
+    if (CLOSURE_IS_BSDF_SINGULAR(sc->type)) {
+      return GUIDING_CELL_NONE;
+    }
+  }
+
+  /* Cells without any training data have an all zero CDF. */
+  const int cell = guiding_cell_index(kg, sd->P);
+  if (kernel_tex_fetch(__guiding_field, cell * GUIDING_BINS + GUIDING_BINS - 1) == 0.0f) {
+    return GUIDING_CELL_NONE;
+  }
+
+  return cell;
+}
+
+ccl_device_inline float guiding_surface_probability(KernelGlobals kg, const int cell)
+{
+  return (cell != GUIDING_CELL_NONE) ? kernel_data.integrator.guiding_probability : 0.0f;
+}
+
+/* Combine BSDF PDF with the guiding PDF for the one-sample mixture. Singular directions can only
+ * come from the BSDF, and there the guiding term drops out. */
+ccl_device_inline float guiding_surface_mix_pdf(KernelGlobals kg,
+                                                const int cell,
+                                                const float3 D,
+                                                const float bsdf_pdf,
+                                                const int label)
+{
+  if (cell == GUIDING_CELL_NONE) {
+    return bsdf_pdf;
+  }
+
+  const float probability = kernel_data.integrator.guiding_probability;
+  if (label & LABEL_SINGULAR) {
+    return (1.0f - probability) * bsdf_pdf;
+  }
+
+  return probability * guiding_direction_pdf(kg, cell, D) + (1.0f - probability) * bsdf_pdf;
+}
+
+/* Sample a direction from the guiding field and evaluate all BSDF closures for it. */
+ccl_device int guiding_surface_sample(KernelGlobals kg,
+                                      ccl_private ShaderData *sd,
+                                      const int cell,
+                                      const float randu,
+                                      const float randv,
+                                      ccl_private BsdfEval *bsdf_eval,
+                                      ccl_private float3 *omega_in,
+                                      ccl_private differential3 *domega_in,
+                                      ccl_private float *pdf)
+{
+  float guiding_pdf;
+  *omega_in = guiding_direction_sample(kg, cell, randu, randv, &guiding_pdf);
+  domega_in->dx = zero_float3();
+  domega_in->dy = zero_float3();
+
+  const bool is_transmission = shader_bsdf_is_transmission(sd, *omega_in);
+  const float bsdf_pdf = shader_bsdf_eval(kg, sd, *omega_in, is_transmission, bsdf_eval, 0);
+
+  const float probability = kernel_data.integrator.guiding_probability;
+  *pdf = probability * guiding_pdf + (1.0f - probability) * bsdf_pdf;
+
+  /* Classify the bounce by the closure with the largest sample weight, for bounce limits and
+   * ray visibility. */
+  float max_weight = 0.0f;
+  int label = LABEL_DIFFUSE;
+  for (int i = 0; i < sd->num_closure; i++) {
+    ccl_private const ShaderClosure *sc = &sd->closure[i];
+    if (CLOSURE_IS_BSDF(sc->type) && sc->sample_weight > max_weight) {
+      max_weight = sc->sample_weight;
+      label = CLOSURE_IS_BSDF_DIFFUSE(sc->type) ? LABEL_DIFFUSE : LABEL_GLOSSY;
+    }
+  }
+
+  return label | ((is_transmission) ? LABEL_TRANSMIT : LABEL_REFLECT);
+}
+
+/* Splat radiance arriving at the previous bounce vertex P from direction D. */
+ccl_device_inline void guiding_record_radiance(KernelGlobals kg,
+                                               ConstIntegratorState state,
+                                               const float3 P,
+                                               const float3 D,
+                                               const float3 L)
+{
+  if (!kernel_data.integrator.use_guiding) {
+    return;
+  }
+
+  const uint32_t path_flag = INTEGRATOR_STATE(state, path, flag);
+  if (path_flag & (PATH_RAY_MIS_SKIP | PATH_RAY_VOLUME_SCATTER)) {
+    return;
+  }
+
+  const float mis_ray_pdf = INTEGRATOR_STATE(state, path, mis_ray_pdf);
+  const float value = linear_rgb_to_gray(kg, L);
+  if (!(mis_ray_pdf > 0.0f && value > 0.0f && isfinite_safe(value))) {
+    return;
+  }
+
+  const int index = guiding_cell_index(kg, P) * GUIDING_BINS + guiding_direction_bin(D);
+  ccl_global float *training = kernel_tex_array(__guiding_training);
+  atomic_add_and_fetch_float(training + index, value / mis_ray_pdf);
+}
+
+#endif /* __PATH_GUIDING__ */
+
+CCL_NAMESPACE_END
@@ -105,6 +105,7 @@ ccl_device bool integrator_init_from_camera(KernelGlobals kg,
 
     /* Write camera ray to state. */
     integrator_state_write_ray(kg, state, &ray);
+    PROFILING_COUNT(kg, PROFILING_COUNTER_CAMERA_RAYS, 1);
   }
 
   /* Initialize path state for path integration. */
@@ -299,59 +299,150 @@ ccl_device_forceinline void integrator_intersect_next_kernel_after_volume(
   }
 }
 
-ccl_device void integrator_intersect_closest(KernelGlobals kg,
-                                             IntegratorState state,
-                                             ccl_global float *ccl_restrict render_buffer)
+/* Read ray to intersect from the integrator state. */
+ccl_device_forceinline void integrator_intersect_closest_setup(KernelGlobals kg,
+                                                               ConstIntegratorState state,
+                                                               ccl_private Ray *ccl_restrict ray)
 {
-  PROFILING_INIT(kg, PROFILING_INTERSECT_CLOSEST);
-
   /* Read ray from integrator state into local memory. */
-  Ray ray ccl_optional_struct_init;
-  integrator_state_read_ray(kg, state, &ray);
-  kernel_assert(ray.t != 0.0f);
-
-  const uint visibility = path_state_ray_visibility(state);
-  const int last_isect_prim = INTEGRATOR_STATE(state, isect, prim);
-  const int last_isect_object = INTEGRATOR_STATE(state, isect, object);
+  integrator_state_read_ray(kg, state, ray);
+  kernel_assert(ray->t != 0.0f);
 
   /* Trick to use short AO rays to approximate indirect light at the end of the path. */
   if (path_state_ao_bounce(kg, state)) {
-    ray.t = kernel_data.integrator.ao_bounces_distance;
+    ray->t = kernel_data.integrator.ao_bounces_distance;
 
+    const int last_isect_object = INTEGRATOR_STATE(state, isect, object);
     if (last_isect_object != OBJECT_NONE) {
-      const float object_ao_distance = kernel_tex_fetch(__objects, last_isect_object).ao_distance;
+      const float object_ao_distance = object_prototype(kg, last_isect_object)->ao_distance;
       if (object_ao_distance != 0.0f) {
-        ray.t = object_ao_distance;
+        ray->t = object_ao_distance;
       }
     }
   }
+}
 
-  /* Scene Intersection. */
-  Intersection isect ccl_optional_struct_init;
-  bool hit = scene_intersect(kg, &ray, visibility, &isect);
-
+/* Handle light intersection, write intersection and schedule next kernel. */
+ccl_device_forceinline void integrator_intersect_closest_finish(
+    KernelGlobals kg,
+    IntegratorState state,
+    ccl_private const Ray *ccl_restrict ray,
+    ccl_private Intersection *ccl_restrict isect,
+    bool hit,
+    ccl_global float *ccl_restrict render_buffer)
+{
   /* TODO: remove this and do it in the various intersection functions instead. */
   if (!hit) {
-    isect.prim = PRIM_NONE;
+    isect->prim = PRIM_NONE;
   }
 
   /* Light intersection for MIS. */
   if (kernel_data.integrator.use_lamp_mis) {
     /* NOTE: if we make lights visible to camera rays, we'll need to initialize
      * these in the path_state_init. */
+    const int last_isect_prim = INTEGRATOR_STATE(state, isect, prim);
+    const int last_isect_object = INTEGRATOR_STATE(state, isect, object);
     const int last_type = INTEGRATOR_STATE(state, isect, type);
     const uint32_t path_flag = INTEGRATOR_STATE(state, path, flag);
     hit = lights_intersect(
-              kg, state, &ray, &isect, last_isect_prim, last_isect_object, last_type, path_flag) ||
+              kg, state, ray, isect, last_isect_prim, last_isect_object, last_type, path_flag) ||
           hit;
   }
 
   /* Write intersection result into global integrator state memory. */
-  integrator_state_write_isect(kg, state, &isect);
+  integrator_state_write_isect(kg, state, isect);
 
   /* Setup up next kernel to be executed. */
   integrator_intersect_next_kernel<DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST>(
-      kg, state, &isect, render_buffer, hit);
+      kg, state, isect, render_buffer, hit);
+}
+
+ccl_device void integrator_intersect_closest(KernelGlobals kg,
+                                             IntegratorState state,
+                                             ccl_global float *ccl_restrict render_buffer)
+{
+  PROFILING_INIT(kg, PROFILING_INTERSECT_CLOSEST);
+  PROFILING_COUNT(kg, PROFILING_COUNTER_CLOSEST_RAYS, 1);
+
+  Ray ray ccl_optional_struct_init;
+  integrator_intersect_closest_setup(kg, state, &ray);
+
+  /* Scene Intersection. */
+  const uint visibility = path_state_ray_visibility(state);
+  Intersection isect ccl_optional_struct_init;
+  const bool hit = scene_intersect(kg, &ray, visibility, &isect);
+
+  integrator_intersect_closest_finish(kg, state, &ray, &isect, hit, render_buffer);
+}
+
+#ifdef __KERNEL_CPU__
+/* Intersect closest for a packet of paths on the CPU, used for the coherent camera rays of
+ * multiple samples in a pixel. Paths are laid out with a shadow catcher state following each
+ * of them, and only paths queued for this kernel are handled. */
+ccl_device void integrator_intersect_closest_packet(KernelGlobals kg,
+                                                    IntegratorState states,
+                                                    const int num_states,
+                                                    ccl_global float *ccl_restrict render_buffer)
+{
+  kernel_assert(num_states <= INTEGRATOR_PACKET_SIZE_CPU);
+
+#  ifdef __BVH_PACKET__
+  PROFILING_INIT(kg, PROFILING_INTERSECT_CLOSEST);
+
+  IntegratorStateCPU *packet_states[INTEGRATOR_PACKET_SIZE_CPU];
+  Ray rays[INTEGRATOR_PACKET_SIZE_CPU];
+  Intersection isects[INTEGRATOR_PACKET_SIZE_CPU];
+  int num_rays = 0;
+  uint visibility = 0;
+
+  for (int i = 0; i < num_states; i++) {
+    IntegratorStateCPU *state = &states[i * 2];
+    if (INTEGRATOR_STATE(state, path, queued_kernel) !=
+        DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST) {
+      continue;
+    }
+
+    const uint state_visibility = path_state_ray_visibility(state);
+    if (num_rays > 0 && state_visibility != visibility) {
+      integrator_intersect_closest(kg, state, render_buffer);
+      continue;
+    }
+
+    visibility = state_visibility;
+    integrator_intersect_closest_setup(kg, state, &rays[num_rays]);
+    packet_states[num_rays++] = state;
+  }
+
+  if (num_rays == 0) {
+    return;
+  }
+
+  PROFILING_COUNT(kg, PROFILING_COUNTER_CLOSEST_RAYS, num_rays);
+
+  if (scene_intersect_packet(kg, rays, num_rays, visibility, isects)) {
+    for (int i = 0; i < num_rays; i++) {
+      const bool hit = (isects[i].prim != PRIM_NONE);
+      integrator_intersect_closest_finish(
+          kg, packet_states[i], &rays[i], &isects[i], hit, render_buffer);
+    }
+    return;
+  }
+
+  for (int i = 0; i < num_rays; i++) {
+    const bool hit = scene_intersect(kg, &rays[i], visibility, &isects[i]);
+    integrator_intersect_closest_finish(
+        kg, packet_states[i], &rays[i], &isects[i], hit, render_buffer);
+  }
+#  else
+  for (int i = 0; i < num_states; i++) {
+    IntegratorStateCPU *state = &states[i * 2];
+    if (INTEGRATOR_STATE(state, path, queued_kernel) ==
+        DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST) {
+      integrator_intersect_closest(kg, state, render_buffer);
+    }
+  }
+#  endif /* __BVH_PACKET__ */
 }
+#endif /* __KERNEL_CPU__ */
 
 CCL_NAMESPACE_END
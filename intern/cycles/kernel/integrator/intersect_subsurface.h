@@ -25,6 +25,7 @@ ccl_device void integrator_intersect_subsurface(KernelGlobals kg, IntegratorStat
   PROFILING_INIT(kg, PROFILING_INTERSECT_SUBSURFACE);
 
 #ifdef __SUBSURFACE__
+  PROFILING_COUNT(kg, PROFILING_COUNTER_SUBSURFACE_RAYS, 1);
   if (subsurface_scatter(kg, state)) {
     return;
   }
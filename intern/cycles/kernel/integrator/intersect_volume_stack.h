@@ -47,6 +47,7 @@ ccl_device void integrator_volume_stack_update_for_subsurface(KernelGlobals kg,
 
 #ifdef __VOLUME_RECORD_ALL__
   Intersection hits[2 * MAX_VOLUME_STACK_SIZE + 1];
+  PROFILING_COUNT(kg, PROFILING_COUNTER_VOLUME_STACK_RAYS, 1);
   uint num_hits = scene_intersect_volume_all(
       kg, &volume_ray, hits, 2 * volume_stack_size, visibility);
   if (num_hits > 0) {
@@ -62,8 +63,12 @@ ccl_device void integrator_volume_stack_update_for_subsurface(KernelGlobals kg,
 #else
   Intersection isect;
   int step = 0;
-  while (step < 2 * volume_stack_size &&
-         scene_intersect_volume(kg, &volume_ray, &isect, visibility)) {
+  while (step < 2 * volume_stack_size) {
+    PROFILING_COUNT(kg, PROFILING_COUNTER_VOLUME_STACK_RAYS, 1);
+    if (!scene_intersect_volume(kg, &volume_ray, &isect, visibility)) {
+      break;
+    }
+
     shader_setup_from_ray(kg, stack_sd, &volume_ray, &isect);
     volume_stack_enter_exit(kg, state, stack_sd);
 
@@ -113,6 +118,7 @@ ccl_device void integrator_volume_stack_init(KernelGlobals kg, IntegratorState s
 
 #ifdef __VOLUME_RECORD_ALL__
   Intersection hits[2 * MAX_VOLUME_STACK_SIZE + 1];
+  PROFILING_COUNT(kg, PROFILING_COUNTER_VOLUME_STACK_RAYS, 1);
   uint num_hits = scene_intersect_volume_all(
       kg, &volume_ray, hits, 2 * volume_stack_size, visibility);
   if (num_hits > 0) {
@@ -163,6 +169,7 @@ ccl_device void integrator_volume_stack_init(KernelGlobals kg, IntegratorState s
   while (stack_index < volume_stack_size - 1 && enclosed_index < MAX_VOLUME_STACK_SIZE - 1 &&
          step < 2 * volume_stack_size) {
     Intersection isect;
+    PROFILING_COUNT(kg, PROFILING_COUNTER_VOLUME_STACK_RAYS, 1);
     if (!scene_intersect_volume(kg, &volume_ray, &isect, visibility)) {
       break;
     }
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "kernel/film/accumulate.h"
+#include "kernel/integrator/guiding.h"
 #include "kernel/integrator/shader_eval.h"
 #include "kernel/light/light.h"
 #include "kernel/light/sample.h"
@@ -67,6 +68,15 @@ ccl_device float3 integrator_eval_background_shader(KernelGlobals kg,
     L = shader_background_eval(emission_sd);
   }
 
+#  ifdef __PATH_GUIDING__
+  {
+    const float3 ray_D = INTEGRATOR_STATE(state, ray, D);
+    const float3 ray_P = INTEGRATOR_STATE(state, ray, P) -
+                         ray_D * INTEGRATOR_STATE(state, path, mis_ray_t);
+    guiding_record_radiance(kg, state, ray_P, ray_D, L);
+  }
+#  endif
+
   /* Background MIS weights. */
 #  ifdef __BACKGROUND_MIS__
   /* Check if background light exists or if we should skip pdf. */
@@ -134,9 +144,12 @@ ccl_device_inline void integrate_distant_lights(KernelGlobals kg,
 {
   const float3 ray_D = INTEGRATOR_STATE(state, ray, D);
   const float ray_time = INTEGRATOR_STATE(state, ray, time);
+  /* Position where the BSDF was sampled, for correct MIS PDF. */
+  const float3 ray_P = INTEGRATOR_STATE(state, ray, P) -
+                       ray_D * INTEGRATOR_STATE(state, path, mis_ray_t);
   LightSample ls ccl_optional_struct_init;
   for (int lamp = 0; lamp < kernel_data.integrator.num_all_lights; lamp++) {
-    if (light_sample_from_distant_ray(kg, ray_D, lamp, &ls)) {
+    if (light_sample_from_distant_ray(kg, ray_P, ray_D, lamp, &ls)) {
       /* Use visibility flag to skip lights. */
 #ifdef __PASSES__
       const uint32_t path_flag = INTEGRATOR_STATE(state, path, flag);
@@ -162,6 +175,10 @@ ccl_device_inline void integrate_distant_lights(KernelGlobals kg,
         return;
       }
 
+#ifdef __PATH_GUIDING__
+      guiding_record_radiance(kg, state, ray_P, ray_D, light_eval);
+#endif
+
       /* MIS weighting. */
       if (!(path_flag & PATH_RAY_MIS_SKIP)) {
         /* multiple importance sampling, get regular light pdf,
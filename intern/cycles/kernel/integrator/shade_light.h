@@ -17,6 +17,7 @@
 #pragma once
 
 #include "kernel/film/accumulate.h"
+#include "kernel/integrator/guiding.h"
 #include "kernel/integrator/shader_eval.h"
 #include "kernel/light/light.h"
 #include "kernel/light/sample.h"
@@ -79,6 +80,10 @@ ccl_device_inline void integrate_light(KernelGlobals kg,
     return;
   }
 
+#ifdef __PATH_GUIDING__
+  guiding_record_radiance(kg, state, ray_P, ray_D, light_eval);
+#endif
+
   /* MIS weighting. */
   if (!(path_flag & PATH_RAY_MIS_SKIP)) {
     /* multiple importance sampling, get regular light pdf,
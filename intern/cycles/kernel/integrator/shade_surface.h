@@ -19,6 +19,7 @@
 #include "kernel/film/accumulate.h"
 #include "kernel/film/passes.h"
 
+#include "kernel/integrator/guiding.h"
 #include "kernel/integrator/path_state.h"
 #include "kernel/integrator/shader_eval.h"
 #include "kernel/integrator/subsurface.h"
@@ -80,6 +81,15 @@ ccl_device_forceinline void integrate_surface_emission(KernelGlobals kg,
   /* Evaluate emissive closure. */
   float3 L = shader_emissive_eval(sd);
 
+#  ifdef __PATH_GUIDING__
+  {
+    const float3 ray_P = INTEGRATOR_STATE(state, ray, P);
+    const float3 ray_D = INTEGRATOR_STATE(state, ray, D);
+    const float mis_ray_t = INTEGRATOR_STATE(state, path, mis_ray_t);
+    guiding_record_radiance(kg, state, ray_P - ray_D * mis_ray_t, ray_D, L);
+  }
+#  endif
+
 #  ifdef __HAIR__
   if (!(path_flag & PATH_RAY_MIS_SKIP) && (sd->flag & SD_USE_MIS) &&
       (sd->type & PRIMITIVE_ALL_TRIANGLE))
@@ -148,9 +158,14 @@ ccl_device_forceinline void integrate_surface_direct_light(KernelGlobals kg,
   const bool is_transmission = shader_bsdf_is_transmission(sd, ls.D);
 
   BsdfEval bsdf_eval ccl_optional_struct_init;
-  const float bsdf_pdf = shader_bsdf_eval(kg, sd, ls.D, is_transmission, &bsdf_eval, ls.shader);
+  float bsdf_pdf = shader_bsdf_eval(kg, sd, ls.D, is_transmission, &bsdf_eval, ls.shader);
   bsdf_eval_mul3(&bsdf_eval, light_eval / ls.pdf);
 
+#  ifdef __PATH_GUIDING__
+  /* Forward MIS must use the same mixture PDF that the bounce would sample with. */
+  bsdf_pdf = guiding_surface_mix_pdf(kg, guiding_surface_cell(kg, sd), ls.D, bsdf_pdf, 0);
+#  endif
+
   if (ls.shader & SHADER_USE_MIS) {
     const float mis_weight = light_sample_mis_weight_nee(kg, ls.pdf, bsdf_pdf);
     bsdf_eval_mul(&bsdf_eval, mis_weight);
@@ -242,24 +257,54 @@ ccl_device_forceinline int integrate_surface_bsdf_bssrdf_bounce(
 
   float bsdf_u, bsdf_v;
   path_state_rng_2D(kg, rng_state, PRNG_BSDF_U, &bsdf_u, &bsdf_v);
-  ccl_private const ShaderClosure *sc = shader_bsdf_bssrdf_pick(sd, &bsdf_u);
 
-#ifdef __SUBSURFACE__
-  /* BSSRDF closure, we schedule subsurface intersection kernel. */
-  if (CLOSURE_IS_BSSRDF(sc->type)) {
-    return subsurface_bounce(kg, state, sd, sc);
-  }
-#endif
-
-  /* BSDF closure, sample direction. */
   float bsdf_pdf;
   BsdfEval bsdf_eval ccl_optional_struct_init;
   float3 bsdf_omega_in ccl_optional_struct_init;
   differential3 bsdf_domega_in ccl_optional_struct_init;
   int label;
 
-  label = shader_bsdf_sample_closure(
-      kg, sd, sc, bsdf_u, bsdf_v, &bsdf_eval, &bsdf_omega_in, &bsdf_domega_in, &bsdf_pdf);
+#ifdef __PATH_GUIDING__
+  /* Pick between sampling the guiding field and the BSDF, rescaling the random number to
+   * reuse it for the direction sample. */
+  const int guiding_cell = guiding_surface_cell(kg, sd);
+  const float guiding_probability = guiding_surface_probability(kg, guiding_cell);
+
+  if (bsdf_u < guiding_probability) {
+    bsdf_u /= guiding_probability;
+    label = guiding_surface_sample(kg,
+                                   sd,
+                                   guiding_cell,
+                                   bsdf_u,
+                                   bsdf_v,
+                                   &bsdf_eval,
+                                   &bsdf_omega_in,
+                                   &bsdf_domega_in,
+                                   &bsdf_pdf);
+  }
+  else
+#endif
+  {
+#ifdef __PATH_GUIDING__
+    bsdf_u = (bsdf_u - guiding_probability) / (1.0f - guiding_probability);
+#endif
+    ccl_private const ShaderClosure *sc = shader_bsdf_bssrdf_pick(sd, &bsdf_u);
+
+#ifdef __SUBSURFACE__
+    /* BSSRDF closure, we schedule subsurface intersection kernel. */
+    if (CLOSURE_IS_BSSRDF(sc->type)) {
+      return subsurface_bounce(kg, state, sd, sc);
+    }
+#endif
+
+    /* BSDF closure, sample direction. */
+    label = shader_bsdf_sample_closure(
+        kg, sd, sc, bsdf_u, bsdf_v, &bsdf_eval, &bsdf_omega_in, &bsdf_domega_in, &bsdf_pdf);
+
+#ifdef __PATH_GUIDING__
+    bsdf_pdf = guiding_surface_mix_pdf(kg, guiding_cell, bsdf_omega_in, bsdf_pdf, label);
+#endif
+  }
 
   if (bsdf_pdf == 0.0f || bsdf_eval_is_zero(&bsdf_eval)) {
     return LABEL_NONE;
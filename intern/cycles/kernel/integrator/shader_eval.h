@@ -647,6 +647,19 @@ ccl_device void shader_eval_surface(KernelGlobals kg,
 #endif
   {
 #ifdef __SVM__
+#  ifdef __KERNEL_CPU__
+    /* Most shaders only use basic nodes, evaluate those with an interpreter specialized for
+     * them. It is smaller and faster since code for all other nodes is compiled out. */
+    if constexpr ((node_feature_mask & ~KERNEL_FEATURE_NODE_MASK_SURFACE_BASIC) != 0U) {
+      const uint shader_features =
+          kernel_tex_fetch(__shaders, (sd->shader & SHADER_MASK)).kernel_features;
+      if ((shader_features & node_feature_mask & ~KERNEL_FEATURE_NODE_MASK_SURFACE_BASIC) == 0U) {
+        svm_eval_nodes<node_feature_mask & KERNEL_FEATURE_NODE_MASK_SURFACE_BASIC,
+                       SHADER_TYPE_SURFACE>(kg, state, sd, buffer, path_flag);
+        return;
+      }
+    }
+#  endif
     svm_eval_nodes<node_feature_mask, SHADER_TYPE_SURFACE>(kg, state, sd, buffer, path_flag);
 #else
     if (sd->object == OBJECT_NONE) {
@@ -110,7 +110,7 @@ CCL_NAMESPACE_BEGIN
 #  define INTEGRATOR_PATH_INIT_SORTED(next_kernel, key) \
     { \
       INTEGRATOR_STATE_WRITE(state, path, queued_kernel) = next_kernel; \
-      (void)key; \
+      INTEGRATOR_STATE_WRITE(state, path, shader_sort_key) = key; \
     }
 #  define INTEGRATOR_PATH_NEXT(current_kernel, next_kernel) \
     { \
@@ -125,7 +125,7 @@ CCL_NAMESPACE_BEGIN
 #  define INTEGRATOR_PATH_NEXT_SORTED(current_kernel, next_kernel, key) \
     { \
       INTEGRATOR_STATE_WRITE(state, path, queued_kernel) = next_kernel; \
-      (void)key; \
+      INTEGRATOR_STATE_WRITE(state, path, shader_sort_key) = key; \
       (void)current_kernel; \
     }
 
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "kernel/light/common.h"
+#include "kernel/light/tree.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -429,7 +430,8 @@ ccl_device float background_light_pdf(KernelGlobals kg, float3 P, float3 directi
   float pdf_fac = (portal_method_pdf + sun_method_pdf + map_method_pdf);
   if (pdf_fac == 0.0f) {
     /* Use uniform as a fallback if we can't use any strategy. */
-    return kernel_data.integrator.pdf_lights / M_4PI_F;
+    return kernel_data.integrator.pdf_lights * light_tree_background_pdf_correction(kg, P) /
+           M_4PI_F;
   }
 
   pdf_fac = 1.0f / pdf_fac;
@@ -445,7 +447,7 @@ ccl_device float background_light_pdf(KernelGlobals kg, float3 P, float3 directi
     pdf += background_map_pdf(kg, direction) * map_method_pdf;
   }
 
-  return pdf * kernel_data.integrator.pdf_lights;
+  return pdf * kernel_data.integrator.pdf_lights * light_tree_background_pdf_correction(kg, P);
 }
 
 #endif
@@ -31,6 +31,7 @@ typedef struct LightSample {
   float t;        /* distance to light (FLT_MAX for distant light) */
   float u, v;     /* parametric coordinate on primitive */
   float pdf;      /* light sampling probability density function */
+  float pdf_tree; /* light tree correction of the light selection pdf, included in pdf */
   float eval_fac; /* intensity multiplier */
   int object;     /* object id for triangle/curve lights */
   int prim;       /* primitive id for triangle/curve lights */
@@ -344,6 +345,7 @@ ccl_device bool lights_intersect(KernelGlobals kg,
 }
 
 ccl_device bool light_sample_from_distant_ray(KernelGlobals kg,
+                                              const float3 ray_P,
                                               const float3 ray_D,
                                               const int lamp,
                                               ccl_private LightSample *ccl_restrict ls)
@@ -402,7 +404,7 @@ ccl_device bool light_sample_from_distant_ray(KernelGlobals kg,
   float invarea = klight->distant.invarea;
   ls->pdf = invarea / (costheta * costheta * costheta);
   ls->eval_fac = ls->pdf;
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= kernel_data.integrator.pdf_lights * light_tree_lamp_pdf_correction(kg, ray_P, lamp);
 
   return true;
 }
@@ -516,7 +518,7 @@ ccl_device bool light_sample_from_intersection(KernelGlobals kg,
     return false;
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= kernel_data.integrator.pdf_lights * light_tree_lamp_pdf_correction(kg, ray_P, lamp);
 
   return true;
 }
@@ -575,6 +577,12 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals kg,
    * and simple area sampling, comparing the distance to the triangle plane
    * to the length of the edges of the triangle. */
 
+  const float pdf_correction = light_tree_triangle_pdf_correction(
+      kg, sd->P + sd->I * t, sd->object, sd->prim);
+  if (pdf_correction == 0.0f) {
+    return 0.0f;
+  }
+
   float3 V[3];
   bool has_motion = triangle_world_space_vertices(kg, sd->object, sd->prim, sd->time, V);
 
@@ -617,7 +625,7 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals kg,
         area = 0.5f * len(N);
       }
       const float pdf = area * kernel_data.integrator.pdf_triangles;
-      return pdf / solid_angle;
+      return pdf * pdf_correction / solid_angle;
     }
   }
   else {
@@ -634,7 +642,7 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals kg,
       const float area_pre = triangle_area(V[0], V[1], V[2]);
       pdf = pdf * area_pre / area;
     }
-    return pdf;
+    return pdf * pdf_correction;
   }
 }
 
@@ -849,8 +857,27 @@ ccl_device_noinline bool light_distribution_sample(KernelGlobals kg,
                                                    const uint32_t path_flag,
                                                    ccl_private LightSample *ls)
 {
-  /* Sample light index from distribution. */
-  const int index = light_distribution_sample(kg, &randu);
+  /* Sample light index from light tree or distribution. The light tree replaces the distribution
+   * probability in the PDF of the light sample by its own. */
+  int index;
+  float pdf_correction = 1.0f;
+
+  if (kernel_data.integrator.use_light_tree) {
+    float tree_pdf;
+    const int emitter_index = light_tree_sample(kg, P, &randu, &tree_pdf);
+    if (emitter_index == -1) {
+      return false;
+    }
+
+    ccl_global const KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                          emitter_index);
+    index = kemitter->distribution_index;
+    pdf_correction = tree_pdf / kemitter->distribution_pdf;
+  }
+  else {
+    index = light_distribution_sample(kg, &randu);
+  }
+
   ccl_global const KernelLightDistribution *kdistribution = &kernel_tex_fetch(__light_distribution,
                                                                               index);
   const int prim = kdistribution->prim;
@@ -868,6 +895,8 @@ ccl_device_noinline bool light_distribution_sample(KernelGlobals kg,
     const int shader_flag = kdistribution->mesh_light.shader_flag;
     triangle_light_sample<in_volume_segment>(kg, prim, object, randu, randv, time, ls, P);
     ls->shader |= shader_flag;
+    ls->pdf *= pdf_correction;
+    ls->pdf_tree = pdf_correction;
     return (ls->pdf > 0.0f);
   }
 
@@ -877,7 +906,13 @@ ccl_device_noinline bool light_distribution_sample(KernelGlobals kg,
     return false;
   }
 
-  return light_sample<in_volume_segment>(kg, lamp, randu, randv, P, path_flag, ls);
+  if (!light_sample<in_volume_segment>(kg, lamp, randu, randv, P, path_flag, ls)) {
+    return false;
+  }
+
+  ls->pdf *= pdf_correction;
+  ls->pdf_tree = pdf_correction;
+  return true;
 }
 
 ccl_device_inline bool light_distribution_sample_from_volume_segment(KernelGlobals kg,
@@ -911,14 +946,20 @@ ccl_device_inline bool light_distribution_sample_new_position(KernelGlobals kg,
                                                               const float3 P,
                                                               ccl_private LightSample *ls)
 {
-  /* Sample a new position on the same light, for volume sampling. */
+  /* Sample a new position on the same light, for volume sampling. The light was selected at the
+   * original position, so the light tree selection pdf from there still applies. */
+  const float pdf_tree = ls->pdf_tree;
+
   if (ls->type == LIGHT_TRIANGLE) {
     triangle_light_sample<false>(kg, ls->prim, ls->object, randu, randv, time, ls, P);
-    return (ls->pdf > 0.0f);
   }
-  else {
-    return light_sample<false>(kg, ls->lamp, randu, randv, P, 0, ls);
+  else if (!light_sample<false>(kg, ls->lamp, randu, randv, P, 0, ls)) {
+    return false;
   }
+
+  ls->pdf *= pdf_tree;
+  ls->pdf_tree = pdf_tree;
+  return (ls->pdf > 0.0f);
 }
 
 CCL_NAMESPACE_END
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Light Tree
+ *
+ * Selects lights proportional to an estimate of their contribution to the shading point, by
+ * traversing a tree with bounds of the position, orientation and energy of the lights below each
+ * node. See "Importance Sampling of Many Lights with Adaptive Tree Splitting" by Conty and Kulla.
+ *
+ * Distant and background lights have no position and are selected by energy only, with a
+ * probability that depends on the importance of the whole tree.
+ *
+ * The tree only replaces the selection of the light distribution. The light sampling functions
+ * still compute the PDF with the probability of the light distribution, which is replaced by the
+ * probability of the light tree through the correction factors below. */
+
+#pragma once
+
+CCL_NAMESPACE_BEGIN
+
+/* Estimate of the contribution of a cluster of emitters to the shading point. The receiver
+ * orientation is left out, so the result only depends on the position. */
+ccl_device float light_tree_importance(const float3 P,
+                                       const float3 centroid,
+                                       const float radius,
+                                       const float3 axis,
+                                       const float theta_o,
+                                       const float theta_e,
+                                       const float energy)
+{
+  const float3 centroid_to_P = P - centroid;
+  const float dist_squared = len_squared(centroid_to_P);
+  const float radius_squared = radius * radius;
+
+  /* Inside the bounds any direction is possible. */
+  float theta_prime = 0.0f;
+  if (dist_squared > radius_squared) {
+    const float dist = sqrtf(dist_squared);
+    const float theta = safe_acosf(dot(axis, centroid_to_P) / dist);
+    const float theta_u = safe_asinf(radius / dist);
+    theta_prime = fmaxf(theta - theta_o - theta_u, 0.0f);
+  }
+
+  if (theta_prime >= theta_e) {
+    return 0.0f;
+  }
+
+  return energy * cosf(theta_prime) / fmaxf(fmaxf(dist_squared, radius_squared), 1e-8f);
+}
+
+ccl_device float light_tree_node_importance(KernelGlobals kg, const float3 P, const int index)
+{
+  ccl_global const KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, index);
+  const float3 bbox_min = make_float3(knode->bbox_min[0], knode->bbox_min[1], knode->bbox_min[2]);
+  const float3 bbox_max = make_float3(knode->bbox_max[0], knode->bbox_max[1], knode->bbox_max[2]);
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+
+  return light_tree_importance(P,
+                               0.5f * (bbox_min + bbox_max),
+                               0.5f * len(bbox_max - bbox_min),
+                               axis,
+                               knode->theta_o,
+                               knode->theta_e,
+                               knode->energy);
+}
+
+ccl_device float light_tree_emitter_importance(KernelGlobals kg, const float3 P, const int index)
+{
+  ccl_global const KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                        index);
+  const float3 centroid = make_float3(
+      kemitter->centroid[0], kemitter->centroid[1], kemitter->centroid[2]);
+  const float3 axis = make_float3(kemitter->axis[0], kemitter->axis[1], kemitter->axis[2]);
+
+  return light_tree_importance(
+      P, centroid, kemitter->radius, axis, kemitter->theta_o, kemitter->theta_e, kemitter->energy);
+}
+
+/* Probability of selecting one of the distant lights instead of traversing the tree. */
+ccl_device float light_tree_distant_probability(KernelGlobals kg, const float3 P)
+{
+  if (kernel_data.integrator.num_light_tree_distant == 0) {
+    return 0.0f;
+  }
+  if (kernel_data.integrator.num_light_tree_emitters == 0) {
+    return 1.0f;
+  }
+
+  const float distant_energy = kernel_data.integrator.light_tree_distant_energy;
+  return distant_energy / (distant_energy + light_tree_node_importance(kg, P, 0));
+}
+
+/* Select between two options with the given probability of the first, and rescale the random
+ * number so it can be used again. */
+ccl_device_inline bool light_tree_select_first(ccl_private float *randu, const float probability)
+{
+  if (*randu < probability) {
+    *randu = *randu / probability;
+    return true;
+  }
+
+  *randu = fminf((*randu - probability) / (1.0f - probability), 1.0f - FLT_EPSILON);
+  return false;
+}
+
+/* Select an emitter, returns its index or -1 if no emitter contributes to the shading point. */
+ccl_device int light_tree_sample(KernelGlobals kg,
+                                 const float3 P,
+                                 ccl_private float *randu,
+                                 ccl_private float *pdf)
+{
+  const int num_emitters = kernel_data.integrator.num_light_tree_emitters;
+
+  const float p_distant = light_tree_distant_probability(kg, P);
+  if (light_tree_select_first(randu, p_distant)) {
+    /* Distant lights, by energy. Only lights with energy are in the tree. */
+    const int num_distant = kernel_data.integrator.num_light_tree_distant;
+    const float distant_energy = kernel_data.integrator.light_tree_distant_energy;
+    float r = *randu * distant_energy;
+
+    for (int i = 0; i < num_distant; i++) {
+      const int index = num_emitters + i;
+      const float energy = kernel_tex_fetch(__light_tree_emitters, index).energy;
+      if (r < energy || i == num_distant - 1) {
+        *randu = fminf(r / energy, 1.0f - FLT_EPSILON);
+        *pdf = p_distant * energy / distant_energy;
+        return index;
+      }
+      r -= energy;
+    }
+
+    return -1;
+  }
+
+  float selection_pdf = 1.0f - p_distant;
+
+  /* Traverse inner nodes. */
+  int node_index = 0;
+  ccl_global const KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, 0);
+
+  while (knode->num_emitters == 0) {
+    const int left_index = node_index + 1;
+    const int right_index = knode->child_index;
+    const float left_importance = light_tree_node_importance(kg, P, left_index);
+    const float right_importance = light_tree_node_importance(kg, P, right_index);
+    const float total_importance = left_importance + right_importance;
+
+    if (total_importance == 0.0f) {
+      return -1;
+    }
+
+    const float p_left = left_importance / total_importance;
+    if (light_tree_select_first(randu, p_left)) {
+      node_index = left_index;
+      selection_pdf *= p_left;
+    }
+    else {
+      node_index = right_index;
+      selection_pdf *= 1.0f - p_left;
+    }
+
+    knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+  }
+
+  /* Select emitter in leaf. */
+  const int first_emitter = knode->child_index;
+  const int num_leaf_emitters = knode->num_emitters;
+
+  float importance[LIGHT_TREE_MAX_LEAF_SIZE];
+  float total_importance = 0.0f;
+  int last_emitter = -1;
+
+  for (int i = 0; i < num_leaf_emitters; i++) {
+    importance[i] = light_tree_emitter_importance(kg, P, first_emitter + i);
+    total_importance += importance[i];
+    if (importance[i] > 0.0f) {
+      last_emitter = i;
+    }
+  }
+
+  if (last_emitter == -1) {
+    return -1;
+  }
+
+  float r = *randu * total_importance;
+  for (int i = 0; i <= last_emitter; i++) {
+    if (importance[i] == 0.0f) {
+      continue;
+    }
+    if (r < importance[i] || i == last_emitter) {
+      *randu = fminf(r / importance[i], 1.0f - FLT_EPSILON);
+      *pdf = selection_pdf * importance[i] / total_importance;
+      return first_emitter + i;
+    }
+    r -= importance[i];
+  }
+
+  return -1;
+}
+
+/* Probability of selecting the emitter from the shading point. */
+ccl_device float light_tree_pdf(KernelGlobals kg, const float3 P, const int emitter_index)
+{
+  const int num_emitters = kernel_data.integrator.num_light_tree_emitters;
+  const float p_distant = light_tree_distant_probability(kg, P);
+
+  ccl_global const KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                        emitter_index);
+
+  if (emitter_index >= num_emitters) {
+    return p_distant * kemitter->energy / kernel_data.integrator.light_tree_distant_energy;
+  }
+
+  /* Selection in leaf. */
+  int node_index = kemitter->leaf_index;
+  ccl_global const KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes,
+                                                                  node_index);
+
+  float total_importance = 0.0f;
+  for (int i = 0; i < knode->num_emitters; i++) {
+    total_importance += light_tree_emitter_importance(kg, P, knode->child_index + i);
+  }
+
+  if (total_importance == 0.0f) {
+    return 0.0f;
+  }
+
+  float pdf = (1.0f - p_distant) * light_tree_emitter_importance(kg, P, emitter_index) /
+              total_importance;
+
+  /* Selection in inner nodes, from the leaf up to the root. */
+  while (knode->parent_index != -1 && pdf > 0.0f) {
+    const int parent_index = knode->parent_index;
+    knode = &kernel_tex_fetch(__light_tree_nodes, parent_index);
+
+    const int left_index = parent_index + 1;
+    const int right_index = knode->child_index;
+    const float left_importance = light_tree_node_importance(kg, P, left_index);
+    const float right_importance = light_tree_node_importance(kg, P, right_index);
+    const float node_importance = left_importance + right_importance;
+
+    if (node_importance == 0.0f) {
+      return 0.0f;
+    }
+
+    pdf *= ((node_index == left_index) ? left_importance : right_importance) / node_importance;
+    node_index = parent_index;
+  }
+
+  return pdf;
+}
+
+/* Factor to replace the light distribution probability in the PDF of a light sample by the light
+ * tree probability. Emitters which the tree never selects have no index. */
+ccl_device float light_tree_pdf_correction(KernelGlobals kg,
+                                           const float3 P,
+                                           const int emitter_index)
+{
+  if (emitter_index == -1) {
+    return 0.0f;
+  }
+
+  const float distribution_pdf = kernel_tex_fetch(__light_tree_emitters, emitter_index)
+                                     .distribution_pdf;
+  return light_tree_pdf(kg, P, emitter_index) / distribution_pdf;
+}
+
+ccl_device float light_tree_lamp_pdf_correction(KernelGlobals kg, const float3 P, const int lamp)
+{
+  if (!kernel_data.integrator.use_light_tree) {
+    return 1.0f;
+  }
+
+  return light_tree_pdf_correction(kg, P, kernel_tex_fetch(__light_tree_emitter_index, lamp));
+}
+
+ccl_device float light_tree_background_pdf_correction(KernelGlobals kg, const float3 P)
+{
+  if (!kernel_data.integrator.use_light_tree) {
+    return 1.0f;
+  }
+
+  return light_tree_pdf_correction(kg, P, kernel_data.integrator.light_tree_background_emitter);
+}
+
+ccl_device float light_tree_triangle_pdf_correction(KernelGlobals kg,
+                                                    const float3 P,
+                                                    const int object,
+                                                    const int prim)
+{
+  if (!kernel_data.integrator.use_light_tree) {
+    return 1.0f;
+  }
+
+  /* Objects map to a table of emitters for the triangles of their mesh, and the offset of the
+   * first triangle of the mesh. */
+  const int object_entry = kernel_data.integrator.num_all_lights + 2 * object;
+  const int table_offset = kernel_tex_fetch(__light_tree_emitter_index, object_entry);
+  if (table_offset == -1) {
+    return 0.0f;
+  }
+
+  const int prim_offset = kernel_tex_fetch(__light_tree_emitter_index, object_entry + 1);
+  return light_tree_pdf_correction(
+      kg, P, kernel_tex_fetch(__light_tree_emitter_index, table_offset + prim - prim_offset));
+}
+
+CCL_NAMESPACE_END
@@ -30,6 +30,7 @@ KERNEL_TEX(float2, __prim_time)
 
 /* objects */
 KERNEL_TEX(KernelObject, __objects)
+KERNEL_TEX(KernelObjectPrototype, __object_prototypes)
 KERNEL_TEX(Transform, __object_motion_pass)
 KERNEL_TEX(DecomposedTransform, __object_motion)
 KERNEL_TEX(uint, __object_flag)
@@ -46,6 +47,9 @@ KERNEL_TEX(uint4, __tri_vindex)
 KERNEL_TEX(uint, __tri_patch)
 KERNEL_TEX(float2, __tri_patch_uv)
 KERNEL_TEX(packed_float3, __tri_verts)
+KERNEL_TEX(uint2, __tri_verts_compact)
+KERNEL_TEX(packed_float3, __tri_verts_compact_bounds)
+KERNEL_TEX(uint, __tri_vnormal_compact)
 
 /* curves */
 KERNEL_TEX(KernelCurve, __curves)
@@ -66,6 +70,9 @@ KERNEL_TEX(uchar4, __attributes_uchar4)
 /* lights */
 KERNEL_TEX(KernelLightDistribution, __light_distribution)
 KERNEL_TEX(KernelLight, __lights)
+KERNEL_TEX(KernelLightTreeNode, __light_tree_nodes)
+KERNEL_TEX(KernelLightTreeEmitter, __light_tree_emitters)
+KERNEL_TEX(int, __light_tree_emitter_index)
 KERNEL_TEX(float2, __light_background_marginal_cdf)
 KERNEL_TEX(float2, __light_background_conditional_cdf)
 
@@ -82,6 +89,10 @@ KERNEL_TEX(float, __lookup_table)
 /* sobol */
 KERNEL_TEX(float, __sample_pattern_lut)
 
+/* path guiding */
+KERNEL_TEX(float, __guiding_field)
+KERNEL_TEX(float, __guiding_training)
+
 /* image textures */
 KERNEL_TEX(TextureInfo, __texture_info)
 
@@ -51,6 +51,16 @@ CCL_NAMESPACE_BEGIN
 
 #define VOLUME_BOUNDS_MAX 1024
 
+/* Path guiding: uniform spatial grid over the scene bounds, each cell storing a directional
+ * histogram with equal area bins in (cos(theta), phi). */
+#define GUIDING_GRID_RESOLUTION 16
+#define GUIDING_GRID_CELLS \
+  (GUIDING_GRID_RESOLUTION * GUIDING_GRID_RESOLUTION * GUIDING_GRID_RESOLUTION)
+#define GUIDING_THETA_BINS 8
+#define GUIDING_PHI_BINS 16
+#define GUIDING_BINS (GUIDING_THETA_BINS * GUIDING_PHI_BINS)
+#define GUIDING_CELL_NONE (~0)
+
 #define BECKMANN_TABLE_SIZE 256
 
 #define SHADER_NONE (~0)
@@ -63,6 +73,9 @@ CCL_NAMESPACE_BEGIN
 #define INTEGRATOR_SHADOW_ISECT_SIZE_CPU 1024U
 #define INTEGRATOR_SHADOW_ISECT_SIZE_GPU 4U
 
+/* Number of paths whose camera rays are intersected together on the CPU. */
+#define INTEGRATOR_PACKET_SIZE_CPU 4
+
 #ifdef __KERNEL_CPU__
 #  define INTEGRATOR_SHADOW_ISECT_SIZE INTEGRATOR_SHADOW_ISECT_SIZE_CPU
 #else
@@ -108,6 +121,10 @@ CCL_NAMESPACE_BEGIN
 #    define __OSL__
 #  endif
 #  define __VOLUME_RECORD_ALL__
+#  define __PATH_GUIDING__
+#  ifdef __KERNEL_SSE2__
+#    define __BVH_PACKET__
+#  endif
 #endif /* __KERNEL_CPU__ */
 
 #ifdef __KERNEL_GPU_RAYTRACING__
@@ -1210,8 +1227,21 @@ typedef struct KernelIntegrator {
   /* MIS debugging. */
   int direct_light_sampling_type;
 
+  /* Light tree. */
+  int use_light_tree;
+  int num_light_tree_emitters;
+  int num_light_tree_distant;
+  float light_tree_distant_energy;
+  int light_tree_background_emitter;
+
+  /* Path guiding. */
+  int use_guiding;
+  float guiding_probability;
+  float guiding_bounds_min[3];
+  float guiding_bounds_inv_size[3];
+
   /* padding */
-  int pad1, pad2;
+  int pad1;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1240,6 +1270,8 @@ typedef struct KernelBVH {
   int bvh_layout;
   int use_bvh_steps;
   int curve_subdivisions;
+  int use_compact_mesh;
+  int pad3, pad4, pad5;
 
   /* Custom BVH */
 #ifdef __KERNEL_OPTIX__
@@ -1292,26 +1324,39 @@ static_assert_align(KernelData, 16);
 /* Kernel data structures. */
 
 typedef struct KernelObject {
+  /* The inverse transform is not stored, it is computed from this on demand. */
   Transform tfm;
-  Transform itfm;
 
-  float volume_density;
-  float pass_id;
   float random_number;
-  float color[3];
   int particle_index;
 
   float dupli_generated[3];
   float dupli_uv[2];
 
-  int numkeys;
-  int numsteps;
-  int numverts;
-
   uint patch_map_offset;
   uint attribute_map_offset;
   uint motion_offset;
 
+  uint visibility;
+  int primitive_type;
+
+  /* Index of the data shared with other objects, in the object prototypes array. */
+  int prototype;
+  int pad1, pad2, pad3;
+} KernelObject;
+static_assert_align(KernelObject, 16);
+
+/* Object data which is usually the same for all instances of a geometry, stored once and shared
+ * by all objects with identical values, to reduce memory usage in scenes with many instances. */
+typedef struct KernelObjectPrototype {
+  float volume_density;
+  float pass_id;
+  float color[3];
+
+  int numkeys;
+  int numsteps;
+  int numverts;
+
   float cryptomatte_object;
   float cryptomatte_asset;
 
@@ -1319,11 +1364,9 @@ typedef struct KernelObject {
   float shadow_terminator_geometry_offset;
 
   float ao_distance;
-
-  uint visibility;
-  int primitive_type;
-} KernelObject;
-static_assert_align(KernelObject, 16);
+  int pad1, pad2, pad3;
+} KernelObjectPrototype;
+static_assert_align(KernelObjectPrototype, 16);
 
 typedef struct KernelCurve {
   int shader_id;
@@ -1400,6 +1443,50 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Maximum number of emitters in a leaf of the light tree, between which the kernel selects by
+ * importance without further traversal. */
+#define LIGHT_TREE_MAX_LEAF_SIZE 4
+
+/* Light tree node, with bounds of the position, orientation and energy of all emitters below
+ * it. The left child of an inner node directly follows it, leaf nodes reference a range of
+ * emitters. */
+typedef struct KernelLightTreeNode {
+  float bbox_min[3];
+  float energy;
+  float bbox_max[3];
+  float theta_o;
+  float axis[3];
+  float theta_e;
+
+  /* Right child for inner nodes, first emitter for leaf nodes. */
+  int child_index;
+  /* Number of emitters in leaf nodes, zero for inner nodes. */
+  int num_emitters;
+  int parent_index;
+  int pad;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
+/* Light tree emitter, referencing an entry of the light distribution. Emitters of the tree are
+ * followed by the distant and background lights, which are selected by energy only. */
+typedef struct KernelLightTreeEmitter {
+  float centroid[3];
+  float energy;
+  float axis[3];
+  float theta_o;
+  float radius;
+  float theta_e;
+
+  /* Probability of selecting the light in the light distribution, which the light sampling
+   * functions include in their PDF and the light tree replaces by its own. */
+  float distribution_pdf;
+  int distribution_index;
+
+  int leaf_index;
+  int pad1, pad2, pad3;
+} KernelLightTreeEmitter;
+static_assert_align(KernelLightTreeEmitter, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
@@ -1419,7 +1506,9 @@ typedef struct KernelShader {
   float cryptomatte_id;
   int flags;
   int pass_id;
-  int pad2, pad3;
+  /* KERNEL_FEATURE_* used by the shader, to select specialized evaluation. */
+  int kernel_features;
+  int pad3;
 } KernelShader;
 static_assert_align(KernelShader, 16);
 
@@ -1433,6 +1522,14 @@ static_assert_align(KernelShader, 16);
 #define PATCH_MAP_NODE_IS_LEAF (1u << 31)
 #define PATCH_MAP_NODE_INDEX_MASK (~(PATCH_MAP_NODE_IS_SET | PATCH_MAP_NODE_IS_LEAF))
 
+/* Compact mesh storage
+ *
+ * Vertex positions are quantized to 21 bits per component relative to the mesh bounds, and
+ * packed into an uint2. Vertex normals are octahedral encoded with 16 bits per component. */
+
+#define TRIANGLE_COMPACT_BITS 21
+#define TRIANGLE_COMPACT_MASK ((1u << TRIANGLE_COMPACT_BITS) - 1)
+
 /* Work Tiles */
 
 typedef struct KernelWorkTile {
@@ -1625,6 +1722,13 @@ enum KernelFeatureFlag : unsigned int {
   (KERNEL_FEATURE_NODE_VORONOI_EXTRA | KERNEL_FEATURE_NODE_BUMP | KERNEL_FEATURE_NODE_BUMP_STATE)
 #define KERNEL_FEATURE_NODE_MASK_BUMP KERNEL_FEATURE_NODE_MASK_DISPLACEMENT
 
+/* Nodes used by most surface shaders, for evaluating them with code for bump, volume, hair,
+ * extra Voronoi and ray-tracing nodes compiled out. Light path and AOV are not reported by the
+ * shader nodes, so they are always included. */
+#define KERNEL_FEATURE_NODE_MASK_SURFACE_BASIC \
+  (KERNEL_FEATURE_NODE_BSDF | KERNEL_FEATURE_NODE_EMISSION | KERNEL_FEATURE_NODE_AOV | \
+   KERNEL_FEATURE_NODE_LIGHT_PATH)
+
 /* Must be constexpr on the CPU to avoid compile errors because the state types
  * are different depending on the main, shadow or null path. For GPU we don't have
  * C++17 everywhere so can't use it. */
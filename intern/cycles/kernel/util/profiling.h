@@ -30,11 +30,21 @@ CCL_NAMESPACE_BEGIN
     ProfilingWithShaderHelper profiling_helper((ProfilingState *)&kg->profiler, event)
 #  define PROFILING_SHADER(object, shader) \
     profiling_helper.set_shader(object, (shader)&SHADER_MASK);
+#  define PROFILING_COUNT(kg, counter, num) \
+    (((ProfilingState *)&kg->profiler)->counters[counter] += (num))
+#  define PROFILING_INIT_BVH(kg) \
+    ProfilingBVHHelper profiling_bvh_helper((ProfilingState *)&kg->profiler)
+#  define PROFILING_BVH_NODE() profiling_bvh_helper.count_node()
+#  define PROFILING_BVH_PRIMITIVES(num) profiling_bvh_helper.count_primitives(num)
 #else
 #  define PROFILING_INIT(kg, event)
 #  define PROFILING_EVENT(event)
 #  define PROFILING_INIT_FOR_SHADER(kg, event)
 #  define PROFILING_SHADER(object, shader)
+#  define PROFILING_COUNT(kg, counter, num) (void)(num)
+#  define PROFILING_INIT_BVH(kg)
+#  define PROFILING_BVH_NODE()
+#  define PROFILING_BVH_PRIMITIVES(num) (void)(num)
 #endif /* __KERNEL_CPU__ */
 
 CCL_NAMESPACE_END
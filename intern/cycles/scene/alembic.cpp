@@ -105,6 +105,8 @@ void CachedData::clear()
   }
 
   attributes.clear();
+
+  has_animation = false;
 }
 
 CachedData::CachedAttribute &CachedData::add_attribute(const ustring &name,
@@ -449,29 +451,44 @@ bool AlembicObject::has_data_loaded() const
   return data_loaded;
 }
 
-void AlembicObject::load_data_in_cache(CachedData &cached_data,
-                                       AlembicProcedural *proc,
-                                       IPolyMeshSchema &schema,
-                                       Progress &progress)
+AlembicObject::ReadParams AlembicObject::get_read_params(const AlembicProcedural *proc,
+                                                         const AlembicFrameRange &frame_range)
 {
-  /* Only load data for the original Geometry. */
-  if (instance_of) {
-    return;
-  }
-
-  cached_data.clear();
+  ReadParams params;
+  params.frame_range = frame_range;
+  params.requested_attributes = get_requested_attributes();
+  params.used_shaders = get_used_shaders();
+  params.ignore_subdivision = get_ignore_subdivision();
+  params.radius_scale = get_radius_scale();
+  params.default_radius = proc->get_default_radius();
+  return params;
+}
 
+template<typename SchemaType>
+static PolyMeshSchemaData make_poly_mesh_schema_data(SchemaType &schema,
+                                                     const array<Node *> &used_shaders)
+{
   PolyMeshSchemaData data;
   data.topology_variance = schema.getTopologyVariance();
   data.time_sampling = schema.getTimeSampling();
   data.positions = schema.getPositionsProperty();
   data.face_counts = schema.getFaceCountsProperty();
   data.face_indices = schema.getFaceIndicesProperty();
-  data.normals = schema.getNormalsParam();
   data.num_samples = schema.getNumSamples();
-  data.shader_face_sets = parse_face_sets_for_shader_assignment(schema, get_used_shaders());
+  data.velocities = schema.getVelocitiesProperty();
+  data.shader_face_sets = parse_face_sets_for_shader_assignment(schema, used_shaders);
+  return data;
+}
+
+static void load_poly_mesh_data_in_cache(CachedData &cached_data,
+                                         const AlembicObject::ReadParams &params,
+                                         IPolyMeshSchema &schema,
+                                         Progress &progress)
+{
+  PolyMeshSchemaData data = make_poly_mesh_schema_data(schema, params.used_shaders);
+  data.normals = schema.getNormalsParam();
 
-  read_geometry_data(proc, cached_data, data, progress);
+  read_geometry_data(params.frame_range, cached_data, data, progress);
 
   if (progress.get_cancel()) {
     return;
@@ -479,41 +496,23 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
 
   /* Use the schema as the base compound property to also be able to look for top level properties.
    */
-  read_attributes(
-      proc, cached_data, schema, schema.getUVsParam(), get_requested_attributes(), progress);
-
-  if (progress.get_cancel()) {
-    return;
-  }
-
-  cached_data.invalidate_last_loaded_time(true);
-  data_loaded = true;
+  read_attributes(params.frame_range,
+                  cached_data,
+                  schema,
+                  schema.getUVsParam(),
+                  params.requested_attributes,
+                  progress);
 }
 
-void AlembicObject::load_data_in_cache(CachedData &cached_data,
-                                       AlembicProcedural *proc,
-                                       ISubDSchema &schema,
-                                       Progress &progress)
+static void load_subd_data_in_cache(CachedData &cached_data,
+                                    const AlembicObject::ReadParams &params,
+                                    ISubDSchema &schema,
+                                    Progress &progress)
 {
-  /* Only load data for the original Geometry. */
-  if (instance_of) {
-    return;
-  }
+  if (params.ignore_subdivision) {
+    const PolyMeshSchemaData data = make_poly_mesh_schema_data(schema, params.used_shaders);
 
-  cached_data.clear();
-
-  if (this->get_ignore_subdivision()) {
-    PolyMeshSchemaData data;
-    data.topology_variance = schema.getTopologyVariance();
-    data.time_sampling = schema.getTimeSampling();
-    data.positions = schema.getPositionsProperty();
-    data.face_counts = schema.getFaceCountsProperty();
-    data.face_indices = schema.getFaceIndicesProperty();
-    data.num_samples = schema.getNumSamples();
-    data.velocities = schema.getVelocitiesProperty();
-    data.shader_face_sets = parse_face_sets_for_shader_assignment(schema, get_used_shaders());
-
-    read_geometry_data(proc, cached_data, data, progress);
+    read_geometry_data(params.frame_range, cached_data, data, progress);
 
     if (progress.get_cancel()) {
       return;
@@ -521,11 +520,12 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
 
     /* Use the schema as the base compound property to also be able to look for top level
      * properties. */
-    read_attributes(
-        proc, cached_data, schema, schema.getUVsParam(), get_requested_attributes(), progress);
-
-    cached_data.invalidate_last_loaded_time(true);
-    data_loaded = true;
+    read_attributes(params.frame_range,
+                    cached_data,
+                    schema,
+                    schema.getUVsParam(),
+                    params.requested_attributes,
+                    progress);
     return;
   }
 
@@ -547,9 +547,9 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
   data.holes = schema.getHolesProperty();
   data.subdivision_scheme = schema.getSubdivisionSchemeProperty();
   data.velocities = schema.getVelocitiesProperty();
-  data.shader_face_sets = parse_face_sets_for_shader_assignment(schema, get_used_shaders());
+  data.shader_face_sets = parse_face_sets_for_shader_assignment(schema, params.used_shaders);
 
-  read_geometry_data(proc, cached_data, data, progress);
+  read_geometry_data(params.frame_range, cached_data, data, progress);
 
   if (progress.get_cancel()) {
     return;
@@ -557,25 +557,19 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
 
   /* Use the schema as the base compound property to also be able to look for top level properties.
    */
-  read_attributes(
-      proc, cached_data, schema, schema.getUVsParam(), get_requested_attributes(), progress);
-
-  cached_data.invalidate_last_loaded_time(true);
-  data_loaded = true;
+  read_attributes(params.frame_range,
+                  cached_data,
+                  schema,
+                  schema.getUVsParam(),
+                  params.requested_attributes,
+                  progress);
 }
 
-void AlembicObject::load_data_in_cache(CachedData &cached_data,
-                                       AlembicProcedural *proc,
-                                       const ICurvesSchema &schema,
-                                       Progress &progress)
+static void load_curves_data_in_cache(CachedData &cached_data,
+                                      const AlembicObject::ReadParams &params,
+                                      const ICurvesSchema &schema,
+                                      Progress &progress)
 {
-  /* Only load data for the original Geometry. */
-  if (instance_of) {
-    return;
-  }
-
-  cached_data.clear();
-
   CurvesSchemaData data;
   data.positions = schema.getPositionsProperty();
   data.position_weights = schema.getPositionWeightsProperty();
@@ -588,10 +582,10 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
   data.topology_variance = schema.getTopologyVariance();
   data.num_samples = schema.getNumSamples();
   data.num_vertices = schema.getNumVerticesProperty();
-  data.default_radius = proc->get_default_radius();
-  data.radius_scale = get_radius_scale();
+  data.default_radius = params.default_radius;
+  data.radius_scale = params.radius_scale;
 
-  read_geometry_data(proc, cached_data, data, progress);
+  read_geometry_data(params.frame_range, cached_data, data, progress);
 
   if (progress.get_cancel()) {
     return;
@@ -599,11 +593,68 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
 
   /* Use the schema as the base compound property to also be able to look for top level properties.
    */
-  read_attributes(
-      proc, cached_data, schema, schema.getUVsParam(), get_requested_attributes(), progress);
+  read_attributes(params.frame_range,
+                  cached_data,
+                  schema,
+                  schema.getUVsParam(),
+                  params.requested_attributes,
+                  progress);
+}
+
+void AlembicObject::load_data_in_cache(CachedData &cached_data,
+                                       const ReadParams &params,
+                                       Progress &progress) const
+{
+  /* Only load data for the original Geometry. */
+  if (instance_of) {
+    return;
+  }
+
+  cached_data.clear();
+
+  if (schema_type == POLY_MESH) {
+    IPolyMesh polymesh(iobject, Alembic::Abc::kWrapExisting);
+    IPolyMeshSchema schema = polymesh.getSchema();
+    load_poly_mesh_data_in_cache(cached_data, params, schema, progress);
+  }
+  else if (schema_type == SUBD) {
+    ISubD subd_mesh(iobject, Alembic::Abc::kWrapExisting);
+    ISubDSchema schema = subd_mesh.getSchema();
+    load_subd_data_in_cache(cached_data, params, schema, progress);
+  }
+  else if (schema_type == CURVES) {
+    ICurves curves(iobject, Alembic::Abc::kWrapExisting);
+    ICurvesSchema schema = curves.getSchema();
+    load_curves_data_in_cache(cached_data, params, schema, progress);
+  }
 
   cached_data.invalidate_last_loaded_time(true);
-  data_loaded = true;
+}
+
+void AlembicObject::load_attributes_in_cache(CachedData &cached_data,
+                                             const ReadParams &params,
+                                             Progress &progress) const
+{
+  if (schema_type == POLY_MESH) {
+    IPolyMesh polymesh(iobject, Alembic::Abc::kWrapExisting);
+    IPolyMeshSchema schema = polymesh.getSchema();
+    read_attributes(params.frame_range,
+                    cached_data,
+                    schema,
+                    schema.getUVsParam(),
+                    params.requested_attributes,
+                    progress);
+  }
+  else if (schema_type == SUBD) {
+    ISubD subd_mesh(iobject, Alembic::Abc::kWrapExisting);
+    ISubDSchema schema = subd_mesh.getSchema();
+    read_attributes(params.frame_range,
+                    cached_data,
+                    schema,
+                    schema.getUVsParam(),
+                    params.requested_attributes,
+                    progress);
+  }
 }
 
 void AlembicObject::setup_transform_cache(CachedData &cached_data, float scale)
@@ -738,6 +789,7 @@ NODE_DEFINE(AlembicProcedural)
 
   SOCKET_BOOLEAN(use_prefetch, "Use Prefetch", true);
   SOCKET_INT(prefetch_cache_size, "Prefetch Cache Size", 4096);
+  SOCKET_INT(prefetch_frames, "Prefetch Frames", 0);
 
   return type;
 }
@@ -750,6 +802,9 @@ AlembicProcedural::AlembicProcedural() : Procedural(get_node_type())
 
 AlembicProcedural::~AlembicProcedural()
 {
+  /* The background prefetch references the objects. */
+  cancel_prefetch();
+
   ccl::set<Geometry *> geometries_set;
   ccl::set<Object *> objects_set;
   ccl::set<AlembicObject *> abc_objects_set;
@@ -836,6 +891,15 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     }
   }
 
+  /* The background prefetch reads with the settings from the time it was scheduled, discard its
+   * data when any of them changes. */
+  if (need_data_updates || need_shader_updates || objects_is_modified() ||
+      filepath_is_modified() || frame_rate_is_modified() || default_radius_is_modified() ||
+      use_prefetch_is_modified() || prefetch_frames_is_modified() ||
+      prefetch_cache_size_is_modified()) {
+    cancel_prefetch();
+  }
+
   if (!objects_loaded || objects_is_modified()) {
     load_objects(progress);
     objects_loaded = true;
@@ -856,12 +920,11 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     }
   }
 
+  /* The caches hold either the entire animation or a single frame, reload them when switching. */
   if (use_prefetch_is_modified()) {
-    if (!use_prefetch) {
-      for (Node *node : objects) {
-        AlembicObject *object = static_cast<AlembicObject *>(node);
-        object->clear_cache();
-      }
+    for (Node *node : objects) {
+      AlembicObject *object = static_cast<AlembicObject *>(node);
+      object->clear_cache();
     }
   }
 
@@ -880,6 +943,10 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     }
   }
 
+  if (!use_prefetch && frame_is_modified()) {
+    update_caches_for_frame(progress);
+  }
+
   build_caches(progress);
 
   foreach (Node *node, objects) {
@@ -891,7 +958,7 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
 
     /* skip constant objects */
     if (object->is_constant() && !object->is_modified() && !object->need_shader_update &&
-        !scale_is_modified()) {
+        !object->need_frame_update && !scale_is_modified()) {
       continue;
     }
 
@@ -906,9 +973,12 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     }
 
     object->need_shader_update = false;
+    object->need_frame_update = false;
     object->clear_modified();
   }
 
+  schedule_prefetch();
+
   clear_modified();
 }
 
@@ -1359,6 +1429,8 @@ void AlembicProcedural::build_caches(Progress &progress)
 {
   size_t memory_used = 0;
 
+  const AlembicFrameRange frame_range = get_frame_range_to_load();
+
   for (Node *node : objects) {
     AlembicObject *object = static_cast<AlembicObject *>(node);
 
@@ -1366,47 +1438,24 @@ void AlembicProcedural::build_caches(Progress &progress)
       return;
     }
 
-    if (object->schema_type == AlembicObject::POLY_MESH) {
-      if (!object->has_data_loaded()) {
-        IPolyMesh polymesh(object->iobject, Alembic::Abc::kWrapExisting);
-        IPolyMeshSchema schema = polymesh.getSchema();
-        object->load_data_in_cache(object->get_cached_data(), this, schema, progress);
-      }
-      else if (object->need_shader_update) {
-        IPolyMesh polymesh(object->iobject, Alembic::Abc::kWrapExisting);
-        IPolyMeshSchema schema = polymesh.getSchema();
-        read_attributes(this,
-                        object->get_cached_data(),
-                        schema,
-                        schema.getUVsParam(),
-                        object->get_requested_attributes(),
-                        progress);
-      }
+    bool need_load = !object->has_data_loaded();
+    if (object->schema_type == AlembicObject::CURVES) {
+      need_load |= default_radius_is_modified() || object->radius_scale_is_modified();
     }
-    else if (object->schema_type == AlembicObject::CURVES) {
-      if (!object->has_data_loaded() || default_radius_is_modified() ||
-          object->radius_scale_is_modified()) {
-        ICurves curves(object->iobject, Alembic::Abc::kWrapExisting);
-        ICurvesSchema schema = curves.getSchema();
-        object->load_data_in_cache(object->get_cached_data(), this, schema, progress);
+
+    if (need_load && !object->instance_of) {
+      const AlembicObject::ReadParams params = object->get_read_params(this, frame_range);
+      object->load_data_in_cache(object->get_cached_data(), params, progress);
+
+      if (progress.get_cancel()) {
+        return;
       }
+
+      object->data_loaded = true;
     }
-    else if (object->schema_type == AlembicObject::SUBD) {
-      if (!object->has_data_loaded()) {
-        ISubD subd_mesh(object->iobject, Alembic::Abc::kWrapExisting);
-        ISubDSchema schema = subd_mesh.getSchema();
-        object->load_data_in_cache(object->get_cached_data(), this, schema, progress);
-      }
-      else if (object->need_shader_update) {
-        ISubD subd_mesh(object->iobject, Alembic::Abc::kWrapExisting);
-        ISubDSchema schema = subd_mesh.getSchema();
-        read_attributes(this,
-                        object->get_cached_data(),
-                        schema,
-                        schema.getUVsParam(),
-                        object->get_requested_attributes(),
-                        progress);
-      }
+    else if (object->need_shader_update && !object->instance_of) {
+      const AlembicObject::ReadParams params = object->get_read_params(this, frame_range);
+      object->load_attributes_in_cache(object->get_cached_data(), params, progress);
     }
 
     if (scale_is_modified() || object->get_cached_data().transforms.size() == 0) {
@@ -1426,6 +1475,210 @@ void AlembicProcedural::build_caches(Progress &progress)
   VLOG(1) << "AlembicProcedural memory usage : " << string_human_readable_size(memory_used);
 }
 
+AlembicFrameRange AlembicProcedural::get_frame_range_to_load() const
+{
+  AlembicFrameRange frame_range;
+  frame_range.frame_rate = static_cast<double>(frame_rate);
+
+  if (use_prefetch) {
+    /* Load the data for the entire animation. */
+    frame_range.start_frame = static_cast<double>(start_frame);
+    frame_range.end_frame = static_cast<double>(end_frame);
+  }
+  else {
+    /* Load the data for the current frame. */
+    frame_range.start_frame = static_cast<double>(frame);
+    frame_range.end_frame = frame_range.start_frame;
+  }
+
+  return frame_range;
+}
+
+void AlembicProcedural::update_caches_for_frame(Progress &progress)
+{
+  PrefetchedFrame prefetched_frame;
+
+  {
+    thread_scoped_lock lock(prefetch_mutex_);
+
+    map<float, PrefetchedFrame>::iterator it = prefetched_frames_.find(frame);
+    if (it != prefetched_frames_.end()) {
+      prefetched_frame = std::move(it->second);
+      prefetched_frames_.erase(it);
+      prefetch_memory_used_ -= prefetched_frame.memory_used;
+    }
+
+    /* Drop frames which are not ahead of the current one anymore, for example after jumping
+     * backwards in the timeline. */
+    for (it = prefetched_frames_.begin(); it != prefetched_frames_.end();) {
+      if (it->first < frame || it->first > frame + prefetch_frames) {
+        prefetch_memory_used_ -= it->second.memory_used;
+        it = prefetched_frames_.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+  }
+
+  for (Node *node : objects) {
+    AlembicObject *object = static_cast<AlembicObject *>(node);
+
+    if (progress.get_cancel()) {
+      return;
+    }
+
+    /* Objects which are constant across frames keep their data, and since their sockets are not
+     * modified nothing is uploaded again to the device. */
+    if (!object->has_data_loaded() || object->instance_of ||
+        !object->get_cached_data().has_animation) {
+      continue;
+    }
+
+    CachedData *new_data = nullptr;
+    for (PrefetchedData &prefetched_data : prefetched_frame.objects) {
+      if (prefetched_data.object == object) {
+        new_data = prefetched_data.cached_data.get();
+        break;
+      }
+    }
+
+    if (new_data) {
+      /* Transforms are stored for the entire animation, keep them. */
+      CachedData &cached_data = object->get_cached_data();
+      std::swap(new_data->transforms, cached_data.transforms);
+      std::swap(*new_data, cached_data);
+    }
+    else {
+      /* Not prefetched (yet), read it on this thread in build_caches(). */
+      object->data_loaded = false;
+    }
+
+    object->need_frame_update = true;
+  }
+}
+
+void AlembicProcedural::schedule_prefetch()
+{
+  if (use_prefetch || prefetch_frames <= 0) {
+    return;
+  }
+
+  /* Gather the frames which are not prefetched yet, and the settings for reading the animated
+   * objects. Everything the background thread needs is copied here, so that it does not access
+   * any of the sockets. */
+  vector<float> frames;
+
+  {
+    thread_scoped_lock lock(prefetch_mutex_);
+
+    if (prefetch_running_) {
+      return;
+    }
+
+    for (int i = 1; i <= prefetch_frames; i++) {
+      const float prefetch_frame = frame + i;
+      if (prefetch_frame > end_frame) {
+        break;
+      }
+      if (prefetched_frames_.find(prefetch_frame) == prefetched_frames_.end()) {
+        frames.push_back(prefetch_frame);
+      }
+    }
+  }
+
+  if (frames.empty()) {
+    return;
+  }
+
+  vector<std::pair<AlembicObject *, AlembicObject::ReadParams>> objects_to_read;
+
+  for (Node *node : objects) {
+    AlembicObject *object = static_cast<AlembicObject *>(node);
+
+    if (!object->has_data_loaded() || object->instance_of ||
+        !object->get_cached_data().has_animation) {
+      continue;
+    }
+
+    objects_to_read.emplace_back(object, object->get_read_params(this, AlembicFrameRange()));
+  }
+
+  if (objects_to_read.empty()) {
+    return;
+  }
+
+  const double frame_rate_to_read = static_cast<double>(frame_rate);
+  const size_t cache_size = get_prefetch_cache_size_in_bytes();
+
+  {
+    thread_scoped_lock lock(prefetch_mutex_);
+    prefetch_running_ = true;
+  }
+
+  prefetch_pool_.push([this, frames, objects_to_read, frame_rate_to_read, cache_size]() {
+    /* Reading is not cancelled through the progress, but between objects. */
+    Progress progress;
+
+    for (const float prefetch_frame : frames) {
+      PrefetchedFrame prefetched_frame;
+
+      for (const std::pair<AlembicObject *, AlembicObject::ReadParams> &object_to_read :
+           objects_to_read) {
+        {
+          thread_scoped_lock lock(prefetch_mutex_);
+          if (prefetch_cancel_) {
+            break;
+          }
+        }
+
+        AlembicObject::ReadParams params = object_to_read.second;
+        params.frame_range.start_frame = prefetch_frame;
+        params.frame_range.end_frame = prefetch_frame;
+        params.frame_range.frame_rate = frame_rate_to_read;
+
+        PrefetchedData prefetched_data;
+        prefetched_data.object = object_to_read.first;
+        prefetched_data.cached_data = make_unique<CachedData>();
+        object_to_read.first->load_data_in_cache(*prefetched_data.cached_data, params, progress);
+
+        prefetched_frame.memory_used += prefetched_data.cached_data->memory_used();
+        prefetched_frame.objects.push_back(std::move(prefetched_data));
+      }
+
+      thread_scoped_lock lock(prefetch_mutex_);
+
+      /* Stop once the cache is full, the next frames will be read once the current frame moves
+       * forward and the oldest frames are consumed. */
+      if (prefetch_cancel_ || prefetch_memory_used_ + prefetched_frame.memory_used > cache_size) {
+        break;
+      }
+
+      prefetch_memory_used_ += prefetched_frame.memory_used;
+      prefetched_frames_[prefetch_frame] = std::move(prefetched_frame);
+    }
+
+    thread_scoped_lock lock(prefetch_mutex_);
+    prefetch_running_ = false;
+  });
+}
+
+void AlembicProcedural::cancel_prefetch()
+{
+  {
+    thread_scoped_lock lock(prefetch_mutex_);
+    prefetch_cancel_ = true;
+  }
+
+  prefetch_pool_.cancel();
+
+  thread_scoped_lock lock(prefetch_mutex_);
+  prefetched_frames_.clear();
+  prefetch_memory_used_ = 0;
+  prefetch_running_ = false;
+  prefetch_cancel_ = false;
+}
+
 CCL_NAMESPACE_END
 
 #endif
@@ -19,8 +19,12 @@
 #include "graph/node.h"
 #include "scene/attribute.h"
 #include "scene/procedural.h"
+#include "util/map.h"
 #include "util/set.h"
+#include "util/task.h"
+#include "util/thread.h"
 #include "util/transform.h"
+#include "util/unique_ptr.h"
 #include "util/vector.h"
 
 #ifdef WITH_ALEMBIC
@@ -28,6 +32,8 @@
 #  include <Alembic/AbcCoreFactory/All.h>
 #  include <Alembic/AbcGeom/All.h>
 
+#  include "scene/alembic_read.h"
+
 CCL_NAMESPACE_BEGIN
 
 class AlembicProcedural;
@@ -337,6 +343,10 @@ struct CachedData {
 
   vector<CachedAttribute> attributes{};
 
+  /* Set if any of the geometry or attribute data read from the archive has more than one sample,
+   * meaning that it can change between frames. Transforms are not taken into account. */
+  bool has_animation = false;
+
   void clear();
 
   CachedAttribute &add_attribute(const ustring &name,
@@ -383,6 +393,17 @@ class AlembicObject : public Node {
   /* Scale the radius of points and curves. */
   NODE_SOCKET_API(float, radius_scale)
 
+  /* Settings used to read the data from the archive. They are copied from the sockets and the
+   * scene, so that the data can also be read on a background thread while those are modified. */
+  struct ReadParams {
+    AlembicFrameRange frame_range;
+    AttributeRequestSet requested_attributes;
+    array<Node *> used_shaders;
+    bool ignore_subdivision = true;
+    float radius_scale = 1.0f;
+    float default_radius = 0.01f;
+  };
+
   AlembicObject();
   ~AlembicObject();
 
@@ -392,18 +413,19 @@ class AlembicObject : public Node {
   void set_object(Object *object);
   Object *get_object();
 
+  ReadParams get_read_params(const AlembicProcedural *proc, const AlembicFrameRange &frame_range);
+
+  /* Read the geometry and attributes of the object for the frame range of the parameters into the
+   * given cache. Does not modify the state of the object, so it is safe to call from the
+   * background prefetch. */
   void load_data_in_cache(CachedData &cached_data,
-                          AlembicProcedural *proc,
-                          Alembic::AbcGeom::IPolyMeshSchema &schema,
-                          Progress &progress);
-  void load_data_in_cache(CachedData &cached_data,
-                          AlembicProcedural *proc,
-                          Alembic::AbcGeom::ISubDSchema &schema,
-                          Progress &progress);
-  void load_data_in_cache(CachedData &cached_data,
-                          AlembicProcedural *proc,
-                          const Alembic::AbcGeom::ICurvesSchema &schema,
-                          Progress &progress);
+                          const ReadParams &params,
+                          Progress &progress) const;
+
+  /* Only (re)read the attributes, used when shaders requested new attributes. */
+  void load_attributes_in_cache(CachedData &cached_data,
+                                const ReadParams &params,
+                                Progress &progress) const;
 
   bool has_data_loaded() const;
 
@@ -418,6 +440,10 @@ class AlembicObject : public Node {
 
   bool need_shader_update = true;
 
+  /* The cached data was replaced with the data of the new frame, so sockets need to be updated
+   * even though the cache only holds a single frame. */
+  bool need_frame_update = false;
+
   AlembicObject *instance_of = nullptr;
 
   Alembic::AbcCoreAbstract::TimeSamplingPtr xform_time_sampling;
@@ -440,6 +466,7 @@ class AlembicObject : public Node {
   void clear_cache()
   {
     cached_data_.clear();
+    data_loaded = false;
   }
 
   Object *object = nullptr;
@@ -461,6 +488,9 @@ class AlembicObject : public Node {
  * This procedural will load the data set for the entire animation in memory on the first frame,
  * and directly set the data for the new frames on the created Nodes if needed. This allows for
  * faster updates between frames as it avoids reseeking the data on disk.
+ *
+ * Without prefetching only the current frame is loaded, and the next frames can be read ahead of
+ * time on a background thread into a cache of bounded size (see prefetch_frames).
  */
 class AlembicProcedural : public Procedural {
   Alembic::AbcGeom::IArchive archive;
@@ -506,6 +536,11 @@ class AlembicProcedural : public Procedural {
    */
   NODE_SOCKET_API(int, prefetch_cache_size)
 
+  /* Number of frames after the current one which are read on a background thread when the entire
+   * animation is not prefetched. Reading stops once the prefetched frames use more memory than
+   * the prefetch cache size. */
+  NODE_SOCKET_API(int, prefetch_frames)
+
   AlembicProcedural();
   ~AlembicProcedural();
 
@@ -556,6 +591,40 @@ class AlembicProcedural : public Procedural {
 
   void build_caches(Progress &progress);
 
+  /* Frames to load the data for on the render thread: the entire animation when prefetching,
+   * otherwise only the current frame. */
+  AlembicFrameRange get_frame_range_to_load() const;
+
+  /* Make the caches of animated objects hold the data of the current frame, taking it from the
+   * background prefetch if it is available there. Objects which are constant across frames keep
+   * their data, and are not uploaded again. */
+  void update_caches_for_frame(Progress &progress);
+
+  /* Start reading the data of the next frames on a background thread, if not running already. */
+  void schedule_prefetch();
+
+  /* Stop the background prefetch and discard the data it has read. */
+  void cancel_prefetch();
+
+  /* Data of a single object read by the background prefetch. */
+  struct PrefetchedData {
+    AlembicObject *object = nullptr;
+    unique_ptr<CachedData> cached_data;
+  };
+
+  /* Data of the animated objects read by the background prefetch, per frame. */
+  struct PrefetchedFrame {
+    vector<PrefetchedData> objects;
+    size_t memory_used = 0;
+  };
+
+  TaskPool prefetch_pool_;
+  thread_mutex prefetch_mutex_;
+  map<float, PrefetchedFrame> prefetched_frames_;
+  size_t prefetch_memory_used_ = 0;
+  bool prefetch_running_ = false;
+  bool prefetch_cancel_ = false;
+
   size_t get_prefetch_cache_size_in_bytes() const
   {
     /* prefetch_cache_size is in megabytes, so convert to bytes. */
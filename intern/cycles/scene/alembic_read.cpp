@@ -32,8 +32,8 @@ static float3 make_float3_from_yup(const V3f &v)
   return make_float3(v.x, -v.z, v.y);
 }
 
-/* get the sample times to load data for the given the start and end frame of the procedural */
-static set<chrono_t> get_relevant_sample_times(AlembicProcedural *proc,
+/* get the sample times to load data for the given the start and end frame of the frame range */
+static set<chrono_t> get_relevant_sample_times(const AlembicFrameRange &frame_range,
                                                const TimeSampling &time_sampling,
                                                size_t num_samples)
 {
@@ -44,21 +44,10 @@ static set<chrono_t> get_relevant_sample_times(AlembicProcedural *proc,
     return result;
   }
 
-  double start_frame;
-  double end_frame;
+  const double start_frame = frame_range.start_frame;
+  const double end_frame = frame_range.end_frame;
 
-  if (proc->get_use_prefetch()) {
-    // load the data for the entire animation
-    start_frame = static_cast<double>(proc->get_start_frame());
-    end_frame = static_cast<double>(proc->get_end_frame());
-  }
-  else {
-    // load the data for the current frame
-    start_frame = static_cast<double>(proc->get_frame());
-    end_frame = start_frame;
-  }
-
-  const double frame_rate = static_cast<double>(proc->get_frame_rate());
+  const double frame_rate = frame_range.frame_rate;
   const double start_time = start_frame / frame_rate;
   const double end_time = (end_frame + 1) / frame_rate;
 
@@ -76,17 +65,21 @@ static set<chrono_t> get_relevant_sample_times(AlembicProcedural *proc,
  * duration of the requested animation, and call the DataReadingFunc for each of those sample time.
  */
 template<typename Params, typename DataReadingFunc>
-static void read_data_loop(AlembicProcedural *proc,
+static void read_data_loop(const AlembicFrameRange &frame_range,
                            CachedData &cached_data,
                            const Params &params,
                            DataReadingFunc &&func,
                            Progress &progress)
 {
   const std::set<chrono_t> times = get_relevant_sample_times(
-      proc, *params.time_sampling, params.num_samples);
+      frame_range, *params.time_sampling, params.num_samples);
 
   cached_data.set_time_sampling(*params.time_sampling);
 
+  if (params.num_samples > 1) {
+    cached_data.has_animation = true;
+  }
+
   for (chrono_t time : times) {
     if (progress.get_cancel()) {
       return;
@@ -393,12 +386,12 @@ static void read_poly_mesh_geometry(CachedData &cached_data,
   }
 }
 
-void read_geometry_data(AlembicProcedural *proc,
+void read_geometry_data(const AlembicFrameRange &frame_range,
                         CachedData &cached_data,
                         const PolyMeshSchemaData &data,
                         Progress &progress)
 {
-  read_data_loop(proc, cached_data, data, read_poly_mesh_geometry, progress);
+  read_data_loop(frame_range, cached_data, data, read_poly_mesh_geometry, progress);
 }
 
 /* Subdivision Geometries */
@@ -529,12 +522,12 @@ static void read_subd_geometry(CachedData &cached_data, const SubDSchemaData &da
   }
 }
 
-void read_geometry_data(AlembicProcedural *proc,
+void read_geometry_data(const AlembicFrameRange &frame_range,
                         CachedData &cached_data,
                         const SubDSchemaData &data,
                         Progress &progress)
 {
-  read_data_loop(proc, cached_data, data, read_subd_geometry, progress);
+  read_data_loop(frame_range, cached_data, data, read_subd_geometry, progress);
 }
 
 /* Curve Geometries. */
@@ -601,12 +594,12 @@ static void read_curves_data(CachedData &cached_data, const CurvesSchemaData &da
   }
 }
 
-void read_geometry_data(AlembicProcedural *proc,
+void read_geometry_data(const AlembicFrameRange &frame_range,
                         CachedData &cached_data,
                         const CurvesSchemaData &data,
                         Progress &progress)
 {
-  read_data_loop(proc, cached_data, data, read_curves_data, progress);
+  read_data_loop(frame_range, cached_data, data, read_curves_data, progress);
 }
 
 /* Attributes conversions. */
@@ -816,7 +809,7 @@ using process_callback_type = void (*)(CachedData &,
  * extract data based on which frame time is requested by the procedural and execute the callback
  * for each of those requested time. */
 template<typename TRAIT>
-static void read_attribute_loop(AlembicProcedural *proc,
+static void read_attribute_loop(const AlembicFrameRange &frame_range,
                                 CachedData &cache,
                                 const ITypedGeomParam<TRAIT> &param,
                                 process_callback_type<TRAIT> callback,
@@ -824,12 +817,16 @@ static void read_attribute_loop(AlembicProcedural *proc,
                                 AttributeStandard std = ATTR_STD_NONE)
 {
   const std::set<chrono_t> times = get_relevant_sample_times(
-      proc, *param.getTimeSampling(), param.getNumSamples());
+      frame_range, *param.getTimeSampling(), param.getNumSamples());
 
   if (times.empty()) {
     return;
   }
 
+  if (param.getNumSamples() > 1) {
+    cache.has_animation = true;
+  }
+
   std::string name = param.getName();
 
   if (std == ATTR_STD_UV) {
@@ -967,7 +964,7 @@ static vector<PropHeaderAndParent> parse_requested_attributes(
  * attributes from the AttributeRequestSet in the ICompoundProperty and any of its compound child.
  * The attributes are added to the CachedData's attribute list. For each attribute we will try to
  * deduplicate data across consecutive frames. */
-void read_attributes(AlembicProcedural *proc,
+void read_attributes(const AlembicFrameRange &frame_range,
                      CachedData &cache,
                      const ICompoundProperty &arb_geom_params,
                      const IV2fGeomParam &default_uvs_param,
@@ -976,7 +973,7 @@ void read_attributes(AlembicProcedural *proc,
 {
   if (default_uvs_param.valid()) {
     /* Only the default UVs should be treated as the standard UV attribute. */
-    read_attribute_loop(proc, cache, default_uvs_param, process_uvs, progress, ATTR_STD_UV);
+    read_attribute_loop(frame_range, cache, default_uvs_param, process_uvs, progress, ATTR_STD_UV);
   }
 
   vector<PropHeaderAndParent> requested_properties = parse_requested_attributes(
@@ -992,40 +989,40 @@ void read_attributes(AlembicProcedural *proc,
 
     if (IBoolGeomParam::matches(*prop)) {
       const IBoolGeomParam &param = IBoolGeomParam(parent, prop->getName());
-      read_attribute_loop(proc, cache, param, process_attribute<BooleanTPTraits>, progress);
+      read_attribute_loop(frame_range, cache, param, process_attribute<BooleanTPTraits>, progress);
     }
     else if (IInt32GeomParam::matches(*prop)) {
       const IInt32GeomParam &param = IInt32GeomParam(parent, prop->getName());
-      read_attribute_loop(proc, cache, param, process_attribute<Int32TPTraits>, progress);
+      read_attribute_loop(frame_range, cache, param, process_attribute<Int32TPTraits>, progress);
     }
     else if (IFloatGeomParam::matches(*prop)) {
       const IFloatGeomParam &param = IFloatGeomParam(parent, prop->getName());
-      read_attribute_loop(proc, cache, param, process_attribute<Float32TPTraits>, progress);
+      read_attribute_loop(frame_range, cache, param, process_attribute<Float32TPTraits>, progress);
     }
     else if (IV2fGeomParam::matches(*prop)) {
       const IV2fGeomParam &param = IV2fGeomParam(parent, prop->getName());
       if (Alembic::AbcGeom::isUV(*prop)) {
-        read_attribute_loop(proc, cache, param, process_uvs, progress);
+        read_attribute_loop(frame_range, cache, param, process_uvs, progress);
       }
       else {
-        read_attribute_loop(proc, cache, param, process_attribute<V2fTPTraits>, progress);
+        read_attribute_loop(frame_range, cache, param, process_attribute<V2fTPTraits>, progress);
       }
     }
     else if (IV3fGeomParam::matches(*prop)) {
       const IV3fGeomParam &param = IV3fGeomParam(parent, prop->getName());
-      read_attribute_loop(proc, cache, param, process_attribute<V3fTPTraits>, progress);
+      read_attribute_loop(frame_range, cache, param, process_attribute<V3fTPTraits>, progress);
     }
     else if (IN3fGeomParam::matches(*prop)) {
       const IN3fGeomParam &param = IN3fGeomParam(parent, prop->getName());
-      read_attribute_loop(proc, cache, param, process_attribute<N3fTPTraits>, progress);
+      read_attribute_loop(frame_range, cache, param, process_attribute<N3fTPTraits>, progress);
     }
     else if (IC3fGeomParam::matches(*prop)) {
       const IC3fGeomParam &param = IC3fGeomParam(parent, prop->getName());
-      read_attribute_loop(proc, cache, param, process_attribute<C3fTPTraits>, progress);
+      read_attribute_loop(frame_range, cache, param, process_attribute<C3fTPTraits>, progress);
     }
     else if (IC4fGeomParam::matches(*prop)) {
       const IC4fGeomParam &param = IC4fGeomParam(parent, prop->getName());
-      read_attribute_loop(proc, cache, param, process_attribute<C4fTPTraits>, progress);
+      read_attribute_loop(frame_range, cache, param, process_attribute<C4fTPTraits>, progress);
     }
   }
 
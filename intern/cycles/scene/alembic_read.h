@@ -25,11 +25,17 @@
 
 CCL_NAMESPACE_BEGIN
 
-class AlembicProcedural;
 class AttributeRequestSet;
 class Progress;
 struct CachedData;
 
+/* Frames of the animation for which data is read from the archive, both inclusive. */
+struct AlembicFrameRange {
+  double start_frame = 0.0;
+  double end_frame = 0.0;
+  double frame_rate = 24.0;
+};
+
 /* Maps a FaceSet whose name matches that of a Shader to the index of said shader in the Geometry's
  * used_shaders list. */
 struct FaceSetShaderIndexPair {
@@ -55,7 +61,7 @@ struct PolyMeshSchemaData {
   Alembic::AbcGeom::IV3fArrayProperty velocities;
 };
 
-void read_geometry_data(AlembicProcedural *proc,
+void read_geometry_data(const AlembicFrameRange &frame_range,
                         CachedData &cached_data,
                         const PolyMeshSchemaData &data,
                         Progress &progress);
@@ -87,7 +93,7 @@ struct SubDSchemaData {
   Alembic::AbcGeom::IV3fArrayProperty velocities;
 };
 
-void read_geometry_data(AlembicProcedural *proc,
+void read_geometry_data(const AlembicFrameRange &frame_range,
                         CachedData &cached_data,
                         const SubDSchemaData &data,
                         Progress &progress);
@@ -117,12 +123,12 @@ struct CurvesSchemaData {
   // TODO(@kevindietrich): type, basis, wrap
 };
 
-void read_geometry_data(AlembicProcedural *proc,
+void read_geometry_data(const AlembicFrameRange &frame_range,
                         CachedData &cached_data,
                         const CurvesSchemaData &data,
                         Progress &progress);
 
-void read_attributes(AlembicProcedural *proc,
+void read_attributes(const AlembicFrameRange &frame_range,
                      CachedData &cache,
                      const Alembic::AbcGeom::ICompoundProperty &arb_geom_params,
                      const Alembic::AbcGeom::IV2fGeomParam &default_uvs_param,
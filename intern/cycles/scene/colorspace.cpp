@@ -107,6 +107,25 @@ bool ColorSpaceManager::colorspace_is_data(ustring colorspace)
 #endif
 }
 
+string ColorSpaceManager::config_cache_id()
+{
+#ifdef WITH_OCIO
+  OCIO::ConstConfigRcPtr config = OCIO::GetCurrentConfig();
+  if (!config) {
+    return "";
+  }
+
+  try {
+    return config->getCacheID();
+  }
+  catch (OCIO::Exception &) {
+    return "";
+  }
+#else
+  return "";
+#endif
+}
+
 ustring ColorSpaceManager::detect_known_colorspace(ustring colorspace,
                                                    const char *file_format,
                                                    bool is_float)
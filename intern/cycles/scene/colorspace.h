@@ -19,6 +19,7 @@
 
 #include "util/map.h"
 #include "util/param.h"
+#include "util/string.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -54,6 +55,10 @@ class ColorSpaceManager {
   static ColorSpaceProcessor *get_processor(ustring colorspace);
   static void to_scene_linear(ColorSpaceProcessor *processor, float *pixel, int channels);
 
+  /* Identifier of the current OpenColorIO configuration, which changes along with the
+   * result of color space conversions. Empty when OpenColorIO is not available. */
+  static string config_cache_id();
+
   /* Clear memory when the application exits. Invalidates all processors. */
   static void free_memory();
 
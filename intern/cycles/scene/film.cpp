@@ -427,6 +427,20 @@ int Film::get_aov_offset(Scene *scene, string name, bool &is_color)
   return -1;
 }
 
+string Film::get_aov_layout(const Scene *scene) const
+{
+  string layout;
+  foreach (const Pass *pass, scene->passes) {
+    if (pass->get_type() == PASS_AOV_VALUE) {
+      layout += "v:" + pass->get_name().string() + ";";
+    }
+    else if (pass->get_type() == PASS_AOV_COLOR) {
+      layout += "c:" + pass->get_name().string() + ";";
+    }
+  }
+  return layout;
+}
+
 void Film::update_passes(Scene *scene, bool add_sample_count_pass)
 {
   const Background *background = scene->background;
@@ -529,6 +543,7 @@ void Film::update_passes(Scene *scene, bool add_sample_count_pass)
   const bool have_uv_pass = Pass::contains(scene->passes, PASS_UV);
   const bool have_motion_pass = Pass::contains(scene->passes, PASS_MOTION);
   const bool have_ao_pass = Pass::contains(scene->passes, PASS_AO);
+  const string aov_layout = get_aov_layout(scene);
 
   if (have_uv_pass != prev_have_uv_pass) {
     scene->geometry_manager->tag_update(scene, GeometryManager::UV_PASS_NEEDED);
@@ -541,10 +556,14 @@ void Film::update_passes(Scene *scene, bool add_sample_count_pass)
   if (have_ao_pass != prev_have_ao_pass) {
     scene->integrator->tag_update(scene, Integrator::AO_PASS_MODIFIED);
   }
+  if (aov_layout != prev_aov_layout) {
+    scene->shader_manager->tag_update(scene, ShaderManager::AOV_PASSES_MODIFIED);
+  }
 
   prev_have_uv_pass = have_uv_pass;
   prev_have_motion_pass = have_motion_pass;
   prev_have_ao_pass = have_ao_pass;
+  prev_aov_layout = aov_layout;
 
   tag_modified();
 
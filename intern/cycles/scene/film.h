@@ -68,6 +68,7 @@ class Film : public Node {
   bool prev_have_uv_pass = false;
   bool prev_have_motion_pass = false;
   bool prev_have_ao_pass = false;
+  string prev_aov_layout;
 
  public:
   Film();
@@ -81,6 +82,10 @@ class Film : public Node {
 
   int get_aov_offset(Scene *scene, string name, bool &is_color);
 
+  /* Names and types of the AOV passes in the order they are stored in the render buffer. Shaders
+   * writing to AOVs are compiled with offsets that depend on this layout. */
+  string get_aov_layout(const Scene *scene) const;
+
   /* Update passes so that they contain all passes required for the configured functionality.
    *
    * If `add_sample_count_pass` is true then the SAMPLE_COUNT pass is ensured to be added. */
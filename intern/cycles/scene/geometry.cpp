@@ -30,6 +30,7 @@
 #include "scene/shader.h"
 #include "scene/shader_nodes.h"
 #include "scene/stats.h"
+#include "scene/tessellation_cache.h"
 #include "scene/volume.h"
 
 #include "subd/patch_table.h"
@@ -41,9 +42,49 @@
 #include "util/log.h"
 #include "util/progress.h"
 #include "util/task.h"
+#include "util/time.h"
 
 CCL_NAMESPACE_BEGIN
 
+/* BVH Update Statistics */
+
+BVHUpdateStats::BVHUpdateStats() : num_builds(0), num_refits(0), build_time(0.0), refit_time(0.0)
+{
+}
+
+void BVHUpdateStats::add_build(double time)
+{
+  thread_scoped_lock lock(mutex);
+  num_builds++;
+  build_time += time;
+}
+
+void BVHUpdateStats::add_refit(double time)
+{
+  thread_scoped_lock lock(mutex);
+  num_refits++;
+  refit_time += time;
+}
+
+/* BVH Layout */
+
+/* Compact mesh storage is only decoded by the CPU kernels. */
+static bool geometry_use_compact_mesh(const SceneParams *params, Device *device)
+{
+  return params->use_compact_mesh && device->info.type == DEVICE_CPU;
+}
+
+/* Embree intersects its own full precision copy of the vertex positions, so compact mesh storage
+ * would not save memory and shading would use different positions than the intersection, which
+ * leads to self intersections. Use BVH2 then, which intersects the quantized positions. */
+static BVHLayout geometry_bvh_layout(const SceneParams *params, Device *device)
+{
+  const BVHLayout requested_layout = geometry_use_compact_mesh(params, device) ?
+                                         BVH_LAYOUT_BVH2 :
+                                         params->bvh_layout;
+  return BVHParams::best_bvh_layout(requested_layout, device->get_bvh_layout_mask());
+}
+
 /* Geometry */
 
 NODE_ABSTRACT_DEFINE(Geometry)
@@ -62,6 +103,7 @@ Geometry::Geometry(const NodeType *node_type, const Type type)
 {
   need_update_rebuild = false;
   need_update_bvh_for_offset = false;
+  is_deforming = false;
 
   transform_applied = false;
   transform_negative_scaled = false;
@@ -191,16 +233,20 @@ bool Geometry::has_true_displacement() const
   return false;
 }
 
-void Geometry::compute_bvh(
-    Device *device, DeviceScene *dscene, SceneParams *params, Progress *progress, int n, int total)
+void Geometry::compute_bvh(Device *device,
+                           DeviceScene *dscene,
+                           SceneParams *params,
+                           Progress *progress,
+                           BVHUpdateStats *bvh_stats,
+                           int n,
+                           int total)
 {
   if (progress->get_cancel())
     return;
 
   compute_bounds();
 
-  const BVHLayout bvh_layout = BVHParams::best_bvh_layout(params->bvh_layout,
-                                                          device->get_bvh_layout_mask());
+  const BVHLayout bvh_layout = geometry_bvh_layout(params, device);
   if (need_build_bvh(bvh_layout)) {
     string msg = "Updating Geometry BVH ";
     if (name.empty())
@@ -222,30 +268,39 @@ void Geometry::compute_bvh(
     vector<Object *> objects;
     objects.push_back(&object);
 
-    if (bvh && !need_update_rebuild) {
+    const double start_time = time_dt();
+
+    if (bvh && !need_update_rebuild && params->bvh_refit_policy != BVH_REFIT_NEVER) {
       progress->set_status(msg, "Refitting BVH");
 
       bvh->geometry = geometry;
       bvh->objects = objects;
 
       device->build_bvh(bvh, *progress, true);
+
+      bvh_stats->add_refit(time_dt() - start_time);
     }
     else {
       progress->set_status(msg, "Building BVH");
 
       BVHParams bparams;
-      bparams.use_spatial_split = params->use_bvh_spatial_split;
+      bparams.use_compact_mesh = geometry_use_compact_mesh(params, device);
+      bparams.use_spatial_split = params->use_bvh_spatial_split && !bparams.use_compact_mesh;
       bparams.bvh_layout = bvh_layout;
       bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
                                     params->use_bvh_unaligned_nodes;
       bparams.num_motion_triangle_steps = params->num_bvh_time_steps;
       bparams.num_motion_curve_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
+      bparams.bvh_refit_policy = params->bvh_refit_policy;
       bparams.curve_subdivisions = params->curve_subdivisions();
+      bparams.use_disk_cache = params->use_bvh_disk_cache;
 
       delete bvh;
       bvh = BVH::create(bparams, geometry, objects, device);
       MEM_GUARDED_CALL(progress, device->build_bvh, bvh, *progress, false);
+
+      bvh_stats->add_build(time_dt() - start_time);
     }
   }
 
@@ -1066,7 +1121,7 @@ void GeometryManager::mesh_calc_offset(Scene *scene, BVHLayout bvh_layout)
   }
 }
 
-void GeometryManager::device_update_mesh(Device *,
+void GeometryManager::device_update_mesh(Device *device,
                                          DeviceScene *dscene,
                                          Scene *scene,
                                          Progress &progress)
@@ -1113,18 +1168,36 @@ void GeometryManager::device_update_mesh(Device *,
     /* normals */
     progress.set_status("Updating Mesh", "Computing normals");
 
-    packed_float3 *tri_verts = dscene->tri_verts.alloc(tri_size * 3);
+    /* Compact storage is only decoded by the CPU kernels, the GPU intersection programs read the
+     * full precision vertex positions. */
+    const bool use_compact_mesh = geometry_use_compact_mesh(&scene->params, device);
+    size_t num_meshes = 0;
+    foreach (Geometry *geom, scene->geometry) {
+      if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
+        num_meshes++;
+      }
+    }
+
+    packed_float3 *tri_verts = dscene->tri_verts.alloc(use_compact_mesh ? 0 : tri_size * 3);
     uint *tri_shader = dscene->tri_shader.alloc(tri_size);
-    packed_float3 *vnormal = dscene->tri_vnormal.alloc(vert_size);
+    packed_float3 *vnormal = dscene->tri_vnormal.alloc(use_compact_mesh ? 0 : vert_size);
     uint4 *tri_vindex = dscene->tri_vindex.alloc(tri_size);
     uint *tri_patch = dscene->tri_patch.alloc(tri_size);
     float2 *tri_patch_uv = dscene->tri_patch_uv.alloc(vert_size);
+    uint2 *tri_verts_compact = dscene->tri_verts_compact.alloc(use_compact_mesh ? vert_size : 0);
+    packed_float3 *tri_verts_compact_bounds = dscene->tri_verts_compact_bounds.alloc(
+        use_compact_mesh ? num_meshes * 2 : 0);
+    uint *vnormal_compact = dscene->tri_vnormal_compact.alloc(use_compact_mesh ? vert_size : 0);
 
     const bool copy_all_data = dscene->tri_shader.need_realloc() ||
                                dscene->tri_vindex.need_realloc() ||
                                dscene->tri_vnormal.need_realloc() ||
                                dscene->tri_patch.need_realloc() ||
-                               dscene->tri_patch_uv.need_realloc();
+                               dscene->tri_patch_uv.need_realloc() ||
+                               dscene->tri_verts_compact.need_realloc() ||
+                               dscene->tri_vnormal_compact.need_realloc();
+
+    uint bounds_index = 0;
 
     foreach (Geometry *geom, scene->geometry) {
       if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
@@ -1136,22 +1209,41 @@ void GeometryManager::device_update_mesh(Device *,
         }
 
         if (mesh->verts_is_modified() || copy_all_data) {
-          mesh->pack_normals(&vnormal[mesh->vert_offset]);
+          if (use_compact_mesh) {
+            mesh->pack_normals_compact(&vnormal_compact[mesh->vert_offset]);
+          }
+          else {
+            mesh->pack_normals(&vnormal[mesh->vert_offset]);
+          }
         }
 
         if (mesh->verts_is_modified() || mesh->triangles_is_modified() ||
             mesh->vert_patch_uv_is_modified() || copy_all_data) {
-          mesh->pack_verts(&tri_verts[mesh->prim_offset * 3],
-                           &tri_vindex[mesh->prim_offset],
-                           &tri_patch[mesh->prim_offset],
-                           &tri_patch_uv[mesh->vert_offset]);
+          if (use_compact_mesh) {
+            mesh->pack_verts_compact(&tri_verts_compact[mesh->vert_offset],
+                                     tri_verts_compact_bounds,
+                                     bounds_index,
+                                     &tri_vindex[mesh->prim_offset],
+                                     &tri_patch[mesh->prim_offset],
+                                     &tri_patch_uv[mesh->vert_offset]);
+          }
+          else {
+            mesh->pack_verts(&tri_verts[mesh->prim_offset * 3],
+                             &tri_vindex[mesh->prim_offset],
+                             &tri_patch[mesh->prim_offset],
+                             &tri_patch_uv[mesh->vert_offset]);
+          }
         }
 
+        bounds_index++;
+
         if (progress.get_cancel())
           return;
       }
     }
 
+    dscene->data.bvh.use_compact_mesh = use_compact_mesh;
+
     /* vertex coordinates */
     progress.set_status("Updating Mesh", "Copying Mesh to device");
 
@@ -1161,6 +1253,9 @@ void GeometryManager::device_update_mesh(Device *,
     dscene->tri_vindex.copy_to_device_if_modified();
     dscene->tri_patch.copy_to_device_if_modified();
     dscene->tri_patch_uv.copy_to_device_if_modified();
+    dscene->tri_verts_compact.copy_to_device_if_modified();
+    dscene->tri_verts_compact_bounds.copy_to_device_if_modified();
+    dscene->tri_vnormal_compact.copy_to_device_if_modified();
   }
 
   if (curve_segment_size != 0) {
@@ -1235,14 +1330,15 @@ void GeometryManager::device_update_bvh(Device *device,
 
   BVHParams bparams;
   bparams.top_level = true;
-  bparams.bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
-                                                  device->get_bvh_layout_mask());
-  bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
+  bparams.bvh_layout = geometry_bvh_layout(&scene->params, device);
+  bparams.use_compact_mesh = geometry_use_compact_mesh(&scene->params, device);
+  bparams.use_spatial_split = scene->params.use_bvh_spatial_split && !bparams.use_compact_mesh;
   bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
                                 scene->params.use_bvh_unaligned_nodes;
   bparams.num_motion_triangle_steps = scene->params.num_bvh_time_steps;
   bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
   bparams.bvh_type = scene->params.bvh_type;
+  bparams.bvh_refit_policy = scene->params.bvh_refit_policy;
   bparams.curve_subdivisions = scene->params.curve_subdivisions();
 
   VLOG(1) << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
@@ -1506,6 +1602,33 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
       device_update_flags |= DEVICE_MESH_DATA_NEEDS_REALLOC;
     }
 
+    /* Detect geometry where only vertex positions change, for the BVH refit policy. Once
+     * deforming, geometry stays so until its topology changes, so that it does not switch
+     * between refitting and rebuilding as part of the scene BVH every frame. */
+    if (geom->is_modified()) {
+      if (geom->need_update_rebuild) {
+        geom->is_deforming = false;
+      }
+      else if (geom->is_mesh()) {
+        Mesh *mesh = static_cast<Mesh *>(geom);
+        if (mesh->triangles_is_modified()) {
+          mesh->is_deforming = false;
+        }
+        else if (mesh->verts_is_modified()) {
+          mesh->is_deforming = true;
+        }
+      }
+      else if (geom->is_hair()) {
+        Hair *hair = static_cast<Hair *>(geom);
+        if (hair->curve_first_key_is_modified()) {
+          hair->is_deforming = false;
+        }
+        else if (hair->curve_keys_is_modified()) {
+          hair->is_deforming = true;
+        }
+      }
+    }
+
     if (geom->is_hair()) {
       /* Set curve shape, still a global scene setting for now. */
       Hair *hair = static_cast<Hair *>(geom);
@@ -1561,6 +1684,9 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
       dscene->tri_vindex.tag_realloc();
       dscene->tri_patch.tag_realloc();
       dscene->tri_patch_uv.tag_realloc();
+      dscene->tri_verts_compact.tag_realloc();
+      dscene->tri_verts_compact_bounds.tag_realloc();
+      dscene->tri_vnormal_compact.tag_realloc();
       dscene->tri_shader.tag_realloc();
       dscene->patches.tag_realloc();
     }
@@ -1621,6 +1747,9 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
      * these are the only arrays that can be updated */
     dscene->tri_verts.tag_modified();
     dscene->tri_vnormal.tag_modified();
+    dscene->tri_verts_compact.tag_modified();
+    dscene->tri_verts_compact_bounds.tag_modified();
+    dscene->tri_vnormal_compact.tag_modified();
     dscene->tri_shader.tag_modified();
   }
 
@@ -1780,6 +1909,11 @@ void GeometryManager::device_update(Device *device,
     return;
   }
 
+  /* Meshes restored from the tessellation cache are already displaced. Newly tessellated meshes
+   * are stored in the cache once displacement is done. */
+  set<Mesh *> tessellation_cache_restored;
+  vector<pair<Mesh *, TessellationCacheKey>> tessellation_cache_pending;
+
   /* Tessellate meshes that are using subdivision */
   if (total_tess_needed) {
     scoped_callback_timer timer([scene](double time) {
@@ -1794,6 +1928,13 @@ void GeometryManager::device_update(Device *device,
                                    dicing_camera->get_full_height());
     dicing_camera->update(scene);
 
+    if (scene->params.use_tessellation_cache) {
+      scene->tessellation_cache->begin_update();
+    }
+    else {
+      scene->tessellation_cache->clear();
+    }
+
     size_t i = 0;
     foreach (Geometry *geom, scene->geometry) {
       if (!(geom->is_modified() && geom->is_mesh())) {
@@ -1812,8 +1953,26 @@ void GeometryManager::device_update(Device *device,
         progress.set_status("Updating Mesh", msg);
 
         mesh->subd_params->camera = dicing_camera;
-        DiagSplit dsplit(*mesh->subd_params);
-        mesh->tessellate(&dsplit);
+
+        bool restored = false;
+        if (scene->params.use_tessellation_cache) {
+          TessellationCacheKey key(scene, mesh);
+          if (!key.empty()) {
+            restored = scene->tessellation_cache->restore(
+                key, scene->params.tessellation_cache_tolerance, mesh);
+            if (restored) {
+              tessellation_cache_restored.insert(mesh);
+            }
+            else {
+              tessellation_cache_pending.emplace_back(mesh, std::move(key));
+            }
+          }
+        }
+
+        if (!restored) {
+          DiagSplit dsplit(*mesh->subd_params);
+          mesh->tessellate(&dsplit);
+        }
 
         i++;
 
@@ -1845,8 +2004,7 @@ void GeometryManager::device_update(Device *device,
   /* Device update. */
   device_free(device, dscene, false);
 
-  const BVHLayout bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
-                                                          device->get_bvh_layout_mask());
+  const BVHLayout bvh_layout = geometry_bvh_layout(&scene->params, device);
   mesh_calc_offset(scene, bvh_layout);
   if (true_displacement_used || curve_shadow_transparency_used) {
     scoped_callback_timer timer([scene](double time) {
@@ -1892,7 +2050,8 @@ void GeometryManager::device_update(Device *device,
       if (geom->is_modified()) {
         if (geom->is_mesh()) {
           Mesh *mesh = static_cast<Mesh *>(geom);
-          if (displace(device, scene, mesh, progress)) {
+          if (tessellation_cache_restored.count(mesh) == 0 &&
+              displace(device, scene, mesh, progress)) {
             displacement_done = true;
           }
         }
@@ -1920,6 +2079,10 @@ void GeometryManager::device_update(Device *device,
     return;
   }
 
+  foreach (auto &pending, tessellation_cache_pending) {
+    scene->tessellation_cache->store(pending.second, pending.first);
+  }
+
   /* Device re-update after displacement. */
   if (displacement_done || curve_shadow_transparency_done) {
     scoped_callback_timer timer([scene](double time) {
@@ -1956,7 +2119,15 @@ void GeometryManager::device_update(Device *device,
       if (geom->is_modified() || geom->need_update_bvh_for_offset) {
         need_update_scene_bvh = true;
         pool.push(function_bind(
-            &Geometry::compute_bvh, geom, device, dscene, &scene->params, &progress, i, num_bvh));
+            &Geometry::compute_bvh,
+            geom,
+            device,
+            dscene,
+            &scene->params,
+            &progress,
+            &bvh_stats,
+            i,
+            num_bvh));
         if (geom->need_build_bvh(bvh_layout)) {
           i++;
         }
@@ -2007,8 +2178,7 @@ void GeometryManager::device_update(Device *device,
 
   /* Always set BVH layout again after displacement where it was set to none,
    * to avoid ray-tracing at that stage. */
-  dscene->data.bvh.bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
-                                                           device->get_bvh_layout_mask());
+  dscene->data.bvh.bvh_layout = geometry_bvh_layout(&scene->params, device);
 
   {
     scoped_callback_timer timer([scene](double time) {
@@ -2061,6 +2231,9 @@ void GeometryManager::device_update(Device *device,
   dscene->tri_patch.clear_modified();
   dscene->tri_vnormal.clear_modified();
   dscene->tri_patch_uv.clear_modified();
+  dscene->tri_verts_compact.clear_modified();
+  dscene->tri_verts_compact_bounds.clear_modified();
+  dscene->tri_vnormal_compact.clear_modified();
   dscene->curves.clear_modified();
   dscene->curve_keys.clear_modified();
   dscene->curve_segments.clear_modified();
@@ -2089,6 +2262,9 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene, bool forc
   dscene->tri_vindex.free_if_need_realloc(force_free);
   dscene->tri_patch.free_if_need_realloc(force_free);
   dscene->tri_patch_uv.free_if_need_realloc(force_free);
+  dscene->tri_verts_compact.free_if_need_realloc(force_free);
+  dscene->tri_verts_compact_bounds.free_if_need_realloc(force_free);
+  dscene->tri_vnormal_compact.free_if_need_realloc(force_free);
   dscene->curves.free_if_need_realloc(force_free);
   dscene->curve_keys.free_if_need_realloc(force_free);
   dscene->curve_segments.free_if_need_realloc(force_free);
@@ -2137,6 +2313,12 @@ void GeometryManager::collect_statistics(const Scene *scene, RenderStats *stats)
     stats->mesh.geometry.add_entry(
         NamedSizeEntry(string(geometry->name.c_str()), geometry->get_total_size_in_bytes()));
   }
+
+  stats->mesh.bvh_refit_policy = scene->params.bvh_refit_policy;
+  stats->mesh.bvh_num_builds = bvh_stats.num_builds;
+  stats->mesh.bvh_num_refits = bvh_stats.num_refits;
+  stats->mesh.bvh_build_time = bvh_stats.build_time;
+  stats->mesh.bvh_refit_time = bvh_stats.refit_time;
 }
 
 CCL_NAMESPACE_END
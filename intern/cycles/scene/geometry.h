@@ -25,6 +25,7 @@
 
 #include "util/boundbox.h"
 #include "util/set.h"
+#include "util/thread.h"
 #include "util/transform.h"
 #include "util/types.h"
 #include "util/vector.h"
@@ -43,6 +44,26 @@ class Shader;
 class Volume;
 struct PackedBVH;
 
+/* BVH Update Statistics
+ *
+ * Number and time of geometry BVH builds and refits, accumulated over all scene updates. */
+
+class BVHUpdateStats {
+ public:
+  BVHUpdateStats();
+
+  void add_build(double time);
+  void add_refit(double time);
+
+  int num_builds;
+  int num_refits;
+  double build_time;
+  double refit_time;
+
+ protected:
+  thread_mutex mutex;
+};
+
 /* Geometry
  *
  * Base class for geometric types like Mesh and Hair. */
@@ -91,6 +112,10 @@ class Geometry : public Node {
   bool need_update_rebuild;
   bool need_update_bvh_for_offset;
 
+  /* Vertex positions changed in an update without topology changes, set in
+   * device_update_preprocess(). Used by the BVH refit policy. */
+  bool is_deforming;
+
   /* Index into scene->geometry (only valid during update) */
   size_t index;
 
@@ -122,6 +147,7 @@ class Geometry : public Node {
                    DeviceScene *dscene,
                    SceneParams *params,
                    Progress *progress,
+                   BVHUpdateStats *bvh_stats,
                    int n,
                    int total);
 
@@ -201,6 +227,9 @@ class GeometryManager {
   /* Update Flags */
   bool need_flags_update;
 
+  /* Statistics */
+  BVHUpdateStats bvh_stats;
+
   /* Constructor/Destructor */
   GeometryManager();
   ~GeometryManager();
@@ -26,10 +26,13 @@
 #include "util/image.h"
 #include "util/image_impl.h"
 #include "util/log.h"
+#include "util/md5.h"
 #include "util/path.h"
 #include "util/progress.h"
+#include "util/system.h"
 #include "util/task.h"
 #include "util/texture.h"
+#include "util/texture_cache.h"
 #include "util/unique_ptr.h"
 
 #ifdef WITH_OSL
@@ -289,6 +292,23 @@ bool ImageLoader::equals(const ImageLoader *a, const ImageLoader *b)
   }
 }
 
+bool ImageLoader::supports_tiles() const
+{
+  return false;
+}
+
+bool ImageLoader::load_pixels_tile(const ImageMetaData & /*metadata*/,
+                                   const int /*level*/,
+                                   const int /*x*/,
+                                   const int /*y*/,
+                                   const int /*w*/,
+                                   const int /*h*/,
+                                   void * /*pixels*/,
+                                   const bool /*associate_alpha*/)
+{
+  return false;
+}
+
 bool ImageLoader::is_vdb_loader() const
 {
   return false;
@@ -441,6 +461,7 @@ int ImageManager::add_image_slot(ImageLoader *loader,
   img->builtin = builtin;
   img->users = 1;
   img->mem = NULL;
+  img->cache_image = NULL;
 
   images[slot] = img;
 
@@ -483,54 +504,25 @@ static bool image_associate_alpha(ImageManager::Image *img)
            img->params.alpha_type == IMAGE_ALPHA_CHANNEL_PACKED);
 }
 
-template<TypeDesc::BASETYPE FileFormat, typename StorageType>
-bool ImageManager::file_load_image(Image *img, int texture_limit)
+/* The kernel can handle 1 and 4 channel images. Anything that is not a single
+ * channel image is converted to RGBA format. */
+static bool image_is_rgba(const ImageManager::Image *img)
 {
-  /* Ignore empty images. */
-  if (!(img->metadata.channels > 0)) {
-    return false;
-  }
-
-  /* Get metadata. */
-  int width = img->metadata.width;
-  int height = img->metadata.height;
-  int depth = img->metadata.depth;
-  int components = img->metadata.channels;
-
-  /* Read pixels. */
-  vector<StorageType> pixels_storage;
-  StorageType *pixels;
-  const size_t max_size = max(max(width, height), depth);
-  if (max_size == 0) {
-    /* Don't bother with empty images. */
-    return false;
-  }
-
-  /* Allocate memory as needed, may be smaller to resize down. */
-  if (texture_limit > 0 && max_size > texture_limit) {
-    pixels_storage.resize(((size_t)width) * height * depth * 4);
-    pixels = &pixels_storage[0];
-  }
-  else {
-    thread_scoped_lock device_lock(device_mutex);
-    pixels = (StorageType *)img->mem->alloc(width, height, depth);
-  }
-
-  if (pixels == NULL) {
-    /* Could be that we've run out of memory. */
-    return false;
-  }
-
-  const size_t num_pixels = ((size_t)width) * height * depth;
-  img->loader->load_pixels(
-      img->metadata, pixels, num_pixels * components, image_associate_alpha(img));
+  return (img->metadata.type == IMAGE_DATA_TYPE_FLOAT4 ||
+          img->metadata.type == IMAGE_DATA_TYPE_HALF4 ||
+          img->metadata.type == IMAGE_DATA_TYPE_BYTE4 ||
+          img->metadata.type == IMAGE_DATA_TYPE_USHORT4);
+}
 
-  /* The kernel can handle 1 and 4 channel images. Anything that is not a single
-   * channel image is converted to RGBA format. */
-  bool is_rgba = (img->metadata.type == IMAGE_DATA_TYPE_FLOAT4 ||
-                  img->metadata.type == IMAGE_DATA_TYPE_HALF4 ||
-                  img->metadata.type == IMAGE_DATA_TYPE_BYTE4 ||
-                  img->metadata.type == IMAGE_DATA_TYPE_USHORT4);
+/* Convert pixels as read by the image loader to the layout and color space used by the
+ * kernel, in place. The buffer must have room for 4 channels per pixel for RGBA images. */
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+static void image_process_pixels(const ImageManager::Image *img,
+                                 StorageType *pixels,
+                                 const size_t num_pixels)
+{
+  const int components = img->metadata.channels;
+  const bool is_rgba = image_is_rgba(img);
 
   if (is_rgba) {
     const StorageType one = util_image_cast_from_float<StorageType>(1.0f);
@@ -604,6 +596,53 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
       }
     }
   }
+}
+
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+bool ImageManager::file_load_image(Image *img, int texture_limit)
+{
+  /* Ignore empty images. */
+  if (!(img->metadata.channels > 0)) {
+    return false;
+  }
+
+  /* Get metadata. */
+  int width = img->metadata.width;
+  int height = img->metadata.height;
+  int depth = img->metadata.depth;
+  int components = img->metadata.channels;
+
+  /* Read pixels. */
+  vector<StorageType> pixels_storage;
+  StorageType *pixels;
+  const size_t max_size = max(max(width, height), depth);
+  if (max_size == 0) {
+    /* Don't bother with empty images. */
+    return false;
+  }
+
+  /* Allocate memory as needed, may be smaller to resize down. */
+  if (texture_limit > 0 && max_size > texture_limit) {
+    pixels_storage.resize(((size_t)width) * height * depth * 4);
+    pixels = &pixels_storage[0];
+  }
+  else {
+    thread_scoped_lock device_lock(device_mutex);
+    pixels = (StorageType *)img->mem->alloc(width, height, depth);
+  }
+
+  if (pixels == NULL) {
+    /* Could be that we've run out of memory. */
+    return false;
+  }
+
+  const size_t num_pixels = ((size_t)width) * height * depth;
+  img->loader->load_pixels(
+      img->metadata, pixels, num_pixels * components, image_associate_alpha(img));
+
+  image_process_pixels<FileFormat, StorageType>(img, pixels, num_pixels);
+
+  const bool is_rgba = image_is_rgba(img);
 
   /* Scale image down if needed. */
   if (pixels_storage.size() > 0) {
@@ -636,9 +675,296 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
     memcpy(texture_pixels, &scaled_pixels[0], scaled_pixels.size() * sizeof(StorageType));
   }
 
+  disk_cache_write_image(img);
+
   return true;
 }
 
+bool ImageManager::use_texture_cache(Image *img) const
+{
+  if (!texture_cache || !img->loader->supports_tiles()) {
+    return false;
+  }
+
+  /* Only 2D images, volumes are always loaded fully. */
+  const ImageMetaData &metadata = img->metadata;
+  if (metadata.channels <= 0 || metadata.width == 0 || metadata.height == 0 ||
+      metadata.depth > 1) {
+    return false;
+  }
+
+  return !(metadata.type == IMAGE_DATA_TYPE_NANOVDB_FLOAT ||
+           metadata.type == IMAGE_DATA_TYPE_NANOVDB_FLOAT3);
+}
+
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+bool ImageManager::cache_load_tile(Image *img, int level, int x, int y, int w, int h, void *pixels)
+{
+  if (!img->loader->load_pixels_tile(
+          img->metadata, level, x, y, w, h, pixels, image_associate_alpha(img))) {
+    return false;
+  }
+
+  image_process_pixels<FileFormat, StorageType>(img, (StorageType *)pixels, ((size_t)w) * h);
+  return true;
+}
+
+void ImageManager::cache_load_image(Image *img, int texture_limit)
+{
+  TextureCacheImage::LoadTileFunc load_func;
+
+  switch (img->metadata.type) {
+    case IMAGE_DATA_TYPE_FLOAT4:
+    case IMAGE_DATA_TYPE_FLOAT:
+      load_func = function_bind(
+          &ImageManager::cache_load_tile<TypeDesc::FLOAT, float>, this, img, _1, _2, _3, _4, _5, _6);
+      break;
+    case IMAGE_DATA_TYPE_BYTE4:
+    case IMAGE_DATA_TYPE_BYTE:
+      load_func = function_bind(
+          &ImageManager::cache_load_tile<TypeDesc::UINT8, uchar>, this, img, _1, _2, _3, _4, _5, _6);
+      break;
+    case IMAGE_DATA_TYPE_HALF4:
+    case IMAGE_DATA_TYPE_HALF:
+      load_func = function_bind(
+          &ImageManager::cache_load_tile<TypeDesc::HALF, half>, this, img, _1, _2, _3, _4, _5, _6);
+      break;
+    case IMAGE_DATA_TYPE_USHORT4:
+    case IMAGE_DATA_TYPE_USHORT:
+      load_func = function_bind(&ImageManager::cache_load_tile<TypeDesc::USHORT, uint16_t>,
+                                this,
+                                img,
+                                _1,
+                                _2,
+                                _3,
+                                _4,
+                                _5,
+                                _6);
+      break;
+    case IMAGE_DATA_TYPE_NANOVDB_FLOAT:
+    case IMAGE_DATA_TYPE_NANOVDB_FLOAT3:
+    case IMAGE_DATA_NUM_TYPES:
+      assert(!"Image data type not supported by texture cache");
+      return;
+  }
+
+  /* The loader keeps the file open between tile loads, the cache closes it again to stay
+   * within its memory budget. */
+  TextureCacheImage::ReleaseFunc release_func = function_bind(&ImageLoader::cleanup,
+                                                              img->loader);
+
+  TextureCacheImage *cache_image = texture_cache->add_image(img->metadata.type,
+                                                            img->metadata.width,
+                                                            img->metadata.height,
+                                                            load_func,
+                                                            release_func);
+
+  /* Instead of resizing, limit the texture size by starting lookups at a smaller mipmap. */
+  if (texture_limit > 0) {
+    while (cache_image->base_level + 1 < cache_image->num_levels &&
+           (int)(max(img->metadata.width, img->metadata.height) >> cache_image->base_level) >
+               texture_limit) {
+      cache_image->base_level++;
+    }
+  }
+
+  const TextureCacheImage::Level &level = cache_image->get_level(cache_image->base_level);
+
+  VLOG(1) << "Using texture cache for image " << img->loader->name() << ", " << level.width
+          << "x" << level.height << " pixels.";
+
+  /* Allocate a single pixel so the texture slot exists on the device, the kernel reads the
+   * actual pixels through the cache. */
+  thread_scoped_lock device_lock(device_mutex);
+  img->mem->alloc(1, 1);
+  img->mem->info.width = level.width;
+  img->mem->info.height = level.height;
+  img->mem->info.use_cache = true;
+  img->mem->info.data = (uint64_t)cache_image;
+
+  img->cache_image = cache_image;
+}
+
+/* Texture Disk Cache
+ *
+ * Pixels are stored in the cache after conversion to the texture data layout, so following
+ * loads memory map the file instead of decoding and converting the image again. The CPU device
+ * reads textures directly from host memory, so pages are only read from disk when the kernel
+ * accesses them, and the operating system can drop them again under memory pressure. */
+
+/* Increase when the stored pixel processing changes, so that old cache files are no longer
+ * used. */
+#define IMAGE_DISK_CACHE_VERSION 1
+#define IMAGE_DISK_CACHE_MAGIC 0x58455443 /* "CTEX" */
+/* Total size of cache files, least recently used files are removed beyond it. */
+#define IMAGE_DISK_CACHE_MAX_SIZE (16ull * 1024 * 1024 * 1024)
+
+/* Padded to 64 bytes, so pixels following the header are aligned for SIMD access. */
+struct ImageDiskCacheHeader {
+  int magic;
+  int version;
+  int type;
+  int pad;
+  uint64_t width, height, depth;
+  uint64_t data_size;
+  uint64_t pad2[2];
+};
+
+static_assert(sizeof(ImageDiskCacheHeader) == 64, "ImageDiskCacheHeader size mismatch");
+
+string ImageManager::disk_cache_filepath(Image *img, int texture_limit) const
+{
+  /* Only images loaded from files, packed and generated images have no file to key on. */
+  const string filepath = img->loader->osl_filepath().string();
+  if (filepath.empty() || use_texture_cache(img)) {
+    return "";
+  }
+
+  const ImageMetaData &metadata = img->metadata;
+  if (metadata.channels <= 0 || metadata.type == IMAGE_DATA_TYPE_NANOVDB_FLOAT ||
+      metadata.type == IMAGE_DATA_TYPE_NANOVDB_FLOAT3) {
+    return "";
+  }
+
+  MD5Hash hash;
+  hash.append(string_printf("%d %s %llu %llu",
+                            IMAGE_DISK_CACHE_VERSION,
+                            filepath.c_str(),
+                            (unsigned long long)path_modified_time(filepath),
+                            (unsigned long long)path_file_size(filepath)));
+  hash.append(string_printf("%d %zu %zu %zu %d %s %d",
+                            (int)metadata.type,
+                            metadata.width,
+                            metadata.height,
+                            metadata.depth,
+                            metadata.channels,
+                            metadata.colorspace.c_str(),
+                            (int)metadata.compress_as_srgb));
+  hash.append(string_printf("%d %s %d %d",
+                            (int)img->params.alpha_type,
+                            img->params.colorspace.c_str(),
+                            (int)image_associate_alpha(img),
+                            texture_limit));
+  /* Color space conversion of pixels depends on the OpenColorIO configuration. */
+  hash.append(ColorSpaceManager::config_cache_id());
+
+  return path_cache_get(path_join("textures", "tex_" + hash.get_hex() + ".bin"));
+}
+
+bool ImageManager::disk_cache_load_image(Image *img)
+{
+  if (img->disk_cache_filepath.empty()) {
+    return false;
+  }
+
+  unique_ptr<MappedFile> mapped_file = make_unique<MappedFile>();
+  if (!mapped_file->open(img->disk_cache_filepath)) {
+    return false;
+  }
+
+  ImageDiskCacheHeader header;
+  if (mapped_file->size() < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, mapped_file->data(), sizeof(header));
+
+  const size_t pixel_size = datatype_size(img->mem->data_type) * img->mem->data_elements;
+  const size_t num_pixels = header.width * max(header.height, (uint64_t)1) *
+                            max(header.depth, (uint64_t)1);
+  if (header.magic != IMAGE_DISK_CACHE_MAGIC || header.version != IMAGE_DISK_CACHE_VERSION ||
+      header.type != (int)img->metadata.type || header.data_size != num_pixels * pixel_size ||
+      header.data_size != mapped_file->size() - sizeof(header)) {
+    VLOG(1) << "Invalid texture cache file " << img->disk_cache_filepath << ", ignoring.";
+    return false;
+  }
+
+  {
+    thread_scoped_lock device_lock(device_mutex);
+    img->mem->alloc_external(
+        (void *)(mapped_file->data() + sizeof(header)), header.width, header.height, header.depth);
+  }
+  img->mapped_file = std::move(mapped_file);
+
+  /* Mark as recently used, so that it is the last to be removed when trimming the cache. */
+  path_touch(img->disk_cache_filepath);
+
+  VLOG(1) << "Memory mapped image " << img->loader->name() << " from texture cache "
+          << img->disk_cache_filepath << ".";
+  return true;
+}
+
+void ImageManager::disk_cache_write_image(Image *img)
+{
+  if (img->disk_cache_filepath.empty()) {
+    return;
+  }
+
+  const string &filepath = img->disk_cache_filepath;
+
+  ImageDiskCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = IMAGE_DISK_CACHE_MAGIC;
+  header.version = IMAGE_DISK_CACHE_VERSION;
+  header.type = (int)img->metadata.type;
+  header.width = img->mem->data_width;
+  header.height = img->mem->data_height;
+  header.depth = img->mem->data_depth;
+  header.data_size = img->mem->memory_size();
+
+  /* Write to a temporary file first, so that other threads or processes never see a partially
+   * written file. The same image may be used with identical settings by another session. */
+  static thread_mutex counter_mutex;
+  static int counter = 0;
+  string temp_filepath;
+  {
+    thread_scoped_lock lock(counter_mutex);
+    temp_filepath = string_printf(
+        "%s.%d.%d.tmp", filepath.c_str(), (int)system_self_process_id(), counter++);
+  }
+
+  path_create_directories(temp_filepath);
+  FILE *f = path_fopen(temp_filepath, "wb");
+  if (!f) {
+    VLOG(1) << "Failed to write texture cache file " << filepath << ".";
+    return;
+  }
+
+  const bool written = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                       fwrite(img->mem->host_pointer, 1, header.data_size, f) ==
+                           header.data_size;
+  fclose(f);
+
+  if (!written) {
+    VLOG(1) << "Failed to write texture cache file " << filepath << ".";
+    path_remove(temp_filepath);
+    return;
+  }
+
+  if (!path_rename(temp_filepath, filepath)) {
+    /* File may already exist on platforms where rename does not replace it. */
+    path_remove(temp_filepath);
+    if (!path_exists(filepath)) {
+      return;
+    }
+  }
+
+  VLOG(2) << "Wrote image " << img->loader->name() << " to texture cache " << filepath << ", "
+          << string_human_readable_size(header.data_size) << ".";
+
+  /* Keep the cache size bounded. Only one thread scans the directory at a time, others skip it
+   * since the cache will be trimmed again after the next write anyway. Files that are still
+   * memory mapped remain valid after removal on Linux and macOS, on Windows removal fails. */
+  static thread_mutex trim_mutex;
+  thread_scoped_lock trim_lock(trim_mutex, std::try_to_lock);
+  if (trim_lock.owns_lock()) {
+    path_cache_trim(path_dirname(filepath), IMAGE_DISK_CACHE_MAX_SIZE);
+  }
+
+  /* Replace the decoded pixels with the memory mapped file, so memory is backed by the file
+   * from the first render on. */
+  disk_cache_load_image(img);
+}
+
 void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Progress *progress)
 {
   if (progress->get_cancel()) {
@@ -663,14 +989,30 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     delete img->mem;
     img->mem = NULL;
   }
+  if (img->cache_image) {
+    texture_cache->remove_image(img->cache_image);
+    img->cache_image = NULL;
+  }
+  img->mapped_file.reset();
 
   img->mem = new device_texture(
       device, img->mem_name.c_str(), slot, type, img->params.interpolation, img->params.extension);
   img->mem->info.use_transform_3d = img->metadata.use_transform_3d;
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
+  img->disk_cache_filepath = (scene->params.use_texture_disk_cache &&
+                              device->info.type == DEVICE_CPU) ?
+                                 disk_cache_filepath(img, texture_limit) :
+                                 "";
+
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (use_texture_cache(img)) {
+    cache_load_image(img, texture_limit);
+  }
+  else if (disk_cache_load_image(img)) {
+    /* Pixels are memory mapped from the disk cache. */
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -770,8 +1112,10 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     img->mem->copy_to_device();
   }
 
-  /* Cleanup memory in image loader. */
-  img->loader->cleanup();
+  /* Cleanup memory in image loader, unless it is still needed to load tiles. */
+  if (!img->cache_image) {
+    img->loader->cleanup();
+  }
   img->need_load = false;
 }
 
@@ -796,6 +1140,10 @@ void ImageManager::device_free_image(Device *, int slot)
     delete img->mem;
   }
 
+  if (img->cache_image) {
+    texture_cache->remove_image(img->cache_image);
+  }
+
   delete img->loader;
   delete img;
   images[slot] = NULL;
@@ -813,6 +1161,16 @@ void ImageManager::device_update(Device *device, Scene *scene, Progress &progres
     }
   });
 
+  if (scene->params.use_texture_cache && device->info.type == DEVICE_CPU) {
+    const size_t memory_budget = ((size_t)scene->params.texture_cache_size) * 1024 * 1024;
+    if (!texture_cache) {
+      texture_cache.reset(new TextureCache(memory_budget));
+    }
+    else {
+      texture_cache->set_memory_budget(memory_budget);
+    }
+  }
+
   TaskPool pool;
   for (size_t slot = 0; slot < images.size(); slot++) {
     Image *img = images[slot];
@@ -879,6 +1237,7 @@ void ImageManager::device_free(Device *device)
     device_free_image(device, slot);
   }
   images.clear();
+  texture_cache.reset();
 }
 
 void ImageManager::collect_statistics(RenderStats *stats)
@@ -887,6 +1246,23 @@ void ImageManager::collect_statistics(RenderStats *stats)
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
   }
+
+  if (texture_cache) {
+    const TextureCache::Stats cache_stats = texture_cache->get_stats();
+    stats->image.has_texture_cache = true;
+    stats->image.texture_cache_budget = texture_cache->get_memory_budget();
+    stats->image.texture_cache_peak = cache_stats.mem_peak;
+    stats->image.texture_cache_tiles_loaded = cache_stats.tiles_loaded;
+    stats->image.texture_cache_tiles_evicted = cache_stats.tiles_evicted;
+  }
+
+  foreach (const Image *image, images) {
+    if (image && image->mapped_file) {
+      stats->image.has_texture_disk_cache = true;
+      stats->image.texture_disk_cache_mapped += image->mapped_file->size();
+      stats->image.texture_disk_cache_resident += image->mapped_file->resident_size();
+    }
+  }
 }
 
 void ImageManager::tag_update()
@@ -21,6 +21,7 @@
 
 #include "scene/colorspace.h"
 
+#include "util/mapped_file.h"
 #include "util/string.h"
 #include "util/thread.h"
 #include "util/transform.h"
@@ -39,6 +40,8 @@ class Progress;
 class RenderStats;
 class Scene;
 class ColorSpaceProcessor;
+class TextureCache;
+class TextureCacheImage;
 class VDBImageLoader;
 
 /* Image Parameters */
@@ -119,6 +122,19 @@ class ImageLoader {
                            const size_t pixels_size,
                            const bool associate_alpha) = 0;
 
+  /* Optional for the texture cache, load a region of the image at the given mipmap level.
+   * Rows are stored bottom to top like load_pixels(), and with at most 4 channels. May return
+   * false for levels above 0, which are then generated by downsampling. */
+  virtual bool supports_tiles() const;
+  virtual bool load_pixels_tile(const ImageMetaData &metadata,
+                                const int level,
+                                const int x,
+                                const int y,
+                                const int w,
+                                const int h,
+                                void *pixels,
+                                const bool associate_alpha);
+
   /* Name for logs and stats. */
   virtual string name() const = 0;
 
@@ -212,6 +228,13 @@ class ImageManager {
     string mem_name;
     device_texture *mem;
 
+    /* Set when pixels are loaded on demand through the texture cache. */
+    TextureCacheImage *cache_image;
+
+    /* Set when pixels are memory mapped from the texture disk cache. */
+    string disk_cache_filepath;
+    unique_ptr<MappedFile> mapped_file;
+
     int users;
     thread_mutex mutex;
   };
@@ -228,6 +251,8 @@ class ImageManager {
   vector<Image *> images;
   void *osl_texture_system;
 
+  unique_ptr<TextureCache> texture_cache;
+
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
   void remove_image_user(int slot);
@@ -237,6 +262,15 @@ class ImageManager {
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
 
+  bool use_texture_cache(Image *img) const;
+  void cache_load_image(Image *img, int texture_limit);
+  template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+  bool cache_load_tile(Image *img, int level, int x, int y, int w, int h, void *pixels);
+
+  string disk_cache_filepath(Image *img, int texture_limit) const;
+  bool disk_cache_load_image(Image *img);
+  void disk_cache_write_image(Image *img);
+
   void device_load_image(Device *device, Scene *scene, int slot, Progress *progress);
   void device_free_image(Device *device, int slot);
 
@@ -22,7 +22,12 @@
 
 CCL_NAMESPACE_BEGIN
 
-OIIOImageLoader::OIIOImageLoader(const string &filepath) : filepath(filepath)
+OIIOImageLoader::OIIOImageLoader(const string &filepath)
+    : filepath(filepath),
+      tile_input_associate_alpha(false),
+      strip_level(-1),
+      strip_y(0),
+      strip_height(0)
 {
 }
 
@@ -220,6 +225,155 @@ bool OIIOImageLoader::load_pixels(const ImageMetaData &metadata,
   return true;
 }
 
+bool OIIOImageLoader::supports_tiles() const
+{
+  return true;
+}
+
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+bool OIIOImageLoader::load_tile_pixels(const ImageMetaData &metadata,
+                                       const int level,
+                                       const int x,
+                                       const int y,
+                                       const int w,
+                                       const int h,
+                                       StorageType *pixels)
+{
+  /* Only use mipmap levels stored in the file when they match the expected resolution,
+   * others are generated by the texture cache. */
+  const ImageSpec spec = tile_input->spec_dimensions(0, level);
+  if (spec.width != max((int)metadata.width >> level, 1) ||
+      spec.height != max((int)metadata.height >> level, 1)) {
+    return false;
+  }
+
+  const int components = min(metadata.channels, 4);
+  const size_t row_size = ((size_t)spec.width) * components;
+
+  /* Rows are stored bottom to top, while files are read top to bottom. */
+  const int ybegin = spec.height - (y + h);
+
+  if (strip_level != level || strip_y != ybegin || strip_height != h) {
+    strip_pixels.resize(row_size * h * sizeof(StorageType));
+    if (!tile_input->read_scanlines(0,
+                                    level,
+                                    spec.y + ybegin,
+                                    spec.y + ybegin + h,
+                                    spec.z,
+                                    0,
+                                    components,
+                                    FileFormat,
+                                    strip_pixels.data())) {
+      strip_level = -1;
+      return false;
+    }
+    strip_level = level;
+    strip_y = ybegin;
+    strip_height = h;
+  }
+
+  const StorageType *strip = (const StorageType *)strip_pixels.data();
+  for (int row = 0; row < h; row++) {
+    const StorageType *src = strip + (h - 1 - row) * row_size + ((size_t)x) * components;
+    memcpy(pixels + ((size_t)row) * w * components, src, sizeof(StorageType) * w * components);
+  }
+
+  /* CMYK to RGBA. */
+  const bool cmyk = strcmp(tile_input->format_name(), "jpeg") == 0 && components == 4;
+  if (cmyk) {
+    const StorageType one = util_image_cast_from_float<StorageType>(1.0f);
+
+    const size_t num_pixels = ((size_t)w) * h;
+    for (size_t i = 0; i < num_pixels; i++) {
+      float c = util_image_cast_to_float(pixels[i * 4 + 0]);
+      float m = util_image_cast_to_float(pixels[i * 4 + 1]);
+      float y = util_image_cast_to_float(pixels[i * 4 + 2]);
+      float k = util_image_cast_to_float(pixels[i * 4 + 3]);
+      pixels[i * 4 + 0] = util_image_cast_from_float<StorageType>((1.0f - c) * (1.0f - k));
+      pixels[i * 4 + 1] = util_image_cast_from_float<StorageType>((1.0f - m) * (1.0f - k));
+      pixels[i * 4 + 2] = util_image_cast_from_float<StorageType>((1.0f - y) * (1.0f - k));
+      pixels[i * 4 + 3] = one;
+    }
+  }
+
+  return true;
+}
+
+bool OIIOImageLoader::load_pixels_tile(const ImageMetaData &metadata,
+                                       const int level,
+                                       const int x,
+                                       const int y,
+                                       const int w,
+                                       const int h,
+                                       void *pixels,
+                                       const bool associate_alpha)
+{
+  thread_scoped_lock lock(tile_mutex);
+
+  if (!tile_input || tile_input_associate_alpha != associate_alpha) {
+    tile_input.reset();
+    strip_level = -1;
+
+    /* NOTE: Error logging is done in meta data acquisition. */
+    if (!path_exists(filepath.string()) || path_is_directory(filepath.string())) {
+      return false;
+    }
+
+    unique_ptr<ImageInput> in(ImageInput::create(filepath.string()));
+    if (!in) {
+      return false;
+    }
+
+    ImageSpec spec = ImageSpec();
+    ImageSpec config = ImageSpec();
+
+    if (!associate_alpha) {
+      config.attribute("oiio:UnassociatedAlpha", 1);
+    }
+
+    if (!in->open(filepath.string(), spec, config)) {
+      return false;
+    }
+
+    tile_input = std::move(in);
+    tile_input_associate_alpha = associate_alpha;
+  }
+
+  switch (metadata.type) {
+    case IMAGE_DATA_TYPE_BYTE:
+    case IMAGE_DATA_TYPE_BYTE4:
+      return load_tile_pixels<TypeDesc::UINT8, uchar>(metadata, level, x, y, w, h, (uchar *)pixels);
+    case IMAGE_DATA_TYPE_USHORT:
+    case IMAGE_DATA_TYPE_USHORT4:
+      return load_tile_pixels<TypeDesc::USHORT, uint16_t>(
+          metadata, level, x, y, w, h, (uint16_t *)pixels);
+    case IMAGE_DATA_TYPE_HALF:
+    case IMAGE_DATA_TYPE_HALF4:
+      return load_tile_pixels<TypeDesc::HALF, half>(metadata, level, x, y, w, h, (half *)pixels);
+    case IMAGE_DATA_TYPE_FLOAT:
+    case IMAGE_DATA_TYPE_FLOAT4:
+      return load_tile_pixels<TypeDesc::FLOAT, float>(metadata, level, x, y, w, h, (float *)pixels);
+    case IMAGE_DATA_TYPE_NANOVDB_FLOAT:
+    case IMAGE_DATA_TYPE_NANOVDB_FLOAT3:
+    case IMAGE_DATA_NUM_TYPES:
+      break;
+  }
+
+  return false;
+}
+
+void OIIOImageLoader::cleanup()
+{
+  thread_scoped_lock lock(tile_mutex);
+  if (tile_input) {
+    tile_input->close();
+    tile_input.reset();
+  }
+  strip_pixels.clear();
+  strip_pixels.shrink_to_fit();
+  strip_level = -1;
+}
+
 string OIIOImageLoader::name() const
 {
   return path_filename(filepath.string());
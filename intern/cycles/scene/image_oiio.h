@@ -19,6 +19,8 @@
 
 #include "scene/image.h"
 
+#include "util/image.h"
+
 CCL_NAMESPACE_BEGIN
 
 class OIIOImageLoader : public ImageLoader {
@@ -33,14 +35,46 @@ class OIIOImageLoader : public ImageLoader {
                    const size_t pixels_size,
                    const bool associate_alpha) override;
 
+  bool supports_tiles() const override;
+  bool load_pixels_tile(const ImageMetaData &metadata,
+                        const int level,
+                        const int x,
+                        const int y,
+                        const int w,
+                        const int h,
+                        void *pixels,
+                        const bool associate_alpha) override;
+
   string name() const override;
 
   ustring osl_filepath() const override;
 
   bool equals(const ImageLoader &other) const override;
 
+  void cleanup() override;
+
  protected:
   ustring filepath;
+
+  /* File kept open for reading tiles on demand. Files are read in strips of full width rows,
+   * so that neighboring tiles do not decode the same scanlines again. */
+  unique_ptr<ImageInput> tile_input;
+  bool tile_input_associate_alpha;
+  thread_mutex tile_mutex;
+
+  vector<uchar> strip_pixels;
+  int strip_level;
+  int strip_y;
+  int strip_height;
+
+  template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+  bool load_tile_pixels(const ImageMetaData &metadata,
+                        const int level,
+                        const int x,
+                        const int y,
+                        const int w,
+                        const int h,
+                        StorageType *pixels);
 };
 
 CCL_NAMESPACE_END
@@ -98,6 +98,10 @@ NODE_DEFINE(Integrator)
   SOCKET_INT(adaptive_min_samples, "Adaptive Min Samples", 0);
 
   SOCKET_FLOAT(light_sampling_threshold, "Light Sampling Threshold", 0.05f);
+  SOCKET_BOOLEAN(use_light_tree, "Use Light Tree", false);
+
+  SOCKET_BOOLEAN(use_guiding, "Use Guiding", false);
+  SOCKET_FLOAT(guiding_probability, "Guiding Probability", 0.5f);
 
   static NodeEnum sampling_pattern_enum;
   sampling_pattern_enum.insert("sobol", SAMPLING_PATTERN_SOBOL);
@@ -290,6 +294,45 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
 
   kintegrator->has_shadow_catcher = scene->has_shadow_catcher();
 
+  /* Path guiding. The learned field is only valid for the scene it was trained on, so it is
+   * reset when guiding gets enabled or objects change. Probability of sampling the BSDF is kept
+   * above zero to cover directions the field has not seen yet. */
+  const bool use_guiding_on_device = use_guiding && device->info.type == DEVICE_CPU;
+  kintegrator->use_guiding = use_guiding_on_device;
+  kintegrator->guiding_probability = clamp(guiding_probability, 0.0f, 0.95f);
+
+  if (use_guiding_on_device &&
+      (use_guiding_is_modified() || dscene->guiding_field.size() == 0)) {
+    BoundBox bounds = BoundBox::empty;
+    foreach (Object *object, scene->objects) {
+      if (object->bounds.valid()) {
+        bounds.grow(object->bounds);
+      }
+    }
+    if (!bounds.valid()) {
+      bounds = BoundBox(zero_float3(), one_float3());
+    }
+
+    const float3 size = max(bounds.size(), make_float3(1e-4f, 1e-4f, 1e-4f));
+    for (int i = 0; i < 3; i++) {
+      kintegrator->guiding_bounds_min[i] = bounds.min[i];
+      kintegrator->guiding_bounds_inv_size[i] = 1.0f / size[i];
+    }
+
+    const size_t guiding_size = GUIDING_GRID_CELLS * GUIDING_BINS;
+    float *field = dscene->guiding_field.alloc(guiding_size);
+    float *training = dscene->guiding_training.alloc(guiding_size);
+    memset(field, 0, sizeof(float) * guiding_size);
+    memset(training, 0, sizeof(float) * guiding_size);
+
+    dscene->guiding_field.copy_to_device();
+    dscene->guiding_training.copy_to_device();
+  }
+  else if (!use_guiding_on_device) {
+    dscene->guiding_field.free();
+    dscene->guiding_training.free();
+  }
+
   dscene->sample_pattern_lut.clear_modified();
   clear_modified();
 }
@@ -297,6 +340,8 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
 void Integrator::device_free(Device *, DeviceScene *dscene, bool force_free)
 {
   dscene->sample_pattern_lut.free_if_need_realloc(force_free);
+  dscene->guiding_field.free_if_need_realloc(force_free);
+  dscene->guiding_training.free_if_need_realloc(force_free);
 }
 
 void Integrator::tag_update(Scene *scene, uint32_t flag)
@@ -324,6 +369,15 @@ void Integrator::tag_update(Scene *scene, uint32_t flag)
     scene->object_manager->tag_update(scene, ObjectManager::MOTION_BLUR_MODIFIED);
     scene->camera->tag_modified();
   }
+
+  if (use_light_tree_is_modified()) {
+    scene->light_manager->tag_update(scene, LightManager::UPDATE_ALL);
+  }
+
+  if ((flag & OBJECT_MANAGER) && use_guiding) {
+    /* The guiding grid is fitted to the object bounds, so refit and retrain it. */
+    tag_use_guiding_modified();
+  }
 }
 
 uint Integrator::get_kernel_features() const
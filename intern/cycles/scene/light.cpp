@@ -20,6 +20,7 @@
 #include "scene/film.h"
 #include "scene/integrator.h"
 #include "scene/light.h"
+#include "scene/light_tree.h"
 #include "scene/mesh.h"
 #include "scene/object.h"
 #include "scene/scene.h"
@@ -33,6 +34,7 @@
 #include "util/foreach.h"
 #include "util/hash.h"
 #include "util/log.h"
+#include "util/map.h"
 #include "util/path.h"
 #include "util/progress.h"
 #include "util/task.h"
@@ -527,6 +529,295 @@ void LightManager::device_update_distribution(Device *,
   }
 }
 
+static KernelLightTreeEmitter light_tree_emitter(const float3 &centroid,
+                                                 float radius,
+                                                 float energy,
+                                                 const OrientationBounds &bcone,
+                                                 float distribution_pdf,
+                                                 int distribution_index)
+{
+  KernelLightTreeEmitter emitter;
+  emitter.centroid[0] = centroid.x;
+  emitter.centroid[1] = centroid.y;
+  emitter.centroid[2] = centroid.z;
+  emitter.energy = energy;
+  emitter.axis[0] = bcone.axis.x;
+  emitter.axis[1] = bcone.axis.y;
+  emitter.axis[2] = bcone.axis.z;
+  emitter.theta_o = bcone.theta_o;
+  emitter.radius = radius;
+  emitter.theta_e = bcone.theta_e;
+  emitter.distribution_pdf = distribution_pdf;
+  emitter.distribution_index = distribution_index;
+  emitter.leaf_index = -1;
+  emitter.pad1 = emitter.pad2 = emitter.pad3 = 0;
+  return emitter;
+}
+
+void LightManager::device_update_tree(Device *,
+                                      DeviceScene *dscene,
+                                      Scene *scene,
+                                      Progress &progress)
+{
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  kintegrator->use_light_tree = false;
+  kintegrator->num_light_tree_emitters = 0;
+  kintegrator->num_light_tree_distant = 0;
+  kintegrator->light_tree_distant_energy = 0.0f;
+  kintegrator->light_tree_background_emitter = -1;
+
+  if (!kintegrator->use_direct_light || !scene->integrator->get_use_light_tree()) {
+    return;
+  }
+
+  progress.set_status("Updating Lights", "Building light tree");
+
+  /* Emitters in the order of the light distribution, with the lights which are not part of the
+   * tree marked as distant. Lights and triangles without energy are left out, the tree never
+   * selects them. */
+  vector<KernelLightTreeEmitter> emitters;
+  vector<bool> emitter_is_distant;
+  vector<LightTreePrimitive> prims;
+
+  /* Maps lamps and triangles to emitters, see __light_tree_emitter_index. */
+  const int num_lamps = kintegrator->num_all_lights;
+  vector<int> emitter_index(num_lamps + 2 * scene->objects.size(), -1);
+
+  int distribution_index = 0;
+
+  /* Triangles. */
+  unordered_map<Shader *, float> shader_energy;
+  int object_id = 0;
+
+  foreach (Object *object, scene->objects) {
+    if (progress.get_cancel())
+      return;
+
+    if (!object_usable_as_light(object)) {
+      object_id++;
+      continue;
+    }
+
+    Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
+    bool transform_applied = mesh->transform_applied;
+    Transform tfm = object->get_tfm();
+    int table_offset = -1;
+
+    size_t mesh_num_triangles = mesh->num_triangles();
+    for (size_t i = 0; i < mesh_num_triangles; i++) {
+      int shader_index = mesh->get_shader()[i];
+      Shader *shader = (shader_index < mesh->get_used_shaders().size()) ?
+                           static_cast<Shader *>(mesh->get_used_shaders()[shader_index]) :
+                           scene->default_surface;
+
+      if (!(shader->get_use_mis() && shader->has_surface_emission)) {
+        continue;
+      }
+
+      const int index = distribution_index++;
+
+      if (table_offset == -1) {
+        table_offset = emitter_index.size();
+        emitter_index[num_lamps + 2 * object_id] = table_offset;
+        emitter_index[num_lamps + 2 * object_id + 1] = mesh->prim_offset;
+        emitter_index.resize(table_offset + mesh_num_triangles, -1);
+      }
+
+      Mesh::Triangle t = mesh->get_triangle(i);
+      if (!t.valid(&mesh->get_verts()[0])) {
+        continue;
+      }
+      float3 p1 = mesh->get_verts()[t.v[0]];
+      float3 p2 = mesh->get_verts()[t.v[1]];
+      float3 p3 = mesh->get_verts()[t.v[2]];
+
+      if (!transform_applied) {
+        p1 = transform_point(&tfm, p1);
+        p2 = transform_point(&tfm, p2);
+        p3 = transform_point(&tfm, p3);
+      }
+
+      /* Textured emission is estimated by its area only. */
+      auto it = shader_energy.find(shader);
+      if (it == shader_energy.end()) {
+        float3 emission;
+        const float energy = (shader->is_constant_emission(&emission)) ?
+                                 average(fabs(emission)) :
+                                 1.0f;
+        it = shader_energy.insert({shader, energy}).first;
+      }
+
+      const float area = triangle_area(p1, p2, p3);
+      const float energy = it->second * area * M_1_PI_F;
+      if (!(energy > 0.0f)) {
+        continue;
+      }
+
+      const float3 centroid = (p1 + p2 + p3) * (1.0f / 3.0f);
+      const float radius = sqrtf(max(len_squared(p1 - centroid),
+                                     max(len_squared(p2 - centroid), len_squared(p3 - centroid))));
+
+      /* Mesh lights emit on both sides. */
+      const OrientationBounds bcone(safe_normalize(cross(p2 - p1, p3 - p1)), M_PI_F, M_PI_2_F);
+
+      LightTreePrimitive prim;
+      prim.bbox.grow(p1);
+      prim.bbox.grow(p2);
+      prim.bbox.grow(p3);
+      prim.centroid = centroid;
+      prim.bcone = bcone;
+      prim.energy = energy;
+      prim.index = emitters.size();
+      prims.push_back(prim);
+
+      emitter_index[table_offset + i] = emitters.size();
+      emitters.push_back(light_tree_emitter(
+          centroid, radius, energy, bcone, area * kintegrator->pdf_triangles, index));
+      emitter_is_distant.push_back(false);
+    }
+
+    object_id++;
+  }
+
+  /* Lamps, in the same order as the light distribution and the lights on the device. */
+  int light_index = 0;
+  float distant_energy = 0.0f;
+  int num_distant = 0;
+  int background_emitter = -1;
+
+  foreach (Light *light, scene->lights) {
+    if (!light->is_enabled)
+      continue;
+
+    const int index = distribution_index++;
+    const float strength = average(fabs(light->strength));
+
+    float energy = 0.0f;
+    float radius = 0.0f;
+    OrientationBounds bcone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+    bool is_distant = false;
+
+    if (light->light_type == LIGHT_POINT) {
+      energy = strength * M_1_PI_F * 0.25f;
+      radius = light->size;
+    }
+    else if (light->light_type == LIGHT_SPOT) {
+      energy = strength * M_1_PI_F * 0.25f;
+      radius = light->size;
+      bcone = OrientationBounds(safe_normalize(light->dir), 0.0f, light->spot_angle * 0.5f);
+    }
+    else if (light->light_type == LIGHT_AREA) {
+      const float3 axisu = light->axisu * (light->sizeu * light->size);
+      const float3 axisv = light->axisv * (light->sizev * light->size);
+      energy = strength * 0.25f;
+      radius = 0.5f * sqrtf(len_squared(axisu) + len_squared(axisv));
+      bcone = OrientationBounds(safe_normalize(light->dir), 0.0f, M_PI_2_F);
+    }
+    else if (light->light_type == LIGHT_DISTANT) {
+      energy = strength;
+      is_distant = true;
+    }
+    else if (light->light_type == LIGHT_BACKGROUND) {
+      Shader *shader = scene->background->get_shader(scene);
+      float3 emission;
+      energy = M_PI_F * strength *
+               ((shader && shader->is_constant_emission(&emission)) ? average(fabs(emission)) :
+                                                                     1.0f);
+      is_distant = true;
+    }
+
+    if (energy > 0.0f) {
+      emitter_index[light_index] = emitters.size();
+      emitters.push_back(light_tree_emitter(
+          light->co, radius, energy, bcone, kintegrator->pdf_lights, index));
+      emitter_is_distant.push_back(is_distant);
+
+      if (light->light_type == LIGHT_BACKGROUND) {
+        background_emitter = emitters.size() - 1;
+      }
+
+      if (is_distant) {
+        distant_energy += energy;
+        num_distant++;
+      }
+      else {
+        LightTreePrimitive prim;
+        prim.bbox.grow(light->co, radius);
+        prim.centroid = light->co;
+        prim.bcone = bcone;
+        prim.energy = energy;
+        prim.index = emitters.size() - 1;
+        prims.push_back(prim);
+      }
+    }
+
+    light_index++;
+  }
+
+  if (emitters.empty()) {
+    VLOG(1) << "No emitters with energy, using light distribution instead of light tree.";
+    return;
+  }
+
+  if (progress.get_cancel())
+    return;
+
+  /* Build tree, which reorders the primitives. */
+  LightTree tree(prims, LIGHT_TREE_MAX_LEAF_SIZE);
+  const vector<KernelLightTreeNode> &tree_nodes = tree.get_nodes();
+
+  /* Emitters of the tree in leaf order, followed by the distant lights. */
+  vector<int> emitter_remap(emitters.size());
+  KernelLightTreeEmitter *kemitters = dscene->light_tree_emitters.alloc(emitters.size());
+  int num_emitters = 0;
+
+  foreach (const LightTreePrimitive &prim, prims) {
+    emitter_remap[prim.index] = num_emitters;
+    kemitters[num_emitters++] = emitters[prim.index];
+  }
+  for (size_t i = 0; i < emitters.size(); i++) {
+    if (emitter_is_distant[i]) {
+      emitter_remap[i] = num_emitters;
+      kemitters[num_emitters++] = emitters[i];
+    }
+  }
+
+  for (int i = 0; i < tree_nodes.size(); i++) {
+    const KernelLightTreeNode &node = tree_nodes[i];
+    for (int j = 0; j < node.num_emitters; j++) {
+      kemitters[node.child_index + j].leaf_index = i;
+    }
+  }
+
+  /* Emitter indices, skipping the object to table offset mapping. */
+  int *kemitter_index = dscene->light_tree_emitter_index.alloc(emitter_index.size());
+  for (size_t i = 0; i < emitter_index.size(); i++) {
+    const bool is_object_entry = (i >= num_lamps && i < num_lamps + 2 * scene->objects.size());
+    kemitter_index[i] = (is_object_entry || emitter_index[i] == -1) ?
+                            emitter_index[i] :
+                            emitter_remap[emitter_index[i]];
+  }
+
+  if (!tree_nodes.empty()) {
+    KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(tree_nodes.size());
+    std::copy(tree_nodes.begin(), tree_nodes.end(), knodes);
+    dscene->light_tree_nodes.copy_to_device();
+  }
+  dscene->light_tree_emitters.copy_to_device();
+  dscene->light_tree_emitter_index.copy_to_device();
+
+  kintegrator->use_light_tree = true;
+  kintegrator->num_light_tree_emitters = prims.size();
+  kintegrator->num_light_tree_distant = num_distant;
+  kintegrator->light_tree_distant_energy = distant_energy;
+  if (background_emitter != -1) {
+    kintegrator->light_tree_background_emitter = emitter_remap[background_emitter];
+  }
+
+  VLOG(1) << "Light tree with " << tree_nodes.size() << " nodes, " << prims.size()
+          << " emitters and " << num_distant << " distant lights.";
+}
+
 static void background_cdf(
     int start, int end, int res_x, int res_y, const vector<float3> *pixels, float2 *cond_cdf)
 {
@@ -992,6 +1283,10 @@ void LightManager::device_update(Device *device,
   if (progress.get_cancel())
     return;
 
+  device_update_tree(device, dscene, scene, progress);
+  if (progress.get_cancel())
+    return;
+
   if (need_update_background) {
     device_update_background(device, dscene, scene, progress);
     if (progress.get_cancel())
@@ -1010,6 +1305,9 @@ void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_ba
 {
   dscene->light_distribution.free();
   dscene->lights.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_emitters.free();
+  dscene->light_tree_emitter_index.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
     dscene->light_background_conditional_cdf.free();
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scene/light_tree.h"
+
+#include "util/math.h"
+
+#include <algorithm>
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of buckets the centroid bounds are split into when searching for the best split. */
+static const int LIGHT_TREE_NUM_BUCKETS = 12;
+
+/* Orientation Bounds */
+
+float OrientationBounds::measure() const
+{
+  const float theta_w = fminf(theta_o + theta_e, M_PI_F);
+  const float sin_theta_o = sinf(theta_o);
+  const float cos_theta_o = cosf(theta_o);
+
+  return M_2PI_F * (1.0f - cos_theta_o) +
+         M_PI_2_F * (2.0f * theta_w * sin_theta_o - cosf(theta_o - 2.0f * theta_w) -
+                     2.0f * theta_o * sin_theta_o + cos_theta_o);
+}
+
+OrientationBounds merge(const OrientationBounds &a, const OrientationBounds &b)
+{
+  if (a.is_empty()) {
+    return b;
+  }
+  if (b.is_empty()) {
+    return a;
+  }
+
+  /* Grow the wider cone until it contains the narrower one. */
+  const OrientationBounds &wide = (a.theta_o >= b.theta_o) ? a : b;
+  const OrientationBounds &narrow = (a.theta_o >= b.theta_o) ? b : a;
+
+  const float theta_d = safe_acosf(dot(wide.axis, narrow.axis));
+  const float theta_e = fmaxf(a.theta_e, b.theta_e);
+
+  if (fminf(theta_d + narrow.theta_o, M_PI_F) <= wide.theta_o) {
+    return OrientationBounds(wide.axis, wide.theta_o, theta_e);
+  }
+
+  const float theta_o = 0.5f * (wide.theta_o + theta_d + narrow.theta_o);
+  if (theta_o >= M_PI_F) {
+    return OrientationBounds(wide.axis, M_PI_F, theta_e);
+  }
+
+  /* Rotate the axis of the wider cone towards the narrower one. Opposite axes have no unique
+   * rotation, fall back to the full sphere. */
+  const float3 rotation_axis = cross(wide.axis, narrow.axis);
+  if (len_squared(rotation_axis) < 1e-12f) {
+    return OrientationBounds(wide.axis, M_PI_F, theta_e);
+  }
+
+  const float3 axis = rotate_around_axis(
+      wide.axis, normalize(rotation_axis), theta_o - wide.theta_o);
+  return OrientationBounds(normalize(axis), theta_o, theta_e);
+}
+
+/* Light Tree */
+
+namespace {
+
+struct LightTreeBucket {
+  BoundBox bbox = BoundBox::empty;
+  OrientationBounds bcone;
+  float energy = 0.0f;
+  int count = 0;
+
+  void add(const BoundBox &other_bbox,
+           const OrientationBounds &other_bcone,
+           float other_energy,
+           int other_count)
+  {
+    bbox.grow(other_bbox);
+    bcone = merge(bcone, other_bcone);
+    energy += other_energy;
+    count += other_count;
+  }
+
+  void add(const LightTreeBucket &other)
+  {
+    add(other.bbox, other.bcone, other.energy, other.count);
+  }
+
+  /* Surface area orientation heuristic, without the normalization by the parent node which is
+   * the same for all splits. */
+  float cost() const
+  {
+    return energy * bcone.measure() * bbox.safe_area();
+  }
+};
+
+}  // namespace
+
+LightTree::LightTree(vector<LightTreePrimitive> &prims, int max_leaf_size)
+    : prims_(prims), max_leaf_size_(max(max_leaf_size, 1))
+{
+  if (prims_.empty()) {
+    return;
+  }
+
+  nodes_.reserve(2 * prims_.size());
+  build(0, prims_.size(), -1);
+}
+
+int LightTree::build(int start, int end, int parent_index)
+{
+  BoundBox bbox = BoundBox::empty;
+  BoundBox centroid_bbox = BoundBox::empty;
+  OrientationBounds bcone;
+  float energy = 0.0f;
+
+  for (int i = start; i < end; i++) {
+    const LightTreePrimitive &prim = prims_[i];
+    bbox.grow(prim.bbox);
+    centroid_bbox.grow(prim.centroid);
+    bcone = merge(bcone, prim.bcone);
+    energy += prim.energy;
+  }
+
+  const int node_index = nodes_.size();
+  nodes_.push_back(KernelLightTreeNode());
+
+  KernelLightTreeNode &node = nodes_[node_index];
+  node.bbox_min[0] = bbox.min.x;
+  node.bbox_min[1] = bbox.min.y;
+  node.bbox_min[2] = bbox.min.z;
+  node.bbox_max[0] = bbox.max.x;
+  node.bbox_max[1] = bbox.max.y;
+  node.bbox_max[2] = bbox.max.z;
+  node.energy = energy;
+  node.axis[0] = bcone.axis.x;
+  node.axis[1] = bcone.axis.y;
+  node.axis[2] = bcone.axis.z;
+  node.theta_o = bcone.theta_o;
+  node.theta_e = bcone.theta_e;
+  node.parent_index = parent_index;
+  node.pad = 0;
+
+  const int num_prims = end - start;
+  if (num_prims <= max_leaf_size_) {
+    node.child_index = start;
+    node.num_emitters = num_prims;
+    return node_index;
+  }
+
+  int middle = find_split(start, end, centroid_bbox);
+  if (middle == -1) {
+    /* All centroids are in the same place, split in the middle of the range. */
+    middle = (start + end) / 2;
+  }
+
+  /* Left child directly follows this node, the node reference is invalidated by the build. */
+  build(start, middle, node_index);
+  const int right_index = build(middle, end, node_index);
+
+  nodes_[node_index].child_index = right_index;
+  nodes_[node_index].num_emitters = 0;
+
+  return node_index;
+}
+
+int LightTree::find_split(int start, int end, const BoundBox &centroid_bbox)
+{
+  const float3 extent = centroid_bbox.size();
+  const float max_extent = max3(extent);
+  if (max_extent == 0.0f) {
+    return -1;
+  }
+
+  float min_cost = FLT_MAX;
+  int min_axis = -1;
+  int min_bucket = -1;
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (extent[axis] == 0.0f) {
+      continue;
+    }
+
+    const float inv_extent = 1.0f / extent[axis];
+
+    LightTreeBucket buckets[LIGHT_TREE_NUM_BUCKETS];
+    for (int i = start; i < end; i++) {
+      const LightTreePrimitive &prim = prims_[i];
+      const int bucket_index = clamp(
+          (int)(LIGHT_TREE_NUM_BUCKETS * (prim.centroid[axis] - centroid_bbox.min[axis]) *
+                inv_extent),
+          0,
+          LIGHT_TREE_NUM_BUCKETS - 1);
+      buckets[bucket_index].add(prim.bbox, prim.bcone, prim.energy, 1);
+    }
+
+    /* Cost of splitting after every bucket, accumulated from both sides. */
+    float cost[LIGHT_TREE_NUM_BUCKETS - 1];
+    int count_left[LIGHT_TREE_NUM_BUCKETS - 1];
+
+    LightTreeBucket left;
+    for (int i = 0; i < LIGHT_TREE_NUM_BUCKETS - 1; i++) {
+      left.add(buckets[i]);
+      cost[i] = left.cost();
+      count_left[i] = left.count;
+    }
+
+    LightTreeBucket right;
+    for (int i = LIGHT_TREE_NUM_BUCKETS - 1; i > 0; i--) {
+      right.add(buckets[i]);
+      cost[i - 1] += right.cost();
+    }
+
+    /* Favor splitting along the longest axis, to avoid thin nodes. */
+    const float regularization = max_extent * inv_extent;
+
+    for (int i = 0; i < LIGHT_TREE_NUM_BUCKETS - 1; i++) {
+      if (count_left[i] == 0 || count_left[i] == end - start) {
+        continue;
+      }
+      if (cost[i] * regularization < min_cost) {
+        min_cost = cost[i] * regularization;
+        min_axis = axis;
+        min_bucket = i;
+      }
+    }
+  }
+
+  if (min_axis == -1) {
+    return -1;
+  }
+
+  const float min = centroid_bbox.min[min_axis];
+  const float inv_extent = 1.0f / extent[min_axis];
+  LightTreePrimitive *middle = std::partition(
+      &prims_[start], &prims_[end - 1] + 1, [&](const LightTreePrimitive &prim) {
+        const int bucket_index = clamp(
+            (int)(LIGHT_TREE_NUM_BUCKETS * (prim.centroid[min_axis] - min) * inv_extent),
+            0,
+            LIGHT_TREE_NUM_BUCKETS - 1);
+        return bucket_index <= min_bucket;
+      });
+
+  return middle - &prims_[0];
+}
+
+CCL_NAMESPACE_END
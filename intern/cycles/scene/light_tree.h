@@ -0,0 +1,87 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "kernel/types.h"
+
+#include "util/boundbox.h"
+#include "util/types.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Bounds of the emission directions of a set of emitters, as a cone around axis with spread
+ * theta_o, where every emitter emits into a further spread of theta_e around its normal.
+ * See "Importance Sampling of Many Lights with Adaptive Tree Splitting" by Conty and Kulla. */
+struct OrientationBounds {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+
+  OrientationBounds() : axis(make_float3(0.0f, 0.0f, 1.0f)), theta_o(0.0f), theta_e(-1.0f)
+  {
+  }
+
+  OrientationBounds(const float3 &axis, float theta_o, float theta_e)
+      : axis(axis), theta_o(theta_o), theta_e(theta_e)
+  {
+  }
+
+  bool is_empty() const
+  {
+    return theta_e < 0.0f;
+  }
+
+  /* Solid angle measure used by the split heuristic. */
+  float measure() const;
+};
+
+OrientationBounds merge(const OrientationBounds &a, const OrientationBounds &b);
+
+/* Emitter as seen by the builder, index refers to the array of the caller. */
+struct LightTreePrimitive {
+  BoundBox bbox = BoundBox::empty;
+  float3 centroid;
+  OrientationBounds bcone;
+  float energy = 0.0f;
+  int index = 0;
+};
+
+/* Light Tree
+ *
+ * Binary tree over the emitters of the scene, split by the surface area orientation heuristic.
+ * Nodes are stored in depth first order, so that the left child of an inner node directly
+ * follows it. Primitives are reordered so that every leaf references a contiguous range. */
+class LightTree {
+ public:
+  LightTree(vector<LightTreePrimitive> &prims, int max_leaf_size);
+
+  const vector<KernelLightTreeNode> &get_nodes() const
+  {
+    return nodes_;
+  }
+
+ protected:
+  int build(int start, int end, int parent_index);
+  int find_split(int start, int end, const BoundBox &centroid_bbox);
+
+  vector<LightTreePrimitive> &prims_;
+  vector<KernelLightTreeNode> nodes_;
+  int max_leaf_size_;
+};
+
+CCL_NAMESPACE_END
@@ -731,6 +731,48 @@ void Mesh::pack_normals(packed_float3 *vnormal)
   }
 }
 
+static uint encode_octahedral_normal(float3 N)
+{
+  N /= fabsf(N.x) + fabsf(N.y) + fabsf(N.z);
+  if (!isfinite_safe(N.x) || !isfinite_safe(N.y) || !isfinite_safe(N.z)) {
+    N = make_float3(0.0f, 0.0f, 1.0f);
+  }
+
+  float u = N.x, v = N.y;
+  if (N.z < 0.0f) {
+    u = (1.0f - fabsf(N.y)) * ((N.x >= 0.0f) ? 1.0f : -1.0f);
+    v = (1.0f - fabsf(N.x)) * ((N.y >= 0.0f) ? 1.0f : -1.0f);
+  }
+
+  const uint iu = (uint)clamp((u * 0.5f + 0.5f) * 65535.0f + 0.5f, 0.0f, 65535.0f);
+  const uint iv = (uint)clamp((v * 0.5f + 0.5f) * 65535.0f + 0.5f, 0.0f, 65535.0f);
+  return iu | (iv << 16);
+}
+
+void Mesh::pack_normals_compact(uint *vnormal)
+{
+  Attribute *attr_vN = attributes.find(ATTR_STD_VERTEX_NORMAL);
+  if (attr_vN == NULL) {
+    /* Happens on objects with just hair. */
+    return;
+  }
+
+  bool do_transform = transform_applied;
+  Transform ntfm = transform_normal;
+
+  float3 *vN = attr_vN->data_float3();
+  size_t verts_size = verts.size();
+
+  for (size_t i = 0; i < verts_size; i++) {
+    float3 vNi = vN[i];
+
+    if (do_transform)
+      vNi = safe_normalize(transform_direction(&ntfm, vNi));
+
+    vnormal[i] = encode_octahedral_normal(vNi);
+  }
+}
+
 void Mesh::pack_verts(packed_float3 *tri_verts,
                       uint4 *tri_vindex,
                       uint *tri_patch,
@@ -755,10 +797,72 @@ void Mesh::pack_verts(packed_float3 *tri_verts,
 
     tri_patch[i] = (!get_num_subd_faces()) ? -1 : (triangle_patch[i] * 8 + patch_offset);
 
-    tri_verts[i * 3] = verts[t.v[0]];
-    tri_verts[i * 3 + 1] = verts[t.v[1]];
-    tri_verts[i * 3 + 2] = verts[t.v[2]];
+    if (tri_verts) {
+      tri_verts[i * 3] = verts[t.v[0]];
+      tri_verts[i * 3 + 1] = verts[t.v[1]];
+      tri_verts[i * 3 + 2] = verts[t.v[2]];
+    }
+  }
+}
+
+void Mesh::pack_verts_compact(uint2 *verts_compact,
+                              packed_float3 *verts_compact_bounds,
+                              uint bounds_index,
+                              uint4 *tri_vindex,
+                              uint *tri_patch,
+                              float2 *tri_patch_uv)
+{
+  pack_verts(NULL, tri_vindex, tri_patch, tri_patch_uv);
+
+  size_t triangles_size = num_triangles();
+
+  for (size_t i = 0; i < triangles_size; i++) {
+    tri_vindex[i].w = bounds_index;
   }
+
+  size_t verts_size = verts.size();
+
+  const BoundBox bounds = compact_verts_bounds();
+  const float max_value = (float)TRIANGLE_COMPACT_MASK;
+  const float3 size = bounds.size();
+  const float3 inv_scale = make_float3((size.x > 0.0f) ? max_value / size.x : 0.0f,
+                                       (size.y > 0.0f) ? max_value / size.y : 0.0f,
+                                       (size.z > 0.0f) ? max_value / size.z : 0.0f);
+
+  verts_compact_bounds[bounds_index * 2 + 0] = bounds.min;
+  verts_compact_bounds[bounds_index * 2 + 1] = size / max_value;
+
+  for (size_t i = 0; i < verts_size; i++) {
+    const float3 q = clamp((verts[i] - bounds.min) * inv_scale + make_float3(0.5f, 0.5f, 0.5f),
+                           zero_float3(),
+                           make_float3(max_value, max_value, max_value));
+    const uint x = (uint)q.x, y = (uint)q.y, z = (uint)q.z;
+
+    verts_compact[i] = make_uint2(x | (y << TRIANGLE_COMPACT_BITS),
+                                  (y >> (32 - TRIANGLE_COMPACT_BITS)) |
+                                      (z << (2 * TRIANGLE_COMPACT_BITS - 32)));
+  }
+}
+
+BoundBox Mesh::compact_verts_bounds() const
+{
+  BoundBox bounds = BoundBox::empty;
+  for (size_t i = 0; i < verts.size(); i++) {
+    bounds.grow_safe(verts[i]);
+  }
+  if (!bounds.valid()) {
+    bounds = BoundBox(zero_float3());
+  }
+  return bounds;
+}
+
+float3 Mesh::compact_verts_error() const
+{
+  /* Half a quantization step from rounding, and float precision of the decoding. */
+  const BoundBox bounds = compact_verts_bounds();
+  const float3 step = bounds.size() / (float)TRIANGLE_COMPACT_MASK;
+  const float3 magnitude = max(fabs(bounds.min), fabs(bounds.max));
+  return step * 0.5f + magnitude * (4.0f * FLT_EPSILON);
 }
 
 void Mesh::pack_patches(uint *patch_data)
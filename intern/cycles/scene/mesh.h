@@ -191,6 +191,7 @@ class Mesh : public Geometry {
   friend class EdgeDice;
   friend class GeometryManager;
   friend class ObjectManager;
+  friend class TessellationCache;
 
   SubdParams *subd_params = nullptr;
 
@@ -228,6 +229,17 @@ class Mesh : public Geometry {
                   uint4 *tri_vindex,
                   uint *tri_patch,
                   float2 *tri_patch_uv);
+  /* Compact mesh storage: vertex positions quantized relative to the mesh bounds, which are
+   * stored at the given index, and octahedral encoded vertex normals. */
+  void pack_normals_compact(uint *vnormal);
+  void pack_verts_compact(uint2 *verts_compact,
+                          packed_float3 *verts_compact_bounds,
+                          uint bounds_index,
+                          uint4 *tri_vindex,
+                          uint *tri_patch,
+                          float2 *tri_patch_uv);
+  /* Upper bound of the distance between vertex positions and their compact storage. */
+  float3 compact_verts_error() const;
   void pack_patches(uint *patch_data);
 
   PrimitiveType primitive_type() const override;
@@ -255,6 +267,7 @@ class Mesh : public Geometry {
 
  protected:
   void clear(bool preserve_shaders, bool preserve_voxel_data);
+  BoundBox compact_verts_bounds() const;
 };
 
 CCL_NAMESPACE_END
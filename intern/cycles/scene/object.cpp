@@ -62,6 +62,10 @@ struct UpdateObjectTransformState {
   uint *object_flag;
   uint *object_visibility;
   KernelObject *objects;
+  /* Shared data of every object, deduplicated into the prototypes array after the update. */
+  array<KernelObjectPrototype> prototypes;
+  /* Prototypes from the previous update, valid unless all objects are updated. */
+  const KernelObjectPrototype *prev_prototypes;
   Transform *object_motion_pass;
   DecomposedTransform *object_motion;
   float *object_volume_step;
@@ -70,6 +74,9 @@ struct UpdateObjectTransformState {
   bool have_motion;
   bool have_curves;
 
+  /* Shared data of an object differs from the previous update. */
+  bool prototypes_modified;
+
   /* ** Scheduling queue. ** */
   Scene *scene;
 
@@ -403,6 +410,7 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
                                                    bool update_all)
 {
   KernelObject &kobject = state->objects[ob->index];
+  KernelObjectPrototype &kprototype = state->prototypes[ob->index];
   Transform *object_motion_pass = state->object_motion_pass;
 
   Geometry *geom = ob->geometry;
@@ -410,7 +418,6 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
 
   /* Compute transformations. */
   Transform tfm = ob->tfm;
-  Transform itfm = transform_inverse(tfm);
 
   float3 color = ob->color;
   float pass_id = ob->pass_id;
@@ -419,17 +426,19 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
                            ob->particle_index + state->particle_offset[ob->particle_system] :
                            0;
 
+  /* Zero the prototype, including padding, since prototypes are compared bytewise. */
+  memset(&kprototype, 0, sizeof(kprototype));
+
   kobject.tfm = tfm;
-  kobject.itfm = itfm;
-  kobject.volume_density = object_volume_density(tfm, geom);
-  kobject.color[0] = color.x;
-  kobject.color[1] = color.y;
-  kobject.color[2] = color.z;
-  kobject.pass_id = pass_id;
+  kprototype.volume_density = object_volume_density(tfm, geom);
+  kprototype.color[0] = color.x;
+  kprototype.color[1] = color.y;
+  kprototype.color[2] = color.z;
+  kprototype.pass_id = pass_id;
   kobject.random_number = random_number;
   kobject.particle_index = particle_index;
   kobject.motion_offset = 0;
-  kobject.ao_distance = ob->ao_distance;
+  kprototype.ao_distance = ob->ao_distance;
 
   if (geom->get_use_motion_blur()) {
     state->have_motion = true;
@@ -462,6 +471,7 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
      * comes with deformed position in object space, or if we transform
      * the shading point in world space. */
     if (!(flag & SD_OBJECT_HAS_VERTEX_MOTION)) {
+      Transform itfm = transform_inverse(tfm);
       tfm_pre = tfm_pre * itfm;
       tfm_post = tfm_post * itfm;
     }
@@ -489,34 +499,47 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
   kobject.dupli_generated[0] = ob->dupli_generated[0];
   kobject.dupli_generated[1] = ob->dupli_generated[1];
   kobject.dupli_generated[2] = ob->dupli_generated[2];
-  kobject.numkeys = (geom->geometry_type == Geometry::HAIR) ?
-                        static_cast<Hair *>(geom)->get_curve_keys().size() :
-                        0;
+  kprototype.numkeys = (geom->geometry_type == Geometry::HAIR) ?
+                           static_cast<Hair *>(geom)->get_curve_keys().size() :
+                           0;
   kobject.dupli_uv[0] = ob->dupli_uv[0];
   kobject.dupli_uv[1] = ob->dupli_uv[1];
   int totalsteps = geom->get_motion_steps();
-  kobject.numsteps = (totalsteps - 1) / 2;
-  kobject.numverts = (geom->geometry_type == Geometry::MESH ||
-                      geom->geometry_type == Geometry::VOLUME) ?
-                         static_cast<Mesh *>(geom)->get_verts().size() :
-                         0;
+  kprototype.numsteps = (totalsteps - 1) / 2;
+  kprototype.numverts = (geom->geometry_type == Geometry::MESH ||
+                         geom->geometry_type == Geometry::VOLUME) ?
+                            static_cast<Mesh *>(geom)->get_verts().size() :
+                            0;
   kobject.patch_map_offset = 0;
   kobject.attribute_map_offset = 0;
 
+  const KernelObjectPrototype *prev_prototype = (update_all) ?
+                                                    NULL :
+                                                    &state->prev_prototypes[kobject.prototype];
+
   if (ob->asset_name_is_modified() || update_all) {
     uint32_t hash_name = util_murmur_hash3(ob->name.c_str(), ob->name.length(), 0);
     uint32_t hash_asset = util_murmur_hash3(ob->asset_name.c_str(), ob->asset_name.length(), 0);
-    kobject.cryptomatte_object = util_hash_to_float(hash_name);
-    kobject.cryptomatte_asset = util_hash_to_float(hash_asset);
+    kprototype.cryptomatte_object = util_hash_to_float(hash_name);
+    kprototype.cryptomatte_asset = util_hash_to_float(hash_asset);
+  }
+  else {
+    kprototype.cryptomatte_object = prev_prototype->cryptomatte_object;
+    kprototype.cryptomatte_asset = prev_prototype->cryptomatte_asset;
   }
 
-  kobject.shadow_terminator_shading_offset = 1.0f /
-                                             (1.0f - 0.5f * ob->shadow_terminator_shading_offset);
-  kobject.shadow_terminator_geometry_offset = ob->shadow_terminator_geometry_offset;
+  kprototype.shadow_terminator_shading_offset = 1.0f /
+                                                (1.0f -
+                                                 0.5f * ob->shadow_terminator_shading_offset);
+  kprototype.shadow_terminator_geometry_offset = ob->shadow_terminator_geometry_offset;
 
   kobject.visibility = ob->visibility_for_tracing();
   kobject.primitive_type = geom->primitive_type();
 
+  if (update_all || memcmp(&kprototype, prev_prototype, sizeof(kprototype)) != 0) {
+    state->prototypes_modified = true;
+  }
+
   /* Object flag. */
   if (ob->use_holdout) {
     flag |= SD_OBJECT_HOLDOUT_MASK;
@@ -565,10 +588,13 @@ void ObjectManager::device_update_transforms(DeviceScene *dscene, Scene *scene,
   state.need_motion = scene->need_motion();
   state.have_motion = false;
   state.have_curves = false;
+  state.prototypes_modified = false;
   state.scene = scene;
   state.queue_start_object = 0;
 
   state.objects = dscene->objects.alloc(scene->objects.size());
+  state.prototypes.resize(scene->objects.size());
+  state.prev_prototypes = dscene->object_prototypes.data();
   state.object_flag = dscene->object_flag.alloc(scene->objects.size());
   state.object_volume_step = dscene->object_volume_step.alloc(scene->objects.size());
   state.object_motion = NULL;
@@ -622,6 +648,8 @@ void ObjectManager::device_update_transforms(DeviceScene *dscene, Scene *scene,
     return;
   }
 
+  device_update_prototypes(&state, dscene, scene);
+
   dscene->objects.copy_to_device_if_modified();
   if (state.need_motion == Scene::MOTION_PASS) {
     dscene->object_motion_pass.copy_to_device();
@@ -638,6 +666,72 @@ void ObjectManager::device_update_transforms(DeviceScene *dscene, Scene *scene,
   dscene->object_motion.clear_modified();
 }
 
+struct KernelObjectPrototypeHash {
+  size_t operator()(const KernelObjectPrototype &kprototype) const
+  {
+    return util_murmur_hash3(&kprototype, sizeof(kprototype), 0);
+  }
+};
+
+struct KernelObjectPrototypeEqual {
+  bool operator()(const KernelObjectPrototype &a, const KernelObjectPrototype &b) const
+  {
+    return memcmp(&a, &b, sizeof(KernelObjectPrototype)) == 0;
+  }
+};
+
+void ObjectManager::device_update_prototypes(UpdateObjectTransformState *state,
+                                             DeviceScene *dscene,
+                                             Scene *scene)
+{
+  /* Objects keep their prototype index from the previous update when no shared data changed and
+   * no objects were added or removed. */
+  if (!state->prototypes_modified) {
+    state->prototypes.clear();
+    return;
+  }
+
+  /* Deduplicate the shared object data. Instances of the same geometry and object settings only
+   * differ by their transform and instance data, so they end up sharing a single prototype. */
+  unordered_map<KernelObjectPrototype, int, KernelObjectPrototypeHash, KernelObjectPrototypeEqual>
+      prototype_index;
+  vector<KernelObjectPrototype> prototypes;
+  bool modified = false;
+
+  for (size_t i = 0; i < scene->objects.size(); i++) {
+    const KernelObjectPrototype &kprototype = state->prototypes[i];
+    auto it = prototype_index.find(kprototype);
+    int index;
+
+    if (it == prototype_index.end()) {
+      index = prototypes.size();
+      prototype_index[kprototype] = index;
+      prototypes.push_back(kprototype);
+    }
+    else {
+      index = it->second;
+    }
+
+    if (state->objects[i].prototype != index) {
+      state->objects[i].prototype = index;
+      modified = true;
+    }
+  }
+
+  if (modified) {
+    dscene->objects.tag_modified();
+  }
+
+  state->prototypes.clear();
+
+  VLOG(1) << "Total " << prototypes.size() << " object prototypes for " << scene->objects.size()
+          << " objects.";
+
+  KernelObjectPrototype *kprototypes = dscene->object_prototypes.alloc(prototypes.size());
+  std::copy(prototypes.begin(), prototypes.end(), kprototypes);
+  dscene->object_prototypes.copy_to_device();
+}
+
 void ObjectManager::device_update(Device *device,
                                   DeviceScene *dscene,
                                   Scene *scene,
@@ -648,6 +742,7 @@ void ObjectManager::device_update(Device *device,
 
   if (update_flags & (OBJECT_ADDED | OBJECT_REMOVED)) {
     dscene->objects.tag_realloc();
+    dscene->object_prototypes.tag_realloc();
     dscene->object_motion_pass.tag_realloc();
     dscene->object_motion.tag_realloc();
     dscene->object_flag.tag_realloc();
@@ -865,6 +960,7 @@ void ObjectManager::device_update_mesh_offsets(Device *, DeviceScene *dscene, Sc
 void ObjectManager::device_free(Device *, DeviceScene *dscene, bool force_free)
 {
   dscene->objects.free_if_need_realloc(force_free);
+  dscene->object_prototypes.free_if_need_realloc(force_free);
   dscene->object_motion_pass.free_if_need_realloc(force_free);
   dscene->object_motion.free_if_need_realloc(force_free);
   dscene->object_flag.free_if_need_realloc(force_free);
@@ -909,6 +1005,12 @@ void ObjectManager::apply_static_transforms(DeviceScene *dscene, Scene *scene, P
     bool apply = (geometry_users[geom] == 1) && !geom->has_surface_bssrdf &&
                  !geom->has_true_displacement();
 
+    /* Keep deforming geometry instanced so its own BVH can be refit, instead of rebuilding it
+     * as part of the scene BVH. */
+    if (scene->params.bvh_refit_policy == BVH_REFIT_TOPOLOGY_UNCHANGED && geom->is_deforming) {
+      apply = false;
+    }
+
     if (geom->geometry_type == Geometry::MESH) {
       Mesh *mesh = static_cast<Mesh *>(geom);
       apply = apply && mesh->get_subdivision_type() == Mesh::SUBDIVISION_NONE;
@@ -967,8 +1069,9 @@ void ObjectManager::tag_update(Scene *scene, uint32_t flag)
 
   scene->light_manager->tag_update(scene, LightManager::OBJECT_MANAGER);
 
-  /* Integrator's shadow catcher settings depends on object visibility settings. */
-  if (flag & (OBJECT_ADDED | OBJECT_REMOVED | OBJECT_MODIFIED)) {
+  /* Integrator's shadow catcher settings depends on object visibility settings, and the path
+   * guiding grid on object bounds. */
+  if (flag & (OBJECT_ADDED | OBJECT_REMOVED | OBJECT_MODIFIED | TRANSFORM_MODIFIED)) {
     scene->integrator->tag_update(scene, Integrator::OBJECT_MANAGER);
   }
 }
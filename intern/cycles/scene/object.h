@@ -180,6 +180,9 @@ class ObjectManager {
                                       Object *ob,
                                       bool update_all);
   void device_update_object_transform_task(UpdateObjectTransformState *state);
+  void device_update_prototypes(UpdateObjectTransformState *state,
+                                DeviceScene *dscene,
+                                Scene *scene);
   bool device_update_object_transform_pop_work(UpdateObjectTransformState *state,
                                                int *start_index,
                                                int *num_objects);
@@ -35,6 +35,7 @@
 #include "scene/shader.h"
 #include "scene/svm.h"
 #include "scene/tables.h"
+#include "scene/tessellation_cache.h"
 #include "scene/volume.h"
 #include "session/session.h"
 
@@ -60,11 +61,15 @@ DeviceScene::DeviceScene(Device *device)
       tri_vindex(device, "__tri_vindex", MEM_GLOBAL),
       tri_patch(device, "__tri_patch", MEM_GLOBAL),
       tri_patch_uv(device, "__tri_patch_uv", MEM_GLOBAL),
+      tri_verts_compact(device, "__tri_verts_compact", MEM_GLOBAL),
+      tri_verts_compact_bounds(device, "__tri_verts_compact_bounds", MEM_GLOBAL),
+      tri_vnormal_compact(device, "__tri_vnormal_compact", MEM_GLOBAL),
       curves(device, "__curves", MEM_GLOBAL),
       curve_keys(device, "__curve_keys", MEM_GLOBAL),
       curve_segments(device, "__curve_segments", MEM_GLOBAL),
       patches(device, "__patches", MEM_GLOBAL),
       objects(device, "__objects", MEM_GLOBAL),
+      object_prototypes(device, "__object_prototypes", MEM_GLOBAL),
       object_motion_pass(device, "__object_motion_pass", MEM_GLOBAL),
       object_motion(device, "__object_motion", MEM_GLOBAL),
       object_flag(device, "__object_flag", MEM_GLOBAL),
@@ -79,6 +84,9 @@ DeviceScene::DeviceScene(Device *device)
       attributes_uchar4(device, "__attributes_uchar4", MEM_GLOBAL),
       light_distribution(device, "__light_distribution", MEM_GLOBAL),
       lights(device, "__lights", MEM_GLOBAL),
+      light_tree_nodes(device, "__light_tree_nodes", MEM_GLOBAL),
+      light_tree_emitters(device, "__light_tree_emitters", MEM_GLOBAL),
+      light_tree_emitter_index(device, "__light_tree_emitter_index", MEM_GLOBAL),
       light_background_marginal_cdf(device, "__light_background_marginal_cdf", MEM_GLOBAL),
       light_background_conditional_cdf(device, "__light_background_conditional_cdf", MEM_GLOBAL),
       particles(device, "__particles", MEM_GLOBAL),
@@ -86,6 +94,8 @@ DeviceScene::DeviceScene(Device *device)
       shaders(device, "__shaders", MEM_GLOBAL),
       lookup_table(device, "__lookup_table", MEM_GLOBAL),
       sample_pattern_lut(device, "__sample_pattern_lut", MEM_GLOBAL),
+      guiding_field(device, "__guiding_field", MEM_GLOBAL),
+      guiding_training(device, "__guiding_training", MEM_GLOBAL),
       ies_lights(device, "__ies", MEM_GLOBAL)
 {
   memset((void *)&data, 0, sizeof(data));
@@ -122,6 +132,7 @@ Scene::Scene(const SceneParams &params_, Device *device)
   particle_system_manager = new ParticleSystemManager();
   bake_manager = new BakeManager();
   procedural_manager = new ProceduralManager();
+  tessellation_cache = new TessellationCache();
 
   /* Create nodes after managers, since create_node() can tag the managers. */
   camera = create_node<Camera>();
@@ -227,6 +238,7 @@ void Scene::free_memory(bool final)
     delete bake_manager;
     delete update_stats;
     delete procedural_manager;
+    delete tessellation_cache;
   }
 }
 
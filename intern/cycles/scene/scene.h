@@ -59,6 +59,7 @@ class ProceduralManager;
 class CurveSystemManager;
 class Shader;
 class ShaderManager;
+class TessellationCache;
 class Progress;
 class BakeManager;
 class BakeData;
@@ -87,6 +88,9 @@ class DeviceScene {
   device_vector<uint4> tri_vindex;
   device_vector<uint> tri_patch;
   device_vector<float2> tri_patch_uv;
+  device_vector<uint2> tri_verts_compact;
+  device_vector<packed_float3> tri_verts_compact_bounds;
+  device_vector<uint> tri_vnormal_compact;
 
   device_vector<KernelCurve> curves;
   device_vector<float4> curve_keys;
@@ -96,6 +100,7 @@ class DeviceScene {
 
   /* objects */
   device_vector<KernelObject> objects;
+  device_vector<KernelObjectPrototype> object_prototypes;
   device_vector<Transform> object_motion_pass;
   device_vector<DecomposedTransform> object_motion;
   device_vector<uint> object_flag;
@@ -116,6 +121,9 @@ class DeviceScene {
   /* lights */
   device_vector<KernelLightDistribution> light_distribution;
   device_vector<KernelLight> lights;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<KernelLightTreeEmitter> light_tree_emitters;
+  device_vector<int> light_tree_emitter_index;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
 
@@ -131,6 +139,8 @@ class DeviceScene {
 
   /* integrator */
   device_vector<float> sample_pattern_lut;
+  device_vector<float> guiding_field;
+  device_vector<float> guiding_training;
 
   /* ies lights */
   device_vector<float> ies_lights;
@@ -154,6 +164,7 @@ class SceneParams {
   BVHLayout bvh_layout;
 
   BVHType bvh_type;
+  BVHRefitPolicy bvh_refit_policy;
   bool use_bvh_spatial_split;
   bool use_bvh_unaligned_nodes;
   int num_bvh_time_steps;
@@ -161,6 +172,28 @@ class SceneParams {
   CurveShapeType hair_shape;
   int texture_limit;
 
+  /* Store geometry BVHs in the disk cache, to reuse them for unchanged geometry in following
+   * frames and sessions. */
+  bool use_bvh_disk_cache;
+
+  /* Load image textures on demand through a tiled cache, with a memory budget in megabytes.
+   * Only used for CPU rendering. */
+  bool use_texture_cache;
+  int texture_cache_size;
+
+  /* Store image textures converted to the device data layout in the disk cache, and memory map
+   * them on following loads instead of decoding the image file. Only used for CPU rendering. */
+  bool use_texture_disk_cache;
+
+  /* Store mesh vertex positions quantized to the mesh bounds and vertex normals octahedral
+   * encoded. Only used for CPU rendering. */
+  bool use_compact_mesh;
+
+  /* Reuse diced and displaced meshes from the previous scene update or frame, as long as the
+   * dicing camera raster size changed less than the relative tolerance. */
+  bool use_tessellation_cache;
+  float tessellation_cache_tolerance;
+
   bool background;
 
   SceneParams()
@@ -168,24 +201,39 @@ class SceneParams {
     shadingsystem = SHADINGSYSTEM_SVM;
     bvh_layout = BVH_LAYOUT_BVH2;
     bvh_type = BVH_TYPE_DYNAMIC;
+    bvh_refit_policy = BVH_REFIT_INSTANCED;
     use_bvh_spatial_split = false;
     use_bvh_unaligned_nodes = true;
     num_bvh_time_steps = 0;
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
     texture_limit = 0;
+    use_bvh_disk_cache = false;
+    use_texture_cache = false;
+    texture_cache_size = 4096;
+    use_texture_disk_cache = false;
+    use_compact_mesh = false;
+    use_tessellation_cache = false;
+    tessellation_cache_tolerance = 0.1f;
     background = true;
   }
 
   bool modified(const SceneParams &params) const
   {
     return !(shadingsystem == params.shadingsystem && bvh_layout == params.bvh_layout &&
-             bvh_type == params.bvh_type &&
+             bvh_type == params.bvh_type && bvh_refit_policy == params.bvh_refit_policy &&
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             texture_limit == params.texture_limit);
+             texture_limit == params.texture_limit &&
+             use_bvh_disk_cache == params.use_bvh_disk_cache &&
+             use_texture_cache == params.use_texture_cache &&
+             texture_cache_size == params.texture_cache_size &&
+             use_texture_disk_cache == params.use_texture_disk_cache &&
+             use_compact_mesh == params.use_compact_mesh &&
+             use_tessellation_cache == params.use_tessellation_cache &&
+             tessellation_cache_tolerance == params.tessellation_cache_tolerance);
   }
 
   int curve_subdivisions()
@@ -229,6 +277,7 @@ class Scene : public NodeOwner {
   ParticleSystemManager *particle_system_manager;
   BakeManager *bake_manager;
   ProceduralManager *procedural_manager;
+  TessellationCache *tessellation_cache;
 
   /* default shaders */
   Shader *default_surface;
@@ -552,6 +552,7 @@ void ShaderManager::device_update_common(Device * /*device*/,
     /* regular shader */
     kshader->flags = flag;
     kshader->pass_id = shader->get_pass_id();
+    kshader->kernel_features = get_shader_kernel_features(shader);
     kshader->constant_emission[0] = constant_emission.x;
     kshader->constant_emission[1] = constant_emission.y;
     kshader->constant_emission[2] = constant_emission.z;
@@ -709,6 +710,26 @@ uint ShaderManager::get_graph_kernel_features(ShaderGraph *graph)
   return kernel_features;
 }
 
+uint ShaderManager::get_shader_kernel_features(Shader *shader)
+{
+  /* Gather requested features from all the nodes from the graph nodes. */
+  uint kernel_features = get_graph_kernel_features(shader->graph);
+  ShaderNode *output_node = shader->graph->output();
+  if (output_node->input("Displacement")->link != NULL) {
+    kernel_features |= KERNEL_FEATURE_NODE_BUMP;
+    if (shader->get_displacement_method() == DISPLACE_BOTH) {
+      kernel_features |= KERNEL_FEATURE_NODE_BUMP_STATE;
+    }
+  }
+  /* On top of volume nodes, also check if we need volume sampling because
+   * e.g. an Emission node would slip through the KERNEL_FEATURE_NODE_VOLUME check */
+  if (shader->has_volume_connected) {
+    kernel_features |= KERNEL_FEATURE_VOLUME;
+  }
+
+  return kernel_features;
+}
+
 uint ShaderManager::get_kernel_features(Scene *scene)
 {
   uint kernel_features = KERNEL_FEATURE_NODE_BSDF | KERNEL_FEATURE_NODE_EMISSION;
@@ -718,20 +739,7 @@ uint ShaderManager::get_kernel_features(Scene *scene)
       continue;
     }
 
-    /* Gather requested features from all the nodes from the graph nodes. */
-    kernel_features |= get_graph_kernel_features(shader->graph);
-    ShaderNode *output_node = shader->graph->output();
-    if (output_node->input("Displacement")->link != NULL) {
-      kernel_features |= KERNEL_FEATURE_NODE_BUMP;
-      if (shader->get_displacement_method() == DISPLACE_BOTH) {
-        kernel_features |= KERNEL_FEATURE_NODE_BUMP_STATE;
-      }
-    }
-    /* On top of volume nodes, also check if we need volume sampling because
-     * e.g. an Emission node would slip through the KERNEL_FEATURE_NODE_VOLUME check */
-    if (shader->has_volume_connected) {
-      kernel_features |= KERNEL_FEATURE_VOLUME;
-    }
+    kernel_features |= get_shader_kernel_features(shader);
   }
 
   return kernel_features;
@@ -769,10 +777,9 @@ string ShaderManager::get_cryptomatte_materials(Scene *scene)
   return manifest;
 }
 
-void ShaderManager::tag_update(Scene * /*scene*/, uint32_t /*flag*/)
+void ShaderManager::tag_update(Scene * /*scene*/, uint32_t flag)
 {
-  /* update everything for now */
-  update_flags = ShaderManager::UPDATE_ALL;
+  update_flags |= flag;
 }
 
 bool ShaderManager::need_update() const
@@ -176,6 +176,7 @@ class ShaderManager {
     SHADER_ADDED = (1 << 0),
     SHADER_MODIFIED = (1 << 2),
     INTEGRATOR_MODIFIED = (1 << 3),
+    AOV_PASSES_MODIFIED = (1 << 4),
 
     /* tag everything in the manager for an update */
     UPDATE_ALL = ~0u,
@@ -245,6 +246,7 @@ class ShaderManager {
   size_t beckmann_table_offset;
 
   uint get_graph_kernel_features(ShaderGraph *graph);
+  uint get_shader_kernel_features(Shader *shader);
 
   thread_spin_lock attribute_lock_;
 
@@ -25,6 +25,7 @@
 #include "util/foreach.h"
 #include "util/log.h"
 #include "util/md5.h"
+#include "util/path.h"
 #include "util/queue.h"
 
 CCL_NAMESPACE_BEGIN
@@ -221,6 +222,7 @@ ShaderGraph::ShaderGraph()
   finalized = false;
   simplified = false;
   num_node_ids = 0;
+  displacement_uses_unhashed_data = false;
   add(create_node<OutputNode>());
 }
 
@@ -748,6 +750,8 @@ void ShaderGraph::compute_displacement_hash()
    * to recompute displacement when shader nodes change. */
   ShaderInput *displacement_in = output()->input("Displacement");
 
+  displacement_uses_unhashed_data = false;
+
   if (!displacement_in->link) {
     displacement_hash = "";
     return;
@@ -771,6 +775,37 @@ void ShaderGraph::compute_displacement_hash()
       OSLNode *oslnode = static_cast<OSLNode *>(node);
       md5.append(oslnode->bytecode_hash);
     }
+
+    /* Images from files are identified by their filename in the socket values, also detect
+     * files modified on disk. Images from the host application only have an image handle, like
+     * packed, generated and movie images, or point density read from objects. */
+    ustring filename;
+    if (node->type == ImageTextureNode::get_node_type()) {
+      ImageTextureNode *image_node = static_cast<ImageTextureNode *>(node);
+      filename = image_node->get_filename();
+      if (!image_node->handle.empty()) {
+        displacement_uses_unhashed_data = true;
+      }
+    }
+    else if (node->type == EnvironmentTextureNode::get_node_type()) {
+      EnvironmentTextureNode *env_node = static_cast<EnvironmentTextureNode *>(node);
+      filename = env_node->get_filename();
+      if (!env_node->handle.empty()) {
+        displacement_uses_unhashed_data = true;
+      }
+    }
+    else if (node->type == PointDensityTextureNode::get_node_type()) {
+      displacement_uses_unhashed_data = true;
+    }
+
+    if (!filename.empty()) {
+      const uint64_t modified_time = path_modified_time(filename.string());
+      md5.append((const uint8_t *)&modified_time, sizeof(modified_time));
+      /* Modification time of UDIM tiles is not checked. */
+      if (strchr(filename.c_str(), '<')) {
+        displacement_uses_unhashed_data = true;
+      }
+    }
   }
 
   displacement_hash = md5.get_hex();
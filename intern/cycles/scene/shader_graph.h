@@ -314,6 +314,9 @@ class ShaderGraph : public NodeOwner {
   bool finalized;
   bool simplified;
   string displacement_hash;
+  /* Displacement reads data that can change without changing the displacement hash, like images
+   * provided by the host application or UDIM image tiles. */
+  bool displacement_uses_unhashed_data;
 
   ShaderGraph();
   ~ShaderGraph();
@@ -217,9 +217,11 @@ string NamedSampleCountStats::full_report(int indent_level)
     const double seconds = entry.samples * 0.001;
     const double relative = ((double)entry.samples) / (entry.hits * avg_samples_per_hit);
 
-    result += indent +
-              string_printf(
-                  "%-32s: %.2fs (Relative cost: %.2f)\n", entry.name.c_str(), seconds, relative);
+    result += indent + string_printf("%-32s: %.2fs (Relative cost: %.2f, Evaluations: %llu)\n",
+                                     entry.name.c_str(),
+                                     seconds,
+                                     relative,
+                                     (unsigned long long)entry.hits);
   }
   return result;
 }
@@ -227,20 +229,62 @@ string NamedSampleCountStats::full_report(int indent_level)
 /* Mesh statistics. */
 
 MeshStats::MeshStats()
+    : bvh_refit_policy(BVH_REFIT_INSTANCED),
+      bvh_num_builds(0),
+      bvh_num_refits(0),
+      bvh_build_time(0.0),
+      bvh_refit_time(0.0)
 {
 }
 
+static const char *bvh_refit_policy_name(int policy)
+{
+  switch (policy) {
+    case BVH_REFIT_NEVER:
+      return "Never";
+    case BVH_REFIT_INSTANCED:
+      return "Instanced";
+    case BVH_REFIT_TOPOLOGY_UNCHANGED:
+      return "Topology Unchanged";
+  }
+  return "Unknown";
+}
+
 string MeshStats::full_report(int indent_level)
 {
   const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string child_indent((indent_level + 1) * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Geometry:\n" + geometry.full_report(indent_level + 1);
+  result += indent + "BVH:\n";
+  result += string_printf("%s%-32s %s\n",
+                          child_indent.c_str(),
+                          "Refit policy",
+                          bvh_refit_policy_name(bvh_refit_policy));
+  result += string_printf("%s%-32s %d (%.2fs)\n",
+                          child_indent.c_str(),
+                          "Builds",
+                          bvh_num_builds,
+                          bvh_build_time);
+  result += string_printf("%s%-32s %d (%.2fs)\n",
+                          child_indent.c_str(),
+                          "Refits",
+                          bvh_num_refits,
+                          bvh_refit_time);
   return result;
 }
 
 /* Image statistics. */
 
 ImageStats::ImageStats()
+    : has_texture_cache(false),
+      texture_cache_budget(0),
+      texture_cache_peak(0),
+      texture_cache_tiles_loaded(0),
+      texture_cache_tiles_evicted(0),
+      has_texture_disk_cache(false),
+      texture_disk_cache_mapped(0),
+      texture_disk_cache_resident(0)
 {
 }
 
@@ -249,6 +293,88 @@ string ImageStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+  if (has_texture_cache) {
+    const string double_indent = indent + indent;
+    result += indent + "Texture cache:\n";
+    result += string_printf("%s%-32s %s\n",
+                            double_indent.c_str(),
+                            "Budget",
+                            string_human_readable_size(texture_cache_budget).c_str());
+    result += string_printf("%s%-32s %s\n",
+                            double_indent.c_str(),
+                            "Peak memory",
+                            string_human_readable_size(texture_cache_peak).c_str());
+    result += string_printf("%s%-32s %llu\n",
+                            double_indent.c_str(),
+                            "Tiles loaded",
+                            (unsigned long long)texture_cache_tiles_loaded);
+    result += string_printf("%s%-32s %llu\n",
+                            double_indent.c_str(),
+                            "Tiles evicted",
+                            (unsigned long long)texture_cache_tiles_evicted);
+  }
+  if (has_texture_disk_cache) {
+    const string double_indent = indent + indent;
+    result += indent + "Texture disk cache:\n";
+    result += string_printf("%s%-32s %s\n",
+                            double_indent.c_str(),
+                            "Memory mapped",
+                            string_human_readable_size(texture_disk_cache_mapped).c_str());
+    result += string_printf("%s%-32s %s\n",
+                            double_indent.c_str(),
+                            "Resident",
+                            string_human_readable_size(texture_disk_cache_resident).c_str());
+  }
+  return result;
+}
+
+/* Ray statistics. */
+
+RayStats::RayStats()
+    : num_camera_rays(0),
+      num_closest_rays(0),
+      num_shadow_rays(0),
+      num_subsurface_rays(0),
+      num_volume_stack_rays(0),
+      num_bvh_nodes(0),
+      num_bvh_primitives(0)
+{
+}
+
+string RayStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const uint64_t num_rays = num_closest_rays + num_shadow_rays + num_subsurface_rays +
+                            num_volume_stack_rays;
+
+  string result = "";
+  result += string_printf(
+      "%s%-32s %llu\n", indent.c_str(), "Camera rays", (unsigned long long)num_camera_rays);
+  result += string_printf(
+      "%s%-32s %llu\n", indent.c_str(), "Closest rays", (unsigned long long)num_closest_rays);
+  result += string_printf(
+      "%s%-32s %llu\n", indent.c_str(), "Shadow rays", (unsigned long long)num_shadow_rays);
+  result += string_printf("%s%-32s %llu\n",
+                          indent.c_str(),
+                          "Subsurface rays",
+                          (unsigned long long)num_subsurface_rays);
+  result += string_printf("%s%-32s %llu\n",
+                          indent.c_str(),
+                          "Volume stack rays",
+                          (unsigned long long)num_volume_stack_rays);
+
+  if (num_bvh_nodes) {
+    result += string_printf("%s%-32s %llu (%.2f per ray)\n",
+                            indent.c_str(),
+                            "BVH node visits",
+                            (unsigned long long)num_bvh_nodes,
+                            (double)num_bvh_nodes / max(num_rays, (uint64_t)1));
+    result += string_printf("%s%-32s %llu (%.2f per ray)\n",
+                            indent.c_str(),
+                            "BVH primitive tests",
+                            (unsigned long long)num_bvh_primitives,
+                            (double)num_bvh_primitives / max(num_rays, (uint64_t)1));
+  }
   return result;
 }
 
@@ -293,6 +419,14 @@ void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
   light.add_entry("Setup", prof.get_event(PROFILING_SHADE_LIGHT_SETUP));
   light.add_entry("Shader Evaluation", prof.get_event(PROFILING_SHADE_LIGHT_EVAL));
 
+  rays.num_camera_rays = prof.get_counter(PROFILING_COUNTER_CAMERA_RAYS);
+  rays.num_closest_rays = prof.get_counter(PROFILING_COUNTER_CLOSEST_RAYS);
+  rays.num_shadow_rays = prof.get_counter(PROFILING_COUNTER_SHADOW_RAYS);
+  rays.num_subsurface_rays = prof.get_counter(PROFILING_COUNTER_SUBSURFACE_RAYS);
+  rays.num_volume_stack_rays = prof.get_counter(PROFILING_COUNTER_VOLUME_STACK_RAYS);
+  rays.num_bvh_nodes = prof.get_counter(PROFILING_COUNTER_BVH_NODES);
+  rays.num_bvh_primitives = prof.get_counter(PROFILING_COUNTER_BVH_PRIMITIVES);
+
   shaders.entries.clear();
   foreach (Shader *shader, scene->shaders) {
     uint64_t samples, hits;
@@ -317,6 +451,7 @@ string RenderStats::full_report()
   result += "Image statistics:\n" + image.full_report(1);
   if (has_profiling) {
     result += "Kernel statistics:\n" + kernel.full_report(1);
+    result += "Ray statistics:\n" + rays.full_report(1);
     result += "Shader statistics:\n" + shaders.full_report(1);
     result += "Object statistics:\n" + objects.full_report(1);
   }
@@ -160,6 +160,13 @@ class MeshStats {
    * memory like BVH.
    */
   NamedSizeStats geometry;
+
+  /* Geometry BVH builds and refits, including previous updates of the same scene. */
+  int bvh_refit_policy;
+  int bvh_num_builds;
+  int bvh_num_refits;
+  double bvh_build_time;
+  double bvh_refit_time;
 };
 
 /* Statistics about images held in memory. */
@@ -171,6 +178,38 @@ class ImageStats {
   string full_report(int indent_level = 0);
 
   NamedSizeStats textures;
+
+  /* Texture cache, when images are loaded on demand. */
+  bool has_texture_cache;
+  size_t texture_cache_budget;
+  size_t texture_cache_peak;
+  uint64_t texture_cache_tiles_loaded;
+  uint64_t texture_cache_tiles_evicted;
+
+  /* Texture disk cache, when images are memory mapped. Resident is the part of the mapped
+   * pixels currently in memory. */
+  bool has_texture_disk_cache;
+  size_t texture_disk_cache_mapped;
+  size_t texture_disk_cache_resident;
+};
+
+/* Statistics about rays traced and BVH traversal, counted exactly by the kernels. */
+class RayStats {
+ public:
+  RayStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  uint64_t num_camera_rays;
+  uint64_t num_closest_rays;
+  uint64_t num_shadow_rays;
+  uint64_t num_subsurface_rays;
+  uint64_t num_volume_stack_rays;
+
+  /* Only counted for BVH2, zero when Embree is used. */
+  uint64_t num_bvh_nodes;
+  uint64_t num_bvh_primitives;
 };
 
 /* Render process statistics. */
@@ -189,6 +228,7 @@ class RenderStats {
   MeshStats mesh;
   ImageStats image;
   NamedNestedSampleStats kernel;
+  RayStats rays;
   NamedSampleCountStats shaders;
   NamedSampleCountStats objects;
 };
@@ -17,6 +17,7 @@
 #include "device/device.h"
 
 #include "scene/background.h"
+#include "scene/film.h"
 #include "scene/light.h"
 #include "scene/mesh.h"
 #include "scene/scene.h"
@@ -45,6 +46,7 @@ SVMShaderManager::~SVMShaderManager()
 
 void SVMShaderManager::reset(Scene * /*scene*/)
 {
+  compiled_shaders.clear();
 }
 
 void SVMShaderManager::device_update_shader(Scene *scene,
@@ -92,20 +94,50 @@ void SVMShaderManager::device_update_specific(Device *device,
   /* test if we need to update */
   device_free(device, dscene, scene);
 
-  /* Build all shaders. */
+  /* Build modified shaders, and reuse the nodes of unmodified shaders from the last update.
+   * Compiled shaders only depend on the shader itself, on whether it is used for the background,
+   * on the integrator settings for shaders which have a dependency on them, and on the AOV pass
+   * layout since AOV outputs are compiled with their render buffer offsets. */
+  const bool compile_all = (update_flags == UPDATE_ALL);
+  const bool integrator_modified = (update_flags & INTEGRATOR_MODIFIED);
+  const string aov_layout = scene->film->get_aov_layout(scene);
+  Shader *background_shader = scene->background->get_shader(scene);
+
+  unordered_map<const Shader *, CompiledShader> prev_compiled_shaders;
+  prev_compiled_shaders.swap(compiled_shaders);
+
   TaskPool task_pool;
-  vector<array<int4>> shader_svm_nodes(num_shaders);
+  vector<array<int4> *> shader_svm_nodes(num_shaders);
+  int num_compiled = 0;
   for (int i = 0; i < num_shaders; i++) {
+    Shader *shader = scene->shaders[i];
+    const bool background = (shader == background_shader);
+
+    CompiledShader &compiled = compiled_shaders[shader];
+    compiled.background = background;
+    compiled.aov_layout = aov_layout;
+    shader_svm_nodes[i] = &compiled.svm_nodes;
+
+    auto it = prev_compiled_shaders.find(shader);
+    if (!compile_all && it != prev_compiled_shaders.end() && !shader->is_modified() &&
+        it->second.background == background && it->second.aov_layout == aov_layout &&
+        !(integrator_modified && shader->has_integrator_dependency)) {
+      compiled.svm_nodes.steal_data(it->second.svm_nodes);
+      continue;
+    }
+
     task_pool.push(function_bind(&SVMShaderManager::device_update_shader,
                                  this,
                                  scene,
-                                 scene->shaders[i],
+                                 shader,
                                  &progress,
-                                 &shader_svm_nodes[i]));
+                                 &compiled.svm_nodes));
+    num_compiled++;
   }
   task_pool.wait_work();
 
   if (progress.get_cancel()) {
+    compiled_shaders.clear();
     return;
   }
 
@@ -114,7 +146,7 @@ void SVMShaderManager::device_update_specific(Device *device,
   int svm_nodes_size = num_shaders;
   for (int i = 0; i < num_shaders; i++) {
     /* Since we're not copying the local jump node, the size ends up being one node lower. */
-    svm_nodes_size += shader_svm_nodes[i].size() - 1;
+    svm_nodes_size += shader_svm_nodes[i]->size() - 1;
   }
 
   int4 *svm_nodes = dscene->svm_nodes.alloc(svm_nodes_size);
@@ -132,22 +164,22 @@ void SVMShaderManager::device_update_specific(Device *device,
      * Each compiled shader starts with a jump node that has offsets local
      * to the shader, so copy those and add the offset into the global node list. */
     int4 &global_jump_node = svm_nodes[shader->id];
-    int4 &local_jump_node = shader_svm_nodes[i][0];
+    int4 &local_jump_node = (*shader_svm_nodes[i])[0];
 
     global_jump_node.x = NODE_SHADER_JUMP;
     global_jump_node.y = local_jump_node.y - 1 + node_offset;
     global_jump_node.z = local_jump_node.z - 1 + node_offset;
     global_jump_node.w = local_jump_node.w - 1 + node_offset;
 
-    node_offset += shader_svm_nodes[i].size() - 1;
+    node_offset += shader_svm_nodes[i]->size() - 1;
   }
 
   /* Copy the nodes of each shader into the correct location. */
   svm_nodes += num_shaders;
   for (int i = 0; i < num_shaders; i++) {
-    int shader_size = shader_svm_nodes[i].size() - 1;
+    int shader_size = shader_svm_nodes[i]->size() - 1;
 
-    memcpy(svm_nodes, &shader_svm_nodes[i][1], sizeof(int4) * shader_size);
+    memcpy(svm_nodes, &(*shader_svm_nodes[i])[1], sizeof(int4) * shader_size);
     svm_nodes += shader_size;
   }
 
@@ -161,8 +193,8 @@ void SVMShaderManager::device_update_specific(Device *device,
 
   update_flags = UPDATE_NONE;
 
-  VLOG(1) << "Shader manager updated " << num_shaders << " shaders in " << time_dt() - start_time
-          << " seconds.";
+  VLOG(1) << "Shader manager updated " << num_shaders << " shaders (" << num_compiled
+          << " compiled) in " << time_dt() - start_time << " seconds.";
 }
 
 void SVMShaderManager::device_free(Device *device, DeviceScene *dscene, Scene *scene)
@@ -22,6 +22,7 @@
 #include "scene/shader_graph.h"
 
 #include "util/array.h"
+#include "util/map.h"
 #include "util/set.h"
 #include "util/string.h"
 #include "util/thread.h"
@@ -57,6 +58,15 @@ class SVMShaderManager : public ShaderManager {
                             Shader *shader,
                             Progress *progress,
                             array<int4> *svm_nodes);
+
+  /* Nodes of every shader from the last update, so that only shaders which were modified since
+   * then need to be compiled again. */
+  struct CompiledShader {
+    array<int4> svm_nodes;
+    bool background = false;
+    string aov_layout;
+  };
+  unordered_map<const Shader *, CompiledShader> compiled_shaders;
 };
 
 /* Graph Compiler */
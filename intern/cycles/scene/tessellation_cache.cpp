@@ -0,0 +1,341 @@
+/*
+ * Copyright 2011-2022 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scene/tessellation_cache.h"
+#include "scene/attribute.h"
+#include "scene/camera.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/scene.h"
+#include "scene/shader.h"
+#include "scene/shader_graph.h"
+
+#include "subd/dice.h"
+
+#include "util/foreach.h"
+#include "util/log.h"
+#include "util/md5.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Key */
+
+template<typename T> static void hash_array(MD5Hash &md5, const array<T> &data)
+{
+  const size_t size = data.size();
+  md5.append((const uint8_t *)&size, sizeof(size));
+  if (size) {
+    md5.append((const uint8_t *)data.data(), sizeof(T) * size);
+  }
+}
+
+template<typename T> static void hash_value(MD5Hash &md5, const T &value)
+{
+  md5.append((const uint8_t *)&value, sizeof(T));
+}
+
+static void hash_attributes(MD5Hash &md5, const AttributeSet &attributes)
+{
+  foreach (const Attribute &attr, attributes.attributes) {
+    md5.append(attr.name.string());
+    hash_value(md5, attr.std);
+    hash_value(md5, attr.type);
+    hash_value(md5, attr.element);
+    hash_value(md5, attr.flags);
+    if (attr.element != ATTR_ELEMENT_VOXEL && attr.buffer.size()) {
+      md5.append((const uint8_t *)attr.buffer.data(), attr.buffer.size());
+    }
+  }
+}
+
+TessellationCacheKey::TessellationCacheKey(Scene *scene, Mesh *mesh)
+{
+  SubdParams *subd_params = mesh->get_subd_params();
+
+  MD5Hash md5;
+
+  /* Control mesh. */
+  hash_value(md5, mesh->get_subdivision_type());
+  hash_array(md5, mesh->get_verts());
+  hash_array(md5, mesh->get_subd_start_corner());
+  hash_array(md5, mesh->get_subd_num_corners());
+  hash_array(md5, mesh->get_subd_shader());
+  hash_array(md5, mesh->get_subd_smooth());
+  hash_array(md5, mesh->get_subd_ptex_offset());
+  hash_array(md5, mesh->get_subd_face_corners());
+  hash_value(md5, mesh->get_num_ngons());
+  hash_array(md5, mesh->get_subd_creases_edge());
+  hash_array(md5, mesh->get_subd_creases_weight());
+  hash_value(md5, mesh->transform_negative_scaled);
+  hash_attributes(md5, mesh->attributes);
+  hash_attributes(md5, mesh->subd_attributes);
+
+  /* Dicing parameters. */
+  hash_value(md5, subd_params->dicing_rate);
+  hash_value(md5, subd_params->max_level);
+  hash_value(md5, subd_params->objecttoworld);
+  hash_value(md5, subd_params->camera != nullptr);
+
+  /* Displacement shaders, in the order the shader indices refer to them. */
+  foreach (Node *node, mesh->get_used_shaders()) {
+    Shader *shader = static_cast<Shader *>(node);
+    if (shader->graph && shader->graph->displacement_uses_unhashed_data) {
+      return;
+    }
+    md5.append(shader->name.string());
+    hash_value(md5, shader->get_displacement_method());
+    hash_value(md5, shader->has_displacement);
+    md5.append((shader->graph) ? shader->graph->displacement_hash : "");
+  }
+
+  /* Object inputs that displacement shaders can read, from the same object that displacement is
+   * evaluated with. */
+  foreach (Object *object, scene->objects) {
+    if (object->get_geometry() != mesh) {
+      continue;
+    }
+    if (object->get_particle_system()) {
+      return;
+    }
+    hash_value(md5, object->get_tfm());
+    hash_array(md5, object->get_motion());
+    hash_value(md5, object->get_random_id());
+    hash_value(md5, object->get_pass_id());
+    hash_value(md5, object->get_color());
+    md5.append(object->get_asset_name().string());
+    hash_value(md5, object->get_dupli_generated());
+    hash_value(md5, object->get_dupli_uv());
+    hash_value(md5, object->get_particle_index());
+    break;
+  }
+
+  hash = md5.get_hex();
+
+  /* Raster size at the corners and center of the control mesh bounds. */
+  if (subd_params->camera) {
+    BoundBox bounds = BoundBox::empty;
+    foreach (const float3 &P, mesh->get_verts()) {
+      bounds.grow(P);
+    }
+
+    if (bounds.valid()) {
+      Camera *camera = subd_params->camera;
+      for (int i = 0; i < 9; i++) {
+        const float3 P = (i == 8) ? bounds.center() :
+                                    make_float3((i & 1) ? bounds.max.x : bounds.min.x,
+                                                (i & 2) ? bounds.max.y : bounds.min.y,
+                                                (i & 4) ? bounds.max.z : bounds.min.z);
+        raster_size.push_back(
+            camera->world_to_raster_size(transform_point(&subd_params->objecttoworld, P)));
+      }
+    }
+  }
+}
+
+/* Cache */
+
+struct TessellationCache::Entry {
+  struct CachedAttribute {
+    ustring name;
+    AttributeStandard std;
+    TypeDesc type;
+    AttributeElement element;
+    uint flags;
+    vector<char> buffer;
+  };
+
+  vector<float> raster_size;
+
+  array<float3> verts;
+  array<int> triangles;
+  array<int> shader;
+  array<bool> smooth;
+  array<int> triangle_patch;
+  array<float2> vert_patch_uv;
+  size_t num_subd_verts;
+
+  vector<CachedAttribute> attributes;
+  vector<CachedAttribute> subd_attributes;
+
+  uint64_t last_used;
+};
+
+TessellationCache::TessellationCache() : generation(0), num_restored(0)
+{
+}
+
+TessellationCache::~TessellationCache()
+{
+}
+
+static bool raster_size_match(const vector<float> &a, const vector<float> &b, const float tolerance)
+{
+  if (a.size() != b.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < a.size(); i++) {
+    if (fabsf(a[i] - b[i]) > tolerance * max(fabsf(a[i]), fabsf(b[i]))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template<typename CachedAttribute>
+static void store_attributes(vector<CachedAttribute> &cached, const AttributeSet &attributes)
+{
+  cached.clear();
+  cached.reserve(attributes.attributes.size());
+
+  foreach (const Attribute &attr, attributes.attributes) {
+    CachedAttribute cattr;
+    cattr.name = attr.name;
+    cattr.std = attr.std;
+    cattr.type = attr.type;
+    cattr.element = attr.element;
+    cattr.flags = attr.flags;
+    cattr.buffer = attr.buffer;
+    cached.push_back(std::move(cattr));
+  }
+}
+
+template<typename CachedAttribute>
+static void restore_attributes(AttributeSet &attributes, const vector<CachedAttribute> &cached)
+{
+  foreach (const CachedAttribute &cattr, cached) {
+    Attribute *attr = attributes.add(cattr.name, cattr.type, cattr.element);
+    attr->std = cattr.std;
+    attr->flags = cattr.flags;
+    attr->buffer = cattr.buffer;
+    attr->modified = true;
+    attributes.tag_modified(*attr);
+  }
+}
+
+void TessellationCache::begin_update()
+{
+  thread_scoped_lock lock(mutex);
+
+  generation++;
+  num_restored = 0;
+
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (it->second.last_used + 1 < generation) {
+      it = entries.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
+bool TessellationCache::restore(const TessellationCacheKey &key,
+                                const float tolerance,
+                                Mesh *mesh)
+{
+  thread_scoped_lock lock(mutex);
+
+  auto it = entries.find(key.hash);
+  if (it == entries.end()) {
+    return false;
+  }
+
+  Entry &entry = it->second;
+  if (!raster_size_match(entry.raster_size, key.raster_size, tolerance)) {
+    VLOG(1) << "Tessellation cache: dicing camera changed for mesh " << mesh->name;
+    entries.erase(it);
+    return false;
+  }
+
+  /* Setters take ownership of the array, so hand them copies. */
+  array<float3> verts = entry.verts;
+  array<int> triangles = entry.triangles;
+  array<int> shader = entry.shader;
+  array<bool> smooth = entry.smooth;
+  array<int> triangle_patch = entry.triangle_patch;
+  array<float2> vert_patch_uv = entry.vert_patch_uv;
+
+  mesh->set_verts(verts);
+  mesh->set_triangles(triangles);
+  mesh->set_shader(shader);
+  mesh->set_smooth(smooth);
+  mesh->set_triangle_patch(triangle_patch);
+  mesh->set_vert_patch_uv(vert_patch_uv);
+  mesh->num_subd_verts = entry.num_subd_verts;
+
+  restore_attributes(mesh->attributes, entry.attributes);
+  restore_attributes(mesh->subd_attributes, entry.subd_attributes);
+
+  entry.last_used = generation;
+  num_restored++;
+
+  VLOG(1) << "Tessellation cache: reusing " << entry.triangles.size() / 3
+          << " triangles for mesh " << mesh->name;
+
+  return true;
+}
+
+void TessellationCache::store(const TessellationCacheKey &key, Mesh *mesh)
+{
+  /* Subdivided attributes are evaluated from patch tables that are rebuilt along with the
+   * tessellation, these meshes are not cached. */
+  if (mesh->patch_table) {
+    return;
+  }
+
+  foreach (const Attribute &attr, mesh->attributes.attributes) {
+    if (attr.element == ATTR_ELEMENT_VOXEL) {
+      return;
+    }
+  }
+
+  thread_scoped_lock lock(mutex);
+
+  Entry &entry = entries[key.hash];
+  entry.raster_size = key.raster_size;
+  entry.verts = mesh->get_verts();
+  entry.triangles = mesh->get_triangles();
+  entry.shader = mesh->get_shader();
+  entry.smooth = mesh->get_smooth();
+  entry.triangle_patch = mesh->get_triangle_patch();
+  entry.vert_patch_uv = mesh->get_vert_patch_uv();
+  entry.num_subd_verts = mesh->num_subd_verts;
+  store_attributes(entry.attributes, mesh->attributes);
+  store_attributes(entry.subd_attributes, mesh->subd_attributes);
+  entry.last_used = generation;
+}
+
+void TessellationCache::clear()
+{
+  thread_scoped_lock lock(mutex);
+  entries.clear();
+}
+
+size_t TessellationCache::size()
+{
+  thread_scoped_lock lock(mutex);
+  return entries.size();
+}
+
+size_t TessellationCache::get_num_restored()
+{
+  thread_scoped_lock lock(mutex);
+  return num_restored;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2011-2022 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __TESSELLATION_CACHE_H__
+#define __TESSELLATION_CACHE_H__
+
+#include "util/array.h"
+#include "util/map.h"
+#include "util/string.h"
+#include "util/thread.h"
+#include "util/types.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class Mesh;
+class Scene;
+
+/* Tessellation Cache Key
+ *
+ * Identifies the inputs of adaptive subdivision and displacement for a mesh. The hash covers the
+ * control mesh, its attributes, the displacement shaders, the object inputs they can read and the
+ * dicing parameters, and must match exactly. The raster size of the dicing camera at points on
+ * the mesh bounds is compared with a tolerance instead, so small camera changes between frames
+ * can still reuse the result.
+ *
+ * Must be computed before the mesh is tessellated. */
+
+struct TessellationCacheKey {
+  /* Empty when the displacement reads data that can not be hashed, the mesh is not cached then. */
+  string hash;
+  vector<float> raster_size;
+
+  TessellationCacheKey() = default;
+  TessellationCacheKey(Scene *scene, Mesh *mesh);
+
+  bool empty() const
+  {
+    return hash.empty();
+  }
+};
+
+/* Tessellation Cache
+ *
+ * Diced and displaced meshes of a scene, reused when meshes are tessellated again with unchanged
+ * inputs, like after small camera changes or in following frames of an animation rendered with
+ * persistent data. Only entries used by the previous scene update are kept. */
+
+class TessellationCache {
+ public:
+  TessellationCache();
+  ~TessellationCache();
+
+  /* Start a scene update, evicting entries which were not used by the previous one. */
+  void begin_update();
+
+  /* Replace the control mesh with its cached tessellated and displaced mesh. Returns false if no
+   * entry exists, or the dicing camera changed more than the relative tolerance. */
+  bool restore(const TessellationCacheKey &key, const float tolerance, Mesh *mesh);
+
+  /* Store the mesh after tessellation and displacement. */
+  void store(const TessellationCacheKey &key, Mesh *mesh);
+
+  void clear();
+
+  size_t size();
+
+  /* Number of meshes restored since the start of the last update. */
+  size_t get_num_restored();
+
+ protected:
+  struct Entry;
+
+  thread_mutex mutex;
+  unordered_map<string, Entry> entries;
+  uint64_t generation;
+  size_t num_restored;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __TESSELLATION_CACHE_H__ */
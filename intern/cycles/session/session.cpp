@@ -421,6 +421,7 @@ void Session::do_delayed_reset()
 
   /* Update for new state of scene and passes. */
   buffer_params_.update_passes(scene->passes);
+  tile_manager_.set_use_streaming(params.use_tile_streaming);
   tile_manager_.update(buffer_params_, scene);
 
   /* Progress. */
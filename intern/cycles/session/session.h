@@ -67,6 +67,11 @@ class SessionParams {
   bool use_auto_tile;
   int tile_size;
 
+  /* Write finished tiles directly to the output driver, instead of collecting them in a file on
+   * disk and writing the full frame once all tiles are rendered. Denoising is then done per tile,
+   * so that no full-frame buffer is ever allocated. */
+  bool use_tile_streaming;
+
   ShadingSystem shadingsystem;
 
   SessionParams()
@@ -85,6 +90,7 @@ class SessionParams {
 
     use_auto_tile = true;
     tile_size = 2048;
+    use_tile_streaming = false;
 
     shadingsystem = SHADINGSYSTEM_SVM;
   }
@@ -97,7 +103,8 @@ class SessionParams {
              background == params.background && experimental == params.experimental &&
              pixel_size == params.pixel_size && threads == params.threads &&
              use_profiling == params.use_profiling && shadingsystem == params.shadingsystem &&
-             use_auto_tile == params.use_auto_tile && tile_size == params.tile_size);
+             use_auto_tile == params.use_auto_tile && tile_size == params.tile_size &&
+             use_tile_streaming == params.use_tile_streaming);
   }
 };
 
@@ -369,15 +369,21 @@ void TileManager::update(const BufferParams &params, const Scene *scene)
   buffer_params_ = params;
 
   if (has_multiple_tiles()) {
-    /* TODO(sergey): Proper Error handling, so that if configuration has failed we don't attempt to
-     * write to a partially configured file. */
-    configure_image_spec_from_buffer(&write_state_.image_spec, buffer_params_, tile_size_);
-
     const DenoiseParams denoise_params = scene->integrator->get_denoise_params();
     const AdaptiveSampling adaptive_sampling = scene->integrator->get_adaptive_sampling();
 
-    node_to_image_spec_atttributes(
-        &write_state_.image_spec, &denoise_params, ATTR_DENOISE_SOCKET_PREFIX);
+    if (is_streaming()) {
+      /* Tiles are written to the output driver directly, no tile file is used. */
+      write_state_.image_spec = ImageSpec();
+    }
+    else {
+      /* TODO(sergey): Proper Error handling, so that if configuration has failed we don't attempt
+       * to write to a partially configured file. */
+      configure_image_spec_from_buffer(&write_state_.image_spec, buffer_params_, tile_size_);
+
+      node_to_image_spec_atttributes(
+          &write_state_.image_spec, &denoise_params, ATTR_DENOISE_SOCKET_PREFIX);
+    }
 
     if (adaptive_sampling.use) {
       overscan_ = 4;
@@ -385,6 +391,12 @@ void TileManager::update(const BufferParams &params, const Scene *scene)
     else {
       overscan_ = 0;
     }
+
+    /* Tiles are denoised on their own when streaming. Render extra pixels around them, so that
+     * the denoiser has the same context at both sides of tile boundaries and seams are avoided. */
+    if (is_streaming() && denoise_params.use) {
+      overscan_ = max(overscan_, STREAMING_DENOISE_OVERSCAN);
+    }
   }
   else {
     write_state_.image_spec = ImageSpec();
@@ -392,6 +404,11 @@ void TileManager::update(const BufferParams &params, const Scene *scene)
   }
 }
 
+void TileManager::set_use_streaming(bool use_streaming)
+{
+  use_streaming_ = use_streaming;
+}
+
 bool TileManager::done()
 {
   return tile_state_.next_tile_index == tile_state_.num_tiles;
@@ -498,6 +515,8 @@ bool TileManager::close_tile_output()
 
 bool TileManager::write_tile(const RenderBuffers &tile_buffers)
 {
+  DCHECK(!is_streaming());
+
   if (!write_state_.tile_out) {
     if (!open_tile_output()) {
       return false;
@@ -86,6 +86,15 @@ class TileManager {
     return overscan_;
   }
 
+  /* Streaming writes every finished tile to the output driver, without the on-disk tile file.
+   * Only has an effect when there are multiple tiles. */
+  void set_use_streaming(bool use_streaming);
+
+  inline bool is_streaming() const
+  {
+    return use_streaming_ && has_multiple_tiles();
+  }
+
   bool next();
   bool done();
 
@@ -122,6 +131,9 @@ class TileManager {
   /* Tile size in the image file. */
   static const int IMAGE_TILE_SIZE = 128;
 
+  /* Number of extra pixels rendered around tiles which are denoised on their own. */
+  static const int STREAMING_DENOISE_OVERSCAN = 32;
+
  protected:
   /* Get tile configuration for its index.
    * The tile index must be within [0, state_.tile_state_). */
@@ -139,6 +151,8 @@ class TileManager {
   /* Number of extra pixels around the actual tile to render. */
   int overscan_ = 0;
 
+  bool use_streaming_ = false;
+
   BufferParams buffer_params_;
 
   /* Tile scheduling state. */
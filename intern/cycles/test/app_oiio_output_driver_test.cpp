@@ -0,0 +1,150 @@
+/*
+ * Copyright 2011-2022 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include <cstdio>
+
+#include "app/oiio_output_driver.h"
+
+#include "session/tile.h"
+
+#include "util/hash.h"
+#include "util/path.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Render tile filled with noise, which does not compress. Tiles buffered by the image writer
+ * would then take as much memory as uncompressed pixels. */
+class NoiseTile : public OutputDriver::Tile {
+ public:
+  NoiseTile(const int2 offset, const int2 size, const int2 full_size)
+      : Tile(offset, size, full_size, "", "")
+  {
+  }
+
+  bool get_pass_pixels(const string_view /*pass_name*/,
+                       const int num_channels,
+                       float *pixels) const override
+  {
+    const uint seed = hash_uint2(offset.x, offset.y);
+    const int num_values = size.x * size.y * num_channels;
+    for (int i = 0; i < num_values; i++) {
+      pixels[i] = hash_uint2_to_float(seed, i);
+    }
+    return true;
+  }
+
+  bool set_pass_pixels(const string_view /*pass_name*/,
+                       const int /*num_channels*/,
+                       const float * /*pixels*/) const override
+  {
+    return false;
+  }
+};
+
+#ifdef __linux__
+/* Reset the peak resident memory of the process to the current resident memory. */
+bool process_peak_memory_reset()
+{
+  FILE *file = fopen("/proc/self/clear_refs", "w");
+  if (file == nullptr) {
+    return false;
+  }
+  const bool ok = (fputs("5", file) >= 0);
+  return (fclose(file) == 0) && ok;
+}
+
+/* Memory field of the process status in bytes, or zero if unknown. */
+size_t process_status_memory(const char *field)
+{
+  FILE *file = fopen("/proc/self/status", "r");
+  if (file == nullptr) {
+    return 0;
+  }
+
+  const string format = string(field) + ": %llu kB";
+  size_t memory = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    unsigned long long kb;
+    if (sscanf(line, format.c_str(), &kb) == 1) {
+      memory = size_t(kb) * 1024;
+      break;
+    }
+  }
+
+  fclose(file);
+  return memory;
+}
+#endif
+
+}  // namespace
+
+#ifdef __linux__
+TEST(app_oiio_output_driver, streaming_peak_memory)
+{
+  /* Frame of 256 MB, with a height that is not a multiple of the tile size so that the data
+   * window padding is used too. */
+  const int width = 4096;
+  const int height = 4000;
+  const int tile_size = 256;
+  const size_t frame_bytes = size_t(width) * height * 4 * sizeof(float);
+  const size_t tile_bytes = size_t(tile_size) * tile_size * 4 * sizeof(float);
+
+  const string filepath = path_temp_get("cycles_test_streaming_output.exr");
+
+  OIIOOutputDriver driver(filepath, "combined", [](const string &) {});
+  driver.set_streaming_tile_size(tile_size);
+
+  if (!process_peak_memory_reset()) {
+    GTEST_SKIP();
+  }
+  const size_t memory_begin = process_status_memory("VmRSS");
+
+  /* Tiles are written in the order the tile manager renders them, from the bottom of the image,
+   * which is the end of the file. */
+  for (int y = 0; y < height; y += tile_size) {
+    for (int x = 0; x < width; x += tile_size) {
+      const int2 offset = make_int2(x, y);
+      const int2 size = make_int2(min(tile_size, width - x), min(tile_size, height - y));
+      driver.write_render_tile(NoiseTile(offset, size, make_int2(width, height)));
+    }
+  }
+
+  const size_t memory_peak = process_status_memory("VmHWM");
+
+  /* Leave room for the tile pixels, their flipped copy and the buffers and threads of the image
+   * writer, which is still far less than the full frame. */
+  EXPECT_LT(memory_peak - memory_begin, tile_bytes * 32);
+  EXPECT_LT(tile_bytes * 32, frame_bytes / 4);
+
+  /* All tiles were written and the file was closed. */
+  unique_ptr<ImageInput> in(ImageInput::open(filepath));
+  ASSERT_NE(in, nullptr);
+  const ImageSpec &spec = in->spec();
+  EXPECT_EQ(spec.full_width, width);
+  EXPECT_EQ(spec.full_height, height);
+  EXPECT_EQ(spec.tile_width, TileManager::IMAGE_TILE_SIZE);
+  in->close();
+
+  path_remove(filepath);
+}
+#endif
+
+CCL_NAMESPACE_END
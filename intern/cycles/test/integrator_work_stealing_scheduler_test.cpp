@@ -0,0 +1,107 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "integrator/work_stealing_scheduler.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(WorkStealingScheduler, NoStealing)
+{
+  WorkStealingScheduler scheduler;
+  scheduler.reset({100, 100}, 8, 16, false);
+
+  int start_sample, samples_num, victim_index;
+
+  /* Without stealing every work gets its entire sample range at once. */
+  EXPECT_TRUE(scheduler.get_work(0, &start_sample, &samples_num));
+  EXPECT_EQ(start_sample, 8);
+  EXPECT_EQ(samples_num, 16);
+  EXPECT_FALSE(scheduler.get_work(0, &start_sample, &samples_num));
+
+  /* The samples of the other work are scheduled in one go too, leaving nothing to steal once
+   * it has started. */
+  EXPECT_TRUE(scheduler.get_work(1, &start_sample, &samples_num));
+  EXPECT_EQ(samples_num, 16);
+  EXPECT_FALSE(scheduler.steal_work(0, &victim_index, &start_sample, &samples_num));
+}
+
+TEST(WorkStealingScheduler, StealFromEnd)
+{
+  WorkStealingScheduler scheduler;
+  scheduler.reset({100, 100}, 0, 16, true);
+
+  int start_sample, samples_num, victim_index;
+
+  /* Work 1 takes its first chunk from the start of the range. */
+  EXPECT_TRUE(scheduler.get_work(1, &start_sample, &samples_num));
+  EXPECT_EQ(start_sample, 0);
+  EXPECT_EQ(samples_num, 4);
+
+  /* Work 0 finishes its own samples. */
+  while (scheduler.get_work(0, &start_sample, &samples_num)) {
+  }
+
+  /* Equally sized slices: half of the remaining samples of work 1 are stolen from the end. */
+  EXPECT_TRUE(scheduler.steal_work(0, &victim_index, &start_sample, &samples_num));
+  EXPECT_EQ(victim_index, 1);
+  EXPECT_EQ(start_sample, 10);
+  EXPECT_EQ(samples_num, 6);
+
+  /* Work 1 continues with the samples it still owns. */
+  EXPECT_TRUE(scheduler.get_work(1, &start_sample, &samples_num));
+  EXPECT_EQ(start_sample, 4);
+  EXPECT_EQ(samples_num, 4);
+  EXPECT_TRUE(scheduler.get_work(1, &start_sample, &samples_num));
+  EXPECT_EQ(start_sample, 8);
+  EXPECT_EQ(samples_num, 2);
+  EXPECT_FALSE(scheduler.get_work(1, &start_sample, &samples_num));
+
+  EXPECT_EQ(scheduler.get_statistics(0).samples_stolen, 6);
+  EXPECT_EQ(scheduler.get_statistics(1).samples_lost, 6);
+  EXPECT_EQ(scheduler.get_statistics(1).samples_rendered, 10);
+}
+
+TEST(WorkStealingScheduler, SlowThief)
+{
+  WorkStealingScheduler scheduler;
+
+  /* The thief has a slice 4 times smaller than the victim, so it renders a sample of the victim
+   * slice 4 times slower than the victim itself. */
+  scheduler.reset({100, 400}, 0, 20, true);
+
+  int start_sample, samples_num, victim_index;
+
+  EXPECT_TRUE(scheduler.get_work(1, &start_sample, &samples_num));
+  EXPECT_EQ(samples_num, 5);
+  while (scheduler.get_work(0, &start_sample, &samples_num)) {
+  }
+
+  EXPECT_TRUE(scheduler.steal_work(0, &victim_index, &start_sample, &samples_num));
+  EXPECT_EQ(victim_index, 1);
+  EXPECT_EQ(samples_num, 3);
+  EXPECT_EQ(start_sample, 17);
+
+  /* Stealing stops once the remaining samples are not worth it. */
+  scheduler.reset({100, 400}, 0, 4, true);
+  EXPECT_TRUE(scheduler.get_work(1, &start_sample, &samples_num));
+  while (scheduler.get_work(0, &start_sample, &samples_num)) {
+  }
+  EXPECT_FALSE(scheduler.steal_work(0, &victim_index, &start_sample, &samples_num));
+}
+
+CCL_NAMESPACE_END
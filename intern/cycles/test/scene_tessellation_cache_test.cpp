@@ -0,0 +1,223 @@
+/*
+ * Copyright 2011-2022 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+
+#include "scene/camera.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/scene.h"
+#include "scene/tessellation_cache.h"
+
+#include "util/progress.h"
+#include "util/stats.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+TessellationCacheKey make_key(const string &hash, const float raster_size)
+{
+  TessellationCacheKey key;
+  key.hash = hash;
+  key.raster_size.push_back(raster_size);
+  key.raster_size.push_back(raster_size * 2.0f);
+  return key;
+}
+
+/* Single triangle, standing in for the result of tessellation. */
+void make_triangle(Mesh &mesh, const float z)
+{
+  mesh.reserve_mesh(3, 1);
+  mesh.add_vertex(make_float3(0.0f, 0.0f, z));
+  mesh.add_vertex(make_float3(1.0f, 0.0f, z));
+  mesh.add_vertex(make_float3(0.0f, 1.0f, z));
+  mesh.add_triangle(0, 1, 2, 0, true);
+}
+
+/* Control mesh of a single quad with adaptive subdivision, exported again for every update like
+ * a host application does. */
+void make_subd_quad(Scene *scene, Mesh *mesh)
+{
+  mesh->clear(true);
+  mesh->set_subdivision_type(Mesh::SUBDIVISION_LINEAR);
+
+  array<float3> verts;
+  verts.push_back_slow(make_float3(-1.0f, -1.0f, 0.0f));
+  verts.push_back_slow(make_float3(1.0f, -1.0f, 0.0f));
+  verts.push_back_slow(make_float3(1.0f, 1.0f, 0.0f));
+  verts.push_back_slow(make_float3(-1.0f, 1.0f, 0.0f));
+  mesh->set_verts(verts);
+
+  int corners[4] = {0, 1, 2, 3};
+  mesh->reserve_subd_faces(1, 0, 4);
+  mesh->add_subd_face(corners, 4, 0, true);
+
+  mesh->set_subd_dicing_rate(8.0f);
+  mesh->set_subd_objecttoworld(transform_identity());
+
+  mesh->tag_update(scene, true);
+}
+
+}  // namespace
+
+TEST(scene_tessellation_cache, restore)
+{
+  TessellationCache cache;
+  cache.begin_update();
+
+  Mesh stored_mesh;
+  make_triangle(stored_mesh, 2.0f);
+  cache.store(make_key("a", 10.0f), &stored_mesh);
+
+  Mesh mesh;
+  EXPECT_FALSE(cache.restore(make_key("b", 10.0f), 0.1f, &mesh));
+
+  EXPECT_TRUE(cache.restore(make_key("a", 10.0f), 0.0f, &mesh));
+  ASSERT_EQ(mesh.get_verts().size(), 3);
+  EXPECT_EQ(mesh.get_verts()[0].z, 2.0f);
+  EXPECT_EQ(mesh.num_triangles(), 1);
+}
+
+TEST(scene_tessellation_cache, tolerance)
+{
+  TessellationCache cache;
+  cache.begin_update();
+
+  Mesh stored_mesh;
+  make_triangle(stored_mesh, 0.0f);
+  cache.store(make_key("a", 10.0f), &stored_mesh);
+
+  /* Raster size changed by 5%, within the tolerance. */
+  Mesh mesh;
+  EXPECT_TRUE(cache.restore(make_key("a", 10.5f), 0.1f, &mesh));
+
+  /* Raster size changed by 20%, the entry is outdated and removed. */
+  EXPECT_FALSE(cache.restore(make_key("a", 12.0f), 0.1f, &mesh));
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_FALSE(cache.restore(make_key("a", 10.0f), 0.1f, &mesh));
+}
+
+TEST(scene_tessellation_cache, eviction)
+{
+  TessellationCache cache;
+  cache.begin_update();
+
+  Mesh stored_mesh;
+  make_triangle(stored_mesh, 0.0f);
+  cache.store(make_key("a", 10.0f), &stored_mesh);
+  cache.store(make_key("b", 10.0f), &stored_mesh);
+
+  /* Entries stored in the previous update are kept. */
+  cache.begin_update();
+  EXPECT_EQ(cache.size(), 2);
+
+  Mesh mesh;
+  EXPECT_TRUE(cache.restore(make_key("a", 10.0f), 0.0f, &mesh));
+
+  /* Entries not used by the previous update are evicted. */
+  cache.begin_update();
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_TRUE(cache.restore(make_key("a", 10.0f), 0.0f, &mesh));
+  EXPECT_FALSE(cache.restore(make_key("b", 10.0f), 0.0f, &mesh));
+
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(scene_tessellation_cache, separate_caches)
+{
+  /* Caches of different scenes do not evict or clear each others entries. */
+  TessellationCache cache_a, cache_b;
+  cache_a.begin_update();
+
+  Mesh stored_mesh;
+  make_triangle(stored_mesh, 0.0f);
+  cache_a.store(make_key("a", 10.0f), &stored_mesh);
+
+  cache_b.begin_update();
+  cache_b.begin_update();
+  cache_b.clear();
+
+  Mesh mesh;
+  EXPECT_TRUE(cache_a.restore(make_key("a", 10.0f), 0.0f, &mesh));
+}
+
+class TessellationCacheUpdate : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device_cpu;
+  SceneParams scene_params;
+  Scene *scene;
+  Progress progress;
+
+  virtual void SetUp()
+  {
+    device_cpu = Device::create(device_info, stats, profiler);
+    scene_params.use_tessellation_cache = true;
+    scene = new Scene(scene_params, device_cpu);
+  }
+
+  virtual void TearDown()
+  {
+    delete scene;
+    delete device_cpu;
+  }
+};
+
+TEST_F(TessellationCacheUpdate, restore_across_updates)
+{
+  Mesh *mesh = scene->create_node<Mesh>();
+  array<Node *> used_shaders;
+  used_shaders.push_back_slow(scene->default_surface);
+  mesh->set_used_shaders(used_shaders);
+
+  Object *object = scene->create_node<Object>();
+  object->set_geometry(mesh);
+  object->set_tfm(transform_identity());
+
+  /* First frame is diced and stored. */
+  scene->dicing_camera->set_matrix(transform_translate(0.0f, 0.0f, -5.0f));
+  make_subd_quad(scene, mesh);
+  scene->update(progress);
+
+  EXPECT_EQ(scene->tessellation_cache->get_num_restored(), 0);
+  EXPECT_EQ(scene->tessellation_cache->size(), 1);
+  const size_t num_triangles = mesh->num_triangles();
+  EXPECT_GT(num_triangles, 2);
+
+  /* Next frame moves the dicing camera a little, the mesh is restored. */
+  scene->dicing_camera->set_matrix(transform_translate(0.0f, 0.0f, -5.05f));
+  make_subd_quad(scene, mesh);
+  scene->update(progress);
+
+  EXPECT_EQ(scene->tessellation_cache->get_num_restored(), 1);
+  EXPECT_EQ(mesh->num_triangles(), num_triangles);
+
+  /* Dicing camera moved far away, the mesh is diced again. */
+  scene->dicing_camera->set_matrix(transform_translate(0.0f, 0.0f, -50.0f));
+  make_subd_quad(scene, mesh);
+  scene->update(progress);
+
+  EXPECT_EQ(scene->tessellation_cache->get_num_restored(), 0);
+  EXPECT_LT(mesh->num_triangles(), num_triangles);
+}
+
+CCL_NAMESPACE_END
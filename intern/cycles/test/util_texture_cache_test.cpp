@@ -0,0 +1,206 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "util/texture_cache.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Single channel float image where each pixel stores its own index, only level 0 is provided
+ * so other levels are generated by the cache. */
+bool load_index_tile(int level, int x, int y, int w, int h, void *pixels, int width, int *loads)
+{
+  if (level != 0) {
+    return false;
+  }
+
+  float *data = (float *)pixels;
+  for (int j = 0; j < h; j++) {
+    for (int i = 0; i < w; i++) {
+      data[j * w + i] = (float)((y + j) * width + (x + i));
+    }
+  }
+
+  (*loads)++;
+  return true;
+}
+
+void release_loader(int *releases)
+{
+  (*releases)++;
+}
+
+float read_pixel(TextureCacheImage *image, int level, int x, int y)
+{
+  const int tile_size_log2 = image->tile_size_log2;
+  const int tile_mask = (1 << tile_size_log2) - 1;
+
+  TextureCacheTile *tile = image->acquire_tile(level, x >> tile_size_log2, y >> tile_size_log2);
+  const float value = ((const float *)
+                           tile->pixels)[((y & tile_mask) << tile_size_log2) + (x & tile_mask)];
+  TextureCacheImage::release_tile(tile);
+
+  return value;
+}
+
+}  // namespace
+
+TEST(util_texture_cache, tile_size)
+{
+  EXPECT_EQ(TextureCache::tile_size_log2(IMAGE_DATA_TYPE_FLOAT4), 6);
+  EXPECT_EQ(TextureCache::tile_size_log2(IMAGE_DATA_TYPE_HALF4), 6);
+  EXPECT_EQ(TextureCache::tile_size_log2(IMAGE_DATA_TYPE_BYTE4), 7);
+  EXPECT_EQ(TextureCache::tile_size_log2(IMAGE_DATA_TYPE_FLOAT), 7);
+  EXPECT_EQ(TextureCache::tile_size_log2(IMAGE_DATA_TYPE_BYTE), 8);
+}
+
+TEST(util_texture_cache, load_on_demand)
+{
+  const int width = 300, height = 200;
+  int loads = 0, releases = 0;
+
+  TextureCache cache(16 * TEXTURE_CACHE_TILE_BYTES);
+  TextureCacheImage *image = cache.add_image(
+      IMAGE_DATA_TYPE_FLOAT,
+      width,
+      height,
+      function_bind(load_index_tile, _1, _2, _3, _4, _5, _6, width, &loads),
+      function_bind(release_loader, &releases));
+
+  EXPECT_EQ(image->num_levels, 9);
+  EXPECT_EQ(loads, 0);
+
+  /* Pixels in the last partial tile, which is loaded with a smaller row stride. */
+  EXPECT_EQ(read_pixel(image, 0, 299, 199), 199.0f * width + 299.0f);
+  EXPECT_EQ(read_pixel(image, 0, 260, 130), 130.0f * width + 260.0f);
+  EXPECT_EQ(loads, 1);
+
+  EXPECT_EQ(read_pixel(image, 0, 0, 0), 0.0f);
+  EXPECT_EQ(read_pixel(image, 0, 5, 7), 7.0f * width + 5.0f);
+  EXPECT_EQ(loads, 2);
+
+  cache.remove_image(image);
+}
+
+TEST(util_texture_cache, mipmap)
+{
+  const int width = 256, height = 256;
+  int loads = 0, releases = 0;
+
+  TextureCache cache(64 * TEXTURE_CACHE_TILE_BYTES);
+  TextureCacheImage *image = cache.add_image(
+      IMAGE_DATA_TYPE_FLOAT,
+      width,
+      height,
+      function_bind(load_index_tile, _1, _2, _3, _4, _5, _6, width, &loads),
+      function_bind(release_loader, &releases));
+
+  /* Average of the 2x2 pixels (2, 2), (3, 2), (2, 3) and (3, 3). */
+  const float expected = (2.0f * width + 2.0f + 2.0f * width + 3.0f + 3.0f * width + 2.0f +
+                          3.0f * width + 3.0f) *
+                         0.25f;
+  EXPECT_EQ(read_pixel(image, 1, 1, 1), expected);
+  EXPECT_EQ(image->get_level(1).width, 128);
+  EXPECT_EQ(image->get_level(image->num_levels - 1).width, 1);
+
+  cache.remove_image(image);
+}
+
+TEST(util_texture_cache, eviction)
+{
+  const int width = 1024, height = 1024;
+  int loads = 0, releases = 0;
+
+  /* Budget of 4 tiles for an image of 64 tiles, in addition to the open loader which keeps a
+   * strip of 128 full width rows. */
+  const size_t open_bytes = width * 128 * sizeof(float) + TEXTURE_CACHE_TILE_BYTES;
+  TextureCache cache(4 * TEXTURE_CACHE_TILE_BYTES + open_bytes);
+  TextureCacheImage *image = cache.add_image(
+      IMAGE_DATA_TYPE_FLOAT,
+      width,
+      height,
+      function_bind(load_index_tile, _1, _2, _3, _4, _5, _6, width, &loads),
+      function_bind(release_loader, &releases));
+
+  for (int y = 0; y < height; y += 128) {
+    for (int x = 0; x < width; x += 128) {
+      EXPECT_EQ(read_pixel(image, 0, x + 1, y + 2), (y + 2.0f) * width + x + 1.0f);
+    }
+  }
+
+  const TextureCache::Stats stats = cache.get_stats();
+  EXPECT_EQ(stats.tiles_loaded, 64);
+  EXPECT_EQ(stats.tiles_evicted, 60);
+  EXPECT_EQ(stats.mem_peak, 4 * TEXTURE_CACHE_TILE_BYTES + open_bytes);
+
+  /* Recently used tile is still resident. */
+  read_pixel(image, 0, width - 1, height - 1);
+  EXPECT_EQ(loads, 64);
+
+  /* The loader is only released with the image. */
+  EXPECT_EQ(releases, 0);
+  cache.remove_image(image);
+  EXPECT_EQ(releases, 1);
+}
+
+TEST(util_texture_cache, release_loader)
+{
+  const int width = 1024, height = 1024;
+  int loads_a = 0, loads_b = 0, releases_a = 0, releases_b = 0;
+
+  /* Open loaders may use half of the budget, which fits only one of the two images. */
+  const size_t open_bytes = width * 128 * sizeof(float) + TEXTURE_CACHE_TILE_BYTES;
+  TextureCache cache(3 * open_bytes);
+  TextureCacheImage *image_a = cache.add_image(
+      IMAGE_DATA_TYPE_FLOAT,
+      width,
+      height,
+      function_bind(load_index_tile, _1, _2, _3, _4, _5, _6, width, &loads_a),
+      function_bind(release_loader, &releases_a));
+  TextureCacheImage *image_b = cache.add_image(
+      IMAGE_DATA_TYPE_FLOAT,
+      width,
+      height,
+      function_bind(load_index_tile, _1, _2, _3, _4, _5, _6, width, &loads_b),
+      function_bind(release_loader, &releases_b));
+
+  read_pixel(image_a, 0, 0, 0);
+  EXPECT_EQ(releases_a, 0);
+
+  /* Least recently used loader is released when another image is loaded. */
+  read_pixel(image_b, 0, 0, 0);
+  EXPECT_EQ(releases_a, 1);
+  EXPECT_EQ(releases_b, 0);
+
+  /* Resident tiles are read without reopening the loader. */
+  read_pixel(image_a, 0, 1, 1);
+  EXPECT_EQ(loads_a, 1);
+  EXPECT_EQ(releases_b, 0);
+
+  read_pixel(image_a, 0, 512, 512);
+  EXPECT_EQ(loads_a, 2);
+  EXPECT_EQ(releases_b, 1);
+
+  cache.remove_image(image_a);
+  cache.remove_image(image_b);
+  EXPECT_EQ(releases_a, 2);
+  EXPECT_EQ(releases_b, 1);
+}
+
+CCL_NAMESPACE_END
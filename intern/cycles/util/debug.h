@@ -79,6 +79,10 @@ class DebugFlags {
      * CPUs and GPUs can be selected here instead.
      */
     BVHLayout bvh_layout;
+
+    /* Use wavefront path tracing, where paths are batched by the next kernel to execute,
+     * instead of the megakernel. */
+    bool wavefront;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/mapped_file.h"
+#include "util/vector.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#  include "util/windows.h"
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : data_(nullptr), size_(0), file_handle_(INVALID_HANDLE_VALUE), mapping_handle_(nullptr)
+{
+}
+
+bool MappedFile::open(const string &filepath)
+{
+  close();
+
+  file_handle_ = CreateFileW(string_to_wstring(filepath).c_str(),
+                             GENERIC_READ,
+                             FILE_SHARE_READ | FILE_SHARE_DELETE,
+                             nullptr,
+                             OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL,
+                             nullptr);
+  if (file_handle_ == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file_handle_, &file_size) || file_size.QuadPart == 0) {
+    close();
+    return false;
+  }
+
+  mapping_handle_ = CreateFileMappingW(file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_handle_ == nullptr) {
+    close();
+    return false;
+  }
+
+  data_ = (uint8_t *)MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0);
+  if (data_ == nullptr) {
+    close();
+    return false;
+  }
+
+  size_ = (size_t)file_size.QuadPart;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_handle_) {
+    CloseHandle(mapping_handle_);
+  }
+  if (file_handle_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(file_handle_);
+  }
+
+  data_ = nullptr;
+  size_ = 0;
+  file_handle_ = INVALID_HANDLE_VALUE;
+  mapping_handle_ = nullptr;
+}
+
+size_t MappedFile::resident_size() const
+{
+  return size_;
+}
+
+#else /* _WIN32 */
+
+MappedFile::MappedFile() : data_(nullptr), size_(0)
+{
+}
+
+bool MappedFile::open(const string &filepath)
+{
+  close();
+
+  const int fd = ::open(filepath.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+
+  /* The mapping stays valid after closing the file descriptor. */
+  void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  data_ = (uint8_t *)data;
+  size_ = st.st_size;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (data_) {
+    munmap(data_, size_);
+  }
+
+  data_ = nullptr;
+  size_ = 0;
+}
+
+size_t MappedFile::resident_size() const
+{
+  if (!data_) {
+    return 0;
+  }
+
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t num_pages = (size_ + page_size - 1) / page_size;
+
+#  ifdef __APPLE__
+  vector<char> residency(num_pages);
+#  else
+  vector<unsigned char> residency(num_pages);
+#  endif
+  if (mincore(data_, size_, residency.data()) != 0) {
+    return size_;
+  }
+
+  size_t resident_size = 0;
+  for (size_t i = 0; i < num_pages; i++) {
+    if (residency[i] & 1) {
+      resident_size += page_size;
+    }
+  }
+
+  return std::min(resident_size, size_);
+}
+
+#endif /* _WIN32 */
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_MAPPED_FILE_H__
+#define __UTIL_MAPPED_FILE_H__
+
+#include "util/string.h"
+#include "util/types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Read-only memory mapping of an entire file.
+ *
+ * Pages are only read from disk when first accessed, and since they are backed by the file the
+ * operating system can drop them under memory pressure instead of swapping them out. */
+class MappedFile {
+ public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool open(const string &filepath);
+  void close();
+
+  bool is_open() const
+  {
+    return data_ != nullptr;
+  }
+
+  const uint8_t *data() const
+  {
+    return data_;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  /* Number of bytes of the mapping currently resident in memory, at page granularity. Returns
+   * the full size on platforms where residency can not be queried. */
+  size_t resident_size() const;
+
+ protected:
+  uint8_t *data_;
+  size_t size_;
+#ifdef _WIN32
+  void *file_handle_;
+  void *mapping_handle_;
+#endif
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_MAPPED_FILE_H__ */
@@ -32,18 +32,21 @@ OIIO_NAMESPACE_USING
 #  define DIR_SEP '\\'
 #  define DIR_SEP_ALT '/'
 #  include <direct.h>
+#  include <sys/utime.h>
 #else
 #  define DIR_SEP '/'
 #  include <dirent.h>
 #  include <pwd.h>
 #  include <sys/types.h>
 #  include <unistd.h>
+#  include <utime.h>
 #endif
 
 #ifdef HAVE_SHLWAPI_H
 #  include <shlwapi.h>
 #endif
 
+#include "util/algorithm.h"
 #include "util/map.h"
 #include "util/windows.h"
 
@@ -67,7 +70,6 @@ typedef struct stat path_stat_t;
 static string cached_path = "";
 static string cached_user_path = "";
 static string cached_temp_path = "";
-static string cached_xdg_cache_path = "";
 
 namespace {
 
@@ -373,10 +375,10 @@ string path_user_get(const string &sub)
 string path_cache_get(const string &sub)
 {
 #if defined(__linux__) || defined(__APPLE__)
-  if (cached_xdg_cache_path == "") {
-    cached_xdg_cache_path = path_xdg_cache_get();
-  }
-  string result = path_join(cached_xdg_cache_path, "cycles");
+  /* Called from multiple threads, for example by parallel BVH builds, so rely on thread safe
+   * initialization of the static variable. */
+  static const string xdg_cache_path = path_xdg_cache_get();
+  string result = path_join(xdg_cache_path, "cycles");
   return path_join(result, sub);
 #else
   /* TODO(sergey): What that should be on Windows? */
@@ -745,11 +747,26 @@ uint64_t path_modified_time(const string &path)
   return st.st_mtime;
 }
 
+bool path_touch(const string &path)
+{
+#ifdef _WIN32
+  wstring path_wc = string_to_wstring(path);
+  return _wutime(path_wc.c_str(), NULL) == 0;
+#else
+  return utime(path.c_str(), NULL) == 0;
+#endif
+}
+
 bool path_remove(const string &path)
 {
   return remove(path.c_str()) == 0;
 }
 
+bool path_rename(const string &old_path, const string &new_path)
+{
+  return rename(old_path.c_str(), new_path.c_str()) == 0;
+}
+
 struct SourceReplaceState {
   typedef map<string, string> ProcessedMapping;
   /* Base director for all relative include headers. */
@@ -939,4 +956,57 @@ void path_cache_clear_except(const string &name, const set<string> &except)
   }
 }
 
+void path_cache_trim(const string &dir, const size_t max_size)
+{
+  if (!path_is_directory(dir)) {
+    return;
+  }
+
+  struct CacheFile {
+    uint64_t time;
+    size_t size;
+    string path;
+  };
+
+  vector<CacheFile> files;
+  size_t total_size = 0;
+
+  directory_iterator it(dir), it_end;
+  for (; it != it_end; ++it) {
+    const string filepath = it->path();
+    if (path_is_directory(filepath)) {
+      continue;
+    }
+
+    CacheFile file;
+    file.time = path_modified_time(filepath);
+    file.size = path_file_size(filepath);
+    file.path = filepath;
+    if (file.size == (size_t)-1) {
+      continue;
+    }
+
+    total_size += file.size;
+    files.push_back(file);
+  }
+
+  if (total_size <= max_size) {
+    return;
+  }
+
+  /* Remove least recently used files first, cache readers update the modification time. */
+  std::sort(files.begin(), files.end(), [](const CacheFile &a, const CacheFile &b) {
+    return a.time < b.time;
+  });
+
+  for (const CacheFile &file : files) {
+    if (total_size <= max_size) {
+      break;
+    }
+    if (path_remove(file.path)) {
+      total_size -= file.size;
+    }
+  }
+}
+
 CCL_NAMESPACE_END
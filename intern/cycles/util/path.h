@@ -64,13 +64,17 @@ bool path_read_binary(const string &path, vector<uint8_t> &binary);
 bool path_read_text(const string &path, string &text);
 
 /* File manipulation. */
+bool path_touch(const string &path);
 bool path_remove(const string &path);
+bool path_rename(const string &old_path, const string &new_path);
 
 /* source code utility */
 string path_source_replace_includes(const string &source, const string &path);
 
 /* cache utility */
 void path_cache_clear_except(const string &name, const set<string> &except);
+/* Remove least recently modified files from the directory until they fit in the size. */
+void path_cache_trim(const string &dir, const size_t max_size);
 
 CCL_NAMESPACE_END
 
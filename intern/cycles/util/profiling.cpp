@@ -76,6 +76,7 @@ void Profiler::reset(int num_shaders, int num_objects)
   /* Resize and clear the accumulation vectors. */
   shader_hits.assign(num_shaders, 0);
   object_hits.assign(num_objects, 0);
+  counters.assign(PROFILING_NUM_COUNTERS, 0);
 
   event_samples.assign(PROFILING_NUM_EVENTS, 0);
   shader_samples.assign(num_shaders, 0);
@@ -115,6 +116,7 @@ void Profiler::add_state(ProfilingState *state)
   /* Resize thread-local hit counters. */
   state->shader_hits.assign(shader_hits.size(), 0);
   state->object_hits.assign(object_hits.size(), 0);
+  std::fill(state->counters, state->counters + PROFILING_NUM_COUNTERS, 0);
 
   /* Initialize the state. */
   state->event = PROFILING_UNKNOWN;
@@ -141,6 +143,11 @@ void Profiler::remove_state(ProfilingState *state)
   for (int i = 0; i < object_hits.size(); i++) {
     object_hits[i] += state->object_hits[i];
   }
+
+  /* Merge thread-local counters. */
+  for (int i = 0; i < counters.size(); i++) {
+    counters[i] += state->counters[i];
+  }
 }
 
 uint64_t Profiler::get_event(ProfilingEvent event)
@@ -152,7 +159,7 @@ uint64_t Profiler::get_event(ProfilingEvent event)
 bool Profiler::get_shader(int shader, uint64_t &samples, uint64_t &hits)
 {
   assert(worker == NULL);
-  if (shader_samples[shader] == 0) {
+  if (shader_samples[shader] == 0 && shader_hits[shader] == 0) {
     return false;
   }
   samples = shader_samples[shader];
@@ -163,7 +170,7 @@ bool Profiler::get_shader(int shader, uint64_t &samples, uint64_t &hits)
 bool Profiler::get_object(int object, uint64_t &samples, uint64_t &hits)
 {
   assert(worker == NULL);
-  if (object_samples[object] == 0) {
+  if (object_samples[object] == 0 && object_hits[object] == 0) {
     return false;
   }
   samples = object_samples[object];
@@ -171,6 +178,12 @@ bool Profiler::get_object(int object, uint64_t &samples, uint64_t &hits)
   return true;
 }
 
+uint64_t Profiler::get_counter(ProfilingCounter counter)
+{
+  assert(worker == NULL);
+  return counters[counter];
+}
+
 bool Profiler::active() const
 {
   return (worker != nullptr);
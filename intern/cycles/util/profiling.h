@@ -56,6 +56,23 @@ enum ProfilingEvent : uint32_t {
   PROFILING_NUM_EVENTS,
 };
 
+/* Exact counts of work done in the kernels, unlike events these are not sampled. */
+enum ProfilingCounter : uint32_t {
+  PROFILING_COUNTER_CAMERA_RAYS,
+  PROFILING_COUNTER_CLOSEST_RAYS,
+  PROFILING_COUNTER_SHADOW_RAYS,
+  PROFILING_COUNTER_SUBSURFACE_RAYS,
+  /* Every ray traced to build the volume stack, one stack update can trace several. */
+  PROFILING_COUNTER_VOLUME_STACK_RAYS,
+
+  /* BVH2 traversal only, not counted for Embree. A node visited by a packet of rays counts once,
+   * primitives are counted for every ray they are tested against. */
+  PROFILING_COUNTER_BVH_NODES,
+  PROFILING_COUNTER_BVH_PRIMITIVES,
+
+  PROFILING_NUM_COUNTERS,
+};
+
 /* Contains the current execution state of a worker thread.
  * These values are constantly updated by the worker.
  * Periodically the profiler thread will wake up, read them
@@ -77,6 +94,9 @@ struct ProfilingState {
 
   vector<uint64_t> shader_hits;
   vector<uint64_t> object_hits;
+
+  /* Only written by the worker thread, merged into the profiler when the state is removed. */
+  uint64_t counters[PROFILING_NUM_COUNTERS] = {0};
 };
 
 class Profiler {
@@ -95,6 +115,7 @@ class Profiler {
   uint64_t get_event(ProfilingEvent event);
   bool get_shader(int shader, uint64_t &samples, uint64_t &hits);
   bool get_object(int object, uint64_t &samples, uint64_t &hits);
+  uint64_t get_counter(ProfilingCounter counter);
 
   bool active() const;
 
@@ -115,6 +136,9 @@ class Profiler {
   vector<uint64_t> shader_hits;
   vector<uint64_t> object_hits;
 
+  /* Total of the ProfilingCounter values of all threads. */
+  vector<uint64_t> counters;
+
   volatile bool do_stop_worker;
   thread *worker;
 
@@ -177,6 +201,38 @@ class ProfilingWithShaderHelper : public ProfilingHelper {
   }
 };
 
+/* Counts BVH node visits and primitive tests in local variables, and adds them to the state
+ * once when going out of scope, so the traversal inner loops do not write to memory. */
+class ProfilingBVHHelper {
+ public:
+  ProfilingBVHHelper(ProfilingState *state) : state(state), num_nodes(0), num_primitives(0)
+  {
+  }
+
+  ~ProfilingBVHHelper()
+  {
+    if (state->active) {
+      state->counters[PROFILING_COUNTER_BVH_NODES] += num_nodes;
+      state->counters[PROFILING_COUNTER_BVH_PRIMITIVES] += num_primitives;
+    }
+  }
+
+  inline void count_node()
+  {
+    num_nodes++;
+  }
+
+  inline void count_primitives(uint64_t num)
+  {
+    num_primitives += num;
+  }
+
+ protected:
+  ProfilingState *state;
+  uint64_t num_nodes;
+  uint64_t num_primitives;
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_PROFILING_H__ */
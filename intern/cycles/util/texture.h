@@ -89,6 +89,8 @@ typedef struct TextureInfo {
   uint interpolation, extension;
   /* Dimensions. */
   uint width, height, depth;
+  /* CPU only, data points to a TextureCacheImage with pixels loaded on demand. */
+  uint use_cache;
   /* Transform for 3D textures. */
   uint use_transform_3d;
   Transform transform_3d;
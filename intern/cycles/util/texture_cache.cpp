@@ -0,0 +1,548 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/texture_cache.h"
+
+#include "util/aligned_malloc.h"
+#include "util/algorithm.h"
+#include "util/half.h"
+#include "util/log.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+size_t texture_cache_pixel_size(ImageDataType type)
+{
+  switch (type) {
+    case IMAGE_DATA_TYPE_FLOAT4:
+      return sizeof(float) * 4;
+    case IMAGE_DATA_TYPE_BYTE4:
+      return sizeof(uchar) * 4;
+    case IMAGE_DATA_TYPE_HALF4:
+      return sizeof(half) * 4;
+    case IMAGE_DATA_TYPE_FLOAT:
+      return sizeof(float);
+    case IMAGE_DATA_TYPE_BYTE:
+      return sizeof(uchar);
+    case IMAGE_DATA_TYPE_HALF:
+      return sizeof(half);
+    case IMAGE_DATA_TYPE_USHORT4:
+      return sizeof(uint16_t) * 4;
+    case IMAGE_DATA_TYPE_USHORT:
+      return sizeof(uint16_t);
+    case IMAGE_DATA_TYPE_NANOVDB_FLOAT:
+    case IMAGE_DATA_TYPE_NANOVDB_FLOAT3:
+    case IMAGE_DATA_NUM_TYPES:
+      break;
+  }
+  assert(!"Image data type not supported by texture cache");
+  return 0;
+}
+
+/* Conversion of pixel components to and from float, for mipmap generation. */
+
+inline float texture_cache_to_float(float value)
+{
+  return value;
+}
+inline float texture_cache_to_float(uchar value)
+{
+  return (float)value * (1.0f / 255.0f);
+}
+inline float texture_cache_to_float(uint16_t value)
+{
+  return (float)value * (1.0f / 65535.0f);
+}
+inline float texture_cache_to_float(half value)
+{
+  return half_to_float_image(value);
+}
+
+template<typename T> inline T texture_cache_from_float(float value);
+
+template<> inline float texture_cache_from_float(float value)
+{
+  return value;
+}
+template<> inline uchar texture_cache_from_float(float value)
+{
+  return (uchar)(clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+template<> inline uint16_t texture_cache_from_float(float value)
+{
+  return (uint16_t)(clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+template<> inline half texture_cache_from_float(float value)
+{
+  return float_to_half_image(value);
+}
+
+/* Box filter 2x2 pixels of the previous level into each pixel of the tile. */
+template<typename T, int channels>
+void texture_cache_downsample(TextureCacheImage *image,
+                              const int level,
+                              const int x,
+                              const int y,
+                              const int w,
+                              const int h,
+                              T *pixels)
+{
+  const TextureCacheImage::Level &src = image->get_level(level - 1);
+  const int tile_size_log2 = image->tile_size_log2;
+  const int tile_size = 1 << tile_size_log2;
+  const int tile_mask = tile_size - 1;
+
+  TextureCacheTile *tile = NULL;
+  int tile_x = -1, tile_y = -1;
+
+  for (int py = 0; py < h; py++) {
+    for (int px = 0; px < w; px++) {
+      float sum[channels] = {0.0f};
+
+      for (int dy = 0; dy < 2; dy++) {
+        for (int dx = 0; dx < 2; dx++) {
+          const int sx = min(2 * (x + px) + dx, src.width - 1);
+          const int sy = min(2 * (y + py) + dy, src.height - 1);
+
+          if ((sx >> tile_size_log2) != tile_x || (sy >> tile_size_log2) != tile_y) {
+            if (tile) {
+              TextureCacheImage::release_tile(tile);
+            }
+            tile_x = sx >> tile_size_log2;
+            tile_y = sy >> tile_size_log2;
+            tile = image->acquire_tile(level - 1, tile_x, tile_y);
+          }
+
+          const T *src_pixel = (const T *)tile->pixels +
+                               ((sy & tile_mask) * tile_size + (sx & tile_mask)) * channels;
+          for (int c = 0; c < channels; c++) {
+            sum[c] += texture_cache_to_float(src_pixel[c]);
+          }
+        }
+      }
+
+      T *pixel = pixels + (py * tile_size + px) * channels;
+      for (int c = 0; c < channels; c++) {
+        pixel[c] = texture_cache_from_float<T>(sum[c] * 0.25f);
+      }
+    }
+  }
+
+  if (tile) {
+    TextureCacheImage::release_tile(tile);
+  }
+}
+
+}  // namespace
+
+/* Texture Cache Image */
+
+TextureCacheImage::TextureCacheImage(TextureCache *cache,
+                                     ImageDataType type,
+                                     int width,
+                                     int height,
+                                     const LoadTileFunc &load_func,
+                                     const ReleaseFunc &release_func)
+    : type(type),
+      width(width),
+      height(height),
+      tile_size_log2(TextureCache::tile_size_log2(type)),
+      base_level(0),
+      cache(cache),
+      load_func(load_func),
+      release_func(release_func),
+      open_bytes(0),
+      num_loading(0),
+      last_load(0)
+{
+  num_levels = 1;
+  while ((max(width, height) >> num_levels) > 0) {
+    num_levels++;
+  }
+
+  const int tile_size = 1 << tile_size_log2;
+
+  levels.resize(num_levels);
+  for (int level = 0; level < num_levels; level++) {
+    Level &l = levels[level];
+    l.width = max(width >> level, 1);
+    l.height = max(height >> level, 1);
+    l.tiles_x = divide_up(l.width, tile_size);
+    l.tiles_y = divide_up(l.height, tile_size);
+
+    const size_t num_tiles = (size_t)l.tiles_x * l.tiles_y;
+    l.tiles.reset(new std::atomic<TextureCacheTile *>[num_tiles]);
+    for (size_t i = 0; i < num_tiles; i++) {
+      l.tiles[i].store(NULL, std::memory_order_relaxed);
+    }
+  }
+}
+
+/* Texture Cache */
+
+TextureCache::TextureCache(size_t memory_budget)
+    : memory_budget(memory_budget), clock_hand(0), open_bytes(0), load_clock(0)
+{
+}
+
+TextureCache::~TextureCache()
+{
+  for (TextureCacheImage *image : images) {
+    delete image;
+  }
+
+  for (TextureCacheTile *tile : tiles) {
+    util_aligned_free(tile->pixels);
+    delete tile;
+  }
+}
+
+int TextureCache::tile_size_log2(ImageDataType type)
+{
+  /* Largest power of two square of pixels that fits in the tile storage. */
+  const size_t max_pixels = TEXTURE_CACHE_TILE_BYTES / texture_cache_pixel_size(type);
+  int size_log2 = 0;
+  while (((size_t)1 << (2 * (size_log2 + 1))) <= max_pixels) {
+    size_log2++;
+  }
+  return size_log2;
+}
+
+TextureCacheImage *TextureCache::add_image(ImageDataType type,
+                                           int width,
+                                           int height,
+                                           const TextureCacheImage::LoadTileFunc &load_func,
+                                           const TextureCacheImage::ReleaseFunc &release_func)
+{
+  TextureCacheImage *image = new TextureCacheImage(
+      this, type, width, height, load_func, release_func);
+
+  thread_scoped_lock lock(mutex);
+  images.push_back(image);
+
+  return image;
+}
+
+void TextureCache::remove_image(TextureCacheImage *image)
+{
+  bool is_open;
+  {
+    thread_scoped_lock lock(mutex);
+
+    free_image_tiles(image);
+
+    is_open = image->open_bytes != 0;
+    open_bytes -= image->open_bytes;
+    image->open_bytes = 0;
+
+    images.erase(std::remove(images.begin(), images.end(), image), images.end());
+  }
+
+  /* The loader may be used again for a new image in the same slot, which starts with no
+   * memory accounted for. */
+  if (is_open) {
+    image->release_func();
+  }
+  delete image;
+}
+
+void TextureCache::free_image_tiles(TextureCacheImage *image)
+{
+  /* Must only be called when the image is not being rendered. */
+  for (TextureCacheImage::Level &l : image->levels) {
+    const size_t num_tiles = (size_t)l.tiles_x * l.tiles_y;
+    for (size_t i = 0; i < num_tiles; i++) {
+      TextureCacheTile *tile = l.tiles[i].exchange(NULL);
+      if (tile) {
+        assert(tile->users == 0);
+        tile->image = NULL;
+        free_tiles.push_back(tile);
+      }
+    }
+  }
+}
+
+void TextureCache::set_memory_budget(size_t memory_budget_)
+{
+  thread_scoped_lock lock(mutex);
+  memory_budget = memory_budget_;
+}
+
+size_t TextureCache::get_memory_budget() const
+{
+  return memory_budget;
+}
+
+TextureCache::Stats TextureCache::get_stats()
+{
+  thread_scoped_lock lock(mutex);
+  stats.mem_used = mem_used();
+  return stats;
+}
+
+size_t TextureCache::mem_used() const
+{
+  return tiles.size() * TEXTURE_CACHE_TILE_BYTES + open_bytes;
+}
+
+TextureCacheTile *TextureCache::allocate_tile()
+{
+  /* Must be called with the cache mutex locked. */
+  if (!free_tiles.empty()) {
+    TextureCacheTile *tile = free_tiles.back();
+    free_tiles.pop_back();
+    return tile;
+  }
+
+  if (mem_used() + TEXTURE_CACHE_TILE_BYTES > memory_budget && !tiles.empty()) {
+    /* Clock eviction: tiles accessed since the last pass of the hand get a second chance.
+     * Two full passes are enough to find any tile without users. */
+    for (size_t step = 0; step < 2 * tiles.size(); step++) {
+      TextureCacheTile *tile = tiles[clock_hand];
+      clock_hand = (clock_hand + 1) % tiles.size();
+
+      if (tile->image == NULL || tile->users.load() != 0) {
+        continue;
+      }
+      if (tile->referenced.load(std::memory_order_relaxed)) {
+        tile->referenced.store(false, std::memory_order_relaxed);
+        continue;
+      }
+
+      std::atomic<TextureCacheTile *> &slot = tile->image->levels[tile->level].tiles[tile->index];
+      TextureCacheTile *expected = tile;
+      if (!slot.compare_exchange_strong(expected, NULL)) {
+        continue;
+      }
+      /* A lookup may have acquired the tile before it was removed from the slot. */
+      if (tile->users.load() != 0) {
+        slot.store(tile);
+        continue;
+      }
+
+      tile->image = NULL;
+      stats.tiles_evicted++;
+      return tile;
+    }
+
+    /* All tiles are in use, temporarily exceed the budget rather than stall rendering. */
+  }
+
+  TextureCacheTile *tile = new TextureCacheTile();
+  tile->users = 0;
+  tile->referenced = false;
+  tile->image = NULL;
+  tile->level = 0;
+  tile->index = 0;
+  tile->pixels = util_aligned_malloc(TEXTURE_CACHE_TILE_BYTES, 16);
+  tiles.push_back(tile);
+
+  stats.mem_used = mem_used();
+  stats.mem_peak = max(stats.mem_peak, stats.mem_used);
+
+  return tile;
+}
+
+bool TextureCache::is_loading(TextureCacheImage *image, int level, int index) const
+{
+  for (const TextureCacheTile *tile : loading_tiles) {
+    if (tile->image == image && tile->level == level && tile->index == index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void TextureCache::begin_image_load(TextureCacheImage *image,
+                                    vector<TextureCacheImage *> &release_images)
+{
+  /* Must be called with the cache mutex locked. */
+  image->num_loading++;
+  image->last_load = ++load_clock;
+
+  if (image->open_bytes == 0) {
+    /* Loaders keep the file open and a strip of full width rows, estimate the memory as the
+     * strip of the full resolution level plus one tile for the decoder state. */
+    const size_t tile_size = (size_t)1 << image->tile_size_log2;
+    image->open_bytes = image->levels[0].width * tile_size *
+                            texture_cache_pixel_size(image->type) +
+                        TEXTURE_CACHE_TILE_BYTES;
+    open_bytes += image->open_bytes;
+
+    stats.mem_used = mem_used();
+    stats.mem_peak = max(stats.mem_peak, stats.mem_used);
+  }
+
+  /* Open loaders may use up to half of the budget, the rest is left for tiles. Release the
+   * least recently used loaders beyond that, reopening files is expensive so they are not
+   * released just to make room for tiles. */
+  while (open_bytes > memory_budget / 2) {
+    TextureCacheImage *lru_image = NULL;
+    for (TextureCacheImage *other : images) {
+      if (other->open_bytes != 0 && other->num_loading == 0 &&
+          (lru_image == NULL || other->last_load < lru_image->last_load)) {
+        lru_image = other;
+      }
+    }
+    if (lru_image == NULL) {
+      break;
+    }
+
+    open_bytes -= lru_image->open_bytes;
+    lru_image->open_bytes = 0;
+    release_images.push_back(lru_image);
+  }
+}
+
+void TextureCache::end_image_load(TextureCacheImage *image)
+{
+  /* Must be called with the cache mutex locked. */
+  image->num_loading--;
+}
+
+TextureCacheTile *TextureCache::load_tile(TextureCacheImage *image, int level, int index)
+{
+  std::atomic<TextureCacheTile *> &slot = image->levels[level].tiles[index];
+  vector<TextureCacheImage *> release_images;
+  TextureCacheTile *tile;
+
+  {
+    thread_scoped_lock lock(mutex);
+
+    /* Another thread may have loaded the tile already, or still be loading it. Slots only
+     * change with the cache mutex locked, so acquiring a resident tile can not fail here. */
+    while (true) {
+      tile = slot.load(std::memory_order_acquire);
+      if (tile && TextureCacheImage::try_acquire(slot, tile)) {
+        return tile;
+      }
+      if (!is_loading(image, level, index)) {
+        break;
+      }
+      loading_cond.wait(lock);
+    }
+
+    tile = allocate_tile();
+    /* Lookups that read the tile pointer before it was evicted may still briefly increment
+     * and decrement the user count, so it must only be modified atomically. */
+    tile->users.fetch_add(1);
+    tile->referenced = true;
+    tile->image = image;
+    tile->level = level;
+    tile->index = index;
+
+    loading_tiles.push_back(tile);
+    begin_image_load(image, release_images);
+  }
+
+  /* Files are read and released without holding any lock, so that loading one tile does not
+   * stall lookups and loads of other tiles. */
+  for (TextureCacheImage *release_image : release_images) {
+    release_image->release_func();
+  }
+
+  if (!fill_tile(image, level, index, tile->pixels)) {
+    VLOG(1) << "Failed to load texture cache tile " << index << " of level " << level << ".";
+    memset(tile->pixels, 0, TEXTURE_CACHE_TILE_BYTES);
+  }
+
+  {
+    thread_scoped_lock lock(mutex);
+    stats.tiles_loaded++;
+    end_image_load(image);
+
+    loading_tiles.erase(std::remove(loading_tiles.begin(), loading_tiles.end(), tile),
+                        loading_tiles.end());
+    slot.store(tile, std::memory_order_release);
+  }
+  loading_cond.notify_all();
+
+  return tile;
+}
+
+bool TextureCache::fill_tile(TextureCacheImage *image, int level, int index, void *pixels)
+{
+  const TextureCacheImage::Level &l = image->levels[level];
+  const int tile_size = 1 << image->tile_size_log2;
+  const int x = (index % l.tiles_x) * tile_size;
+  const int y = (index / l.tiles_x) * tile_size;
+  const int w = min(tile_size, l.width - x);
+  const int h = min(tile_size, l.height - y);
+
+  if (image->load_func(level, x, y, w, h, pixels)) {
+    /* Loaded rows are tightly packed, spread them to the tile row stride. */
+    if (w < tile_size) {
+      const size_t pixel_size = texture_cache_pixel_size(image->type);
+      uchar *data = (uchar *)pixels;
+      for (int row = h - 1; row > 0; row--) {
+        memmove(data + row * tile_size * pixel_size, data + row * w * pixel_size, w * pixel_size);
+      }
+    }
+    return true;
+  }
+
+  if (level > 0) {
+    return downsample_tile(image, level, index, pixels);
+  }
+
+  return false;
+}
+
+bool TextureCache::downsample_tile(TextureCacheImage *image, int level, int index, void *pixels)
+{
+  const TextureCacheImage::Level &l = image->levels[level];
+  const int tile_size = 1 << image->tile_size_log2;
+  const int x = (index % l.tiles_x) * tile_size;
+  const int y = (index / l.tiles_x) * tile_size;
+  const int w = min(tile_size, l.width - x);
+  const int h = min(tile_size, l.height - y);
+
+  switch (image->type) {
+    case IMAGE_DATA_TYPE_FLOAT4:
+      texture_cache_downsample<float, 4>(image, level, x, y, w, h, (float *)pixels);
+      return true;
+    case IMAGE_DATA_TYPE_BYTE4:
+      texture_cache_downsample<uchar, 4>(image, level, x, y, w, h, (uchar *)pixels);
+      return true;
+    case IMAGE_DATA_TYPE_HALF4:
+      texture_cache_downsample<half, 4>(image, level, x, y, w, h, (half *)pixels);
+      return true;
+    case IMAGE_DATA_TYPE_FLOAT:
+      texture_cache_downsample<float, 1>(image, level, x, y, w, h, (float *)pixels);
+      return true;
+    case IMAGE_DATA_TYPE_BYTE:
+      texture_cache_downsample<uchar, 1>(image, level, x, y, w, h, (uchar *)pixels);
+      return true;
+    case IMAGE_DATA_TYPE_HALF:
+      texture_cache_downsample<half, 1>(image, level, x, y, w, h, (half *)pixels);
+      return true;
+    case IMAGE_DATA_TYPE_USHORT4:
+      texture_cache_downsample<uint16_t, 4>(image, level, x, y, w, h, (uint16_t *)pixels);
+      return true;
+    case IMAGE_DATA_TYPE_USHORT:
+      texture_cache_downsample<uint16_t, 1>(image, level, x, y, w, h, (uint16_t *)pixels);
+      return true;
+    case IMAGE_DATA_TYPE_NANOVDB_FLOAT:
+    case IMAGE_DATA_TYPE_NANOVDB_FLOAT3:
+    case IMAGE_DATA_NUM_TYPES:
+      break;
+  }
+
+  return false;
+}
+
+CCL_NAMESPACE_END
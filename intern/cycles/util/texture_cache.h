@@ -0,0 +1,227 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_TEXTURE_CACHE_H__
+#define __UTIL_TEXTURE_CACHE_H__
+
+#include <atomic>
+
+#include "util/function.h"
+#include "util/texture.h"
+#include "util/thread.h"
+#include "util/types.h"
+#include "util/unique_ptr.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class TextureCache;
+class TextureCacheImage;
+
+/* Size in bytes of the pixel storage of a single tile. All tiles have the same size regardless
+ * of the image data type, so that any evicted tile can be reused for any other image. */
+#define TEXTURE_CACHE_TILE_BYTES (64 * 1024)
+
+/* Tile of image pixels resident in the cache. */
+struct TextureCacheTile {
+  /* Number of lookups currently reading pixels from this tile. A tile is never evicted while
+   * it has users. */
+  std::atomic<int> users;
+  /* Set on every access, cleared by the eviction clock hand. */
+  std::atomic<bool> referenced;
+
+  /* Location of the tile in the image, used to clear the image slot on eviction. */
+  TextureCacheImage *image;
+  int level;
+  int index;
+
+  void *pixels;
+};
+
+/* Texture Cache Image
+ *
+ * Image registered in the texture cache. Pixels are stored in a mipmap pyramid of fixed size
+ * tiles which are loaded on first access. Level 0 always matches the full resolution image,
+ * tiles of other levels are read from the loader when it provides mipmaps, and generated by
+ * downsampling the previous level otherwise. */
+class TextureCacheImage {
+ public:
+  /* Fill pixels of the given region of a level in the image storage format, with rows in the
+   * same bottom-to-top order as fully loaded images. Returning false for a level other than
+   * 0 means that the level will be generated from the previous one instead. */
+  typedef function<bool(int level, int x, int y, int w, int h, void *pixels)> LoadTileFunc;
+  /* Close the file and free buffers kept by the loader between tile loads. */
+  typedef function<void()> ReleaseFunc;
+
+  struct Level {
+    int width, height;
+    int tiles_x, tiles_y;
+    unique_ptr<std::atomic<TextureCacheTile *>[]> tiles;
+  };
+
+  ImageDataType type;
+  int width, height;
+  int num_levels;
+  int tile_size_log2;
+  /* Level used by texture lookups, above zero when the texture resolution is limited. */
+  int base_level;
+
+  /* Acquire tile for reading, loading it into the cache when it is not resident yet. Must be
+   * paired with release_tile(), and returns NULL only when loading failed. */
+  inline TextureCacheTile *acquire_tile(const int level, const int tile_x, const int tile_y);
+  static inline void release_tile(TextureCacheTile *tile);
+
+  const Level &get_level(const int level) const
+  {
+    return levels[level];
+  }
+
+ protected:
+  friend class TextureCache;
+
+  TextureCacheImage(TextureCache *cache,
+                    ImageDataType type,
+                    int width,
+                    int height,
+                    const LoadTileFunc &load_func,
+                    const ReleaseFunc &release_func);
+
+  TextureCache *cache;
+  LoadTileFunc load_func;
+  ReleaseFunc release_func;
+  vector<Level> levels;
+
+  /* Memory held by the loader while the file is open, counted in the cache budget. Zero when
+   * the loader is released. Protected by the cache mutex, like the members below. */
+  size_t open_bytes;
+  /* Number of tile loads currently calling the loader, which is never released meanwhile. */
+  int num_loading;
+  /* Time of the last tile load, to release the least recently used loaders first. */
+  uint64_t last_load;
+
+  static inline bool try_acquire(std::atomic<TextureCacheTile *> &slot, TextureCacheTile *tile);
+};
+
+/* Texture Cache
+ *
+ * Bounded memory storage of image textures for CPU rendering. Tiles are loaded lazily on first
+ * access by the kernel and evicted with the clock algorithm, an approximation of least recently
+ * used replacement, once the memory budget is reached. */
+class TextureCache {
+ public:
+  struct Stats {
+    size_t mem_used = 0;
+    size_t mem_peak = 0;
+    uint64_t tiles_loaded = 0;
+    uint64_t tiles_evicted = 0;
+  };
+
+  explicit TextureCache(size_t memory_budget);
+  ~TextureCache();
+
+  TextureCacheImage *add_image(ImageDataType type,
+                               int width,
+                               int height,
+                               const TextureCacheImage::LoadTileFunc &load_func,
+                               const TextureCacheImage::ReleaseFunc &release_func);
+  void remove_image(TextureCacheImage *image);
+
+  /* Changing the budget does not free memory immediately, the cache shrinks as tiles are
+   * evicted and loaders released while loading new tiles. */
+  void set_memory_budget(size_t memory_budget);
+  size_t get_memory_budget() const;
+
+  Stats get_stats();
+
+  /* Number of pixels along the side of a tile for images of the given type. */
+  static int tile_size_log2(ImageDataType type);
+
+ protected:
+  friend class TextureCacheImage;
+
+  TextureCacheTile *load_tile(TextureCacheImage *image, int level, int index);
+  bool fill_tile(TextureCacheImage *image, int level, int index, void *pixels);
+  bool downsample_tile(TextureCacheImage *image, int level, int index, void *pixels);
+
+  TextureCacheTile *allocate_tile();
+  void free_image_tiles(TextureCacheImage *image);
+
+  bool is_loading(TextureCacheImage *image, int level, int index) const;
+  void begin_image_load(TextureCacheImage *image, vector<TextureCacheImage *> &release_images);
+  void end_image_load(TextureCacheImage *image);
+  size_t mem_used() const;
+
+  size_t memory_budget;
+
+  thread_mutex mutex;
+  vector<TextureCacheTile *> tiles;
+  vector<TextureCacheTile *> free_tiles;
+  size_t clock_hand;
+  vector<TextureCacheImage *> images;
+
+  /* Tiles being filled without holding any lock. Other lookups of the same tile wait for the
+   * load to finish instead of reading the file again. */
+  vector<TextureCacheTile *> loading_tiles;
+  thread_condition_variable loading_cond;
+
+  size_t open_bytes;
+  uint64_t load_clock;
+
+  Stats stats;
+};
+
+/* Inline fast path for lookups of resident tiles. */
+
+inline bool TextureCacheImage::try_acquire(std::atomic<TextureCacheTile *> &slot,
+                                           TextureCacheTile *tile)
+{
+  /* Tiles are only reused after being removed from their slot without users, so once the
+   * user count is increased and the tile is still in the slot its pixels remain valid. */
+  tile->users.fetch_add(1);
+  if (slot.load() == tile) {
+    if (!tile->referenced.load(std::memory_order_relaxed)) {
+      tile->referenced.store(true, std::memory_order_relaxed);
+    }
+    return true;
+  }
+  tile->users.fetch_sub(1);
+  return false;
+}
+
+inline TextureCacheTile *TextureCacheImage::acquire_tile(const int level,
+                                                         const int tile_x,
+                                                         const int tile_y)
+{
+  const Level &l = levels[level];
+  const int index = tile_y * l.tiles_x + tile_x;
+  std::atomic<TextureCacheTile *> &slot = l.tiles[index];
+
+  TextureCacheTile *tile = slot.load(std::memory_order_acquire);
+  if (tile && try_acquire(slot, tile)) {
+    return tile;
+  }
+
+  return cache->load_tile(this, level, index);
+}
+
+inline void TextureCacheImage::release_tile(TextureCacheTile *tile)
+{
+  tile->users.fetch_sub(1, std::memory_order_release);
+}
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_H__ */
@@ -28,9 +28,26 @@
 #include "BLI_endian_switch.h"
 #include "BLI_filereader.h"
 #include "BLI_math_base.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
+/* Upper bound for the number of frames decompressed ahead of the reading position. */
+#define ZSTD_READ_AHEAD_MAX_FRAMES 16
+
+/* A frame being decompressed on a worker thread. */
+typedef struct ZstdReadAheadFrame {
+  /* Frame number, or -1 if unused. */
+  int frame;
+  bool is_running;
+  bool success;
+
+  char *compressed_data;
+  size_t compressed_size;
+  char *uncompressed_data;
+  size_t uncompressed_size;
+} ZstdReadAheadFrame;
+
 typedef struct {
   FileReader reader;
 
@@ -47,6 +64,12 @@ typedef struct {
 
     char *cached_content;
     int cached_frame;
+
+    /* Frames following the cached one, decompressed on worker threads. Frame `i` is stored
+     * in `read_ahead[i % read_ahead_len]`. */
+    ListBase threadpool;
+    ZstdReadAheadFrame *read_ahead;
+    int read_ahead_len;
   } seek;
 } ZstdReader;
 
@@ -170,6 +193,87 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
+static void *zstd_read_ahead_task(void *userdata)
+{
+  ZstdReadAheadFrame *ahead = userdata;
+
+  ahead->uncompressed_data = MEM_mallocN(ahead->uncompressed_size, __func__);
+  size_t res = ZSTD_decompress(ahead->uncompressed_data,
+                               ahead->uncompressed_size,
+                               ahead->compressed_data,
+                               ahead->compressed_size);
+  ahead->success = !ZSTD_isError(res) && res == ahead->uncompressed_size;
+
+  MEM_freeN(ahead->compressed_data);
+  ahead->compressed_data = NULL;
+  return NULL;
+}
+
+/* Wait for the worker thread of the frame to finish. */
+static void zstd_read_ahead_wait(ZstdReader *zstd, ZstdReadAheadFrame *ahead)
+{
+  if (ahead->is_running) {
+    BLI_threadpool_remove(&zstd->seek.threadpool, ahead);
+    ahead->is_running = false;
+  }
+}
+
+static void zstd_read_ahead_discard(ZstdReader *zstd, ZstdReadAheadFrame *ahead)
+{
+  zstd_read_ahead_wait(zstd, ahead);
+  MEM_SAFE_FREE(ahead->uncompressed_data);
+  ahead->frame = -1;
+}
+
+/* Start decompressing the frame on a worker thread. The compressed data is read here, since the
+ * base reader can only be used from one thread. */
+static void zstd_read_ahead_start(ZstdReader *zstd, int frame)
+{
+  ZstdReadAheadFrame *ahead = &zstd->seek.read_ahead[frame % zstd->seek.read_ahead_len];
+  if (ahead->frame == frame) {
+    return;
+  }
+  zstd_read_ahead_discard(zstd, ahead);
+
+  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
+  char *compressed_data = MEM_mallocN(compressed_size, __func__);
+  if (zstd->base->seek(zstd->base, zstd->seek.compressed_ofs[frame], SEEK_SET) < 0 ||
+      zstd->base->read(zstd->base, compressed_data, compressed_size) < compressed_size) {
+    /* Leave it to #zstd_ensure_cache to fail on this frame. */
+    MEM_freeN(compressed_data);
+    return;
+  }
+
+  ahead->frame = frame;
+  ahead->success = false;
+  ahead->compressed_data = compressed_data;
+  ahead->compressed_size = compressed_size;
+  ahead->uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
+                             zstd->seek.uncompressed_ofs[frame];
+  ahead->is_running = true;
+  BLI_threadpool_insert(&zstd->seek.threadpool, ahead);
+}
+
+/* Take the frame from the read-ahead frames if it was started, returns NULL otherwise. */
+static char *zstd_read_ahead_take(ZstdReader *zstd, int frame)
+{
+  ZstdReadAheadFrame *ahead = &zstd->seek.read_ahead[frame % zstd->seek.read_ahead_len];
+  if (ahead->frame != frame) {
+    return NULL;
+  }
+
+  zstd_read_ahead_wait(zstd, ahead);
+
+  char *uncompressed_data = NULL;
+  if (ahead->success) {
+    uncompressed_data = ahead->uncompressed_data;
+    ahead->uncompressed_data = NULL;
+  }
+  zstd_read_ahead_discard(zstd, ahead);
+
+  return uncompressed_data;
+}
+
 /* Ensure that the currently loaded frame is the correct one. */
 static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
 {
@@ -181,6 +285,29 @@ static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
   /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
   MEM_SAFE_FREE(zstd->seek.cached_content);
 
+  const int prev_frame = zstd->seek.cached_frame;
+  zstd->seek.cached_frame = -1;
+
+  if (zstd->seek.read_ahead) {
+    char *uncompressed_data = zstd_read_ahead_take(zstd, frame);
+
+    /* Only read ahead when reading sequentially, random access such as reading #BHead data on
+     * demand would otherwise discard the frames that are about to be read. */
+    if (uncompressed_data || frame == prev_frame + 1) {
+      const int last_frame = min_ii(frame + zstd->seek.read_ahead_len,
+                                    zstd->seek.num_frames - 1);
+      for (int ahead_frame = frame + 1; ahead_frame <= last_frame; ahead_frame++) {
+        zstd_read_ahead_start(zstd, ahead_frame);
+      }
+    }
+
+    if (uncompressed_data) {
+      zstd->seek.cached_frame = frame;
+      zstd->seek.cached_content = uncompressed_data;
+      return uncompressed_data;
+    }
+  }
+
   size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
   size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
                              zstd->seek.uncompressed_ofs[frame];
@@ -295,6 +422,13 @@ static void zstd_close(FileReader *reader)
 
   ZSTD_freeDCtx(zstd->ctx);
   if (zstd->reader.seek) {
+    if (zstd->seek.read_ahead) {
+      for (int i = 0; i < zstd->seek.read_ahead_len; i++) {
+        zstd_read_ahead_discard(zstd, &zstd->seek.read_ahead[i]);
+      }
+      BLI_threadpool_end(&zstd->seek.threadpool);
+      MEM_freeN(zstd->seek.read_ahead);
+    }
     MEM_freeN(zstd->seek.uncompressed_ofs);
     MEM_freeN(zstd->seek.compressed_ofs);
     MEM_freeN(zstd->seek.cached_content);
@@ -317,6 +451,19 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
   if (zstd_read_seek_table(zstd)) {
     zstd->reader.read = zstd_read_seekable;
     zstd->reader.seek = zstd_seek;
+
+    /* Leave one thread for the reading logic, unless we only have one HW thread. */
+    const int num_threads = min_ii(max_ii(1, BLI_system_thread_count() - 1),
+                                   ZSTD_READ_AHEAD_MAX_FRAMES);
+    if (zstd->seek.num_frames > 1) {
+      zstd->seek.read_ahead_len = num_threads;
+      zstd->seek.read_ahead = MEM_malloc_arrayN(
+          num_threads, sizeof(ZstdReadAheadFrame), "zstd read ahead");
+      for (int i = 0; i < num_threads; i++) {
+        zstd->seek.read_ahead[i] = (ZstdReadAheadFrame){.frame = -1};
+      }
+      BLI_threadpool_init(&zstd->seek.threadpool, zstd_read_ahead_task, num_threads);
+    }
   }
   else {
     zstd->reader.read = zstd_read;
@@ -92,6 +92,12 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
  * Not memfile itself.
  */
 extern void BLO_memfile_free(MemFile *memfile);
+/**
+ * Copy of all data in \a memfile, owning its memory. Unlike the undo steps it was copied from,
+ * it is not affected by later changes of the undo stack, so it can be written from another
+ * thread. Free with #BLO_memfile_free and `MEM_freeN`.
+ */
+extern MemFile *BLO_memfile_copy(const MemFile *memfile);
 /**
  * Result is that 'first' is being freed.
  * to keep list of memfiles consistent, 'first' is always first in list.
@@ -113,5 +119,13 @@ extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
  * \return success.
  */
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
+/**
+ * Same as #BLO_memfile_write_file, optionally reporting \a progress and returning early when
+ * \a stop is set, for writing from a job.
+ */
+extern bool BLO_memfile_write_file_ex(struct MemFile *memfile,
+                                      const char *filename,
+                                      const short *stop,
+                                      float *progress);
 
 FileReader *BLO_memfile_new_filereader(MemFile *memfile, int undo_direction);
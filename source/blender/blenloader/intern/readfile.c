@@ -69,6 +69,7 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "PIL_time.h"
@@ -205,6 +206,9 @@ typedef struct BHeadN {
   bool has_data;
 #endif
   bool is_memchunk_identical;
+  /** Set when the data was converted ahead of time, see #read_file_decode_data_blocks. */
+  bool has_data_decoded;
+  void *data_decoded;
   struct BHead bhead;
 } BHeadN;
 
@@ -842,6 +846,8 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->file_offset = fd->file->offset;
           new_bhead->has_data = false;
           new_bhead->is_memchunk_identical = false;
+          new_bhead->has_data_decoded = false;
+          new_bhead->data_decoded = NULL;
           new_bhead->bhead = bhead;
           off64_t seek_new = fd->file->seek(fd->file, bhead.len, SEEK_CUR);
           if (seek_new == -1) {
@@ -865,6 +871,8 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->has_data = true;
 #endif
           new_bhead->is_memchunk_identical = false;
+          new_bhead->has_data_decoded = false;
+          new_bhead->data_decoded = NULL;
           new_bhead->bhead = bhead;
 
           readsize = fd->file->read(fd->file, new_bhead + 1, (size_t)bhead.len);
@@ -982,6 +990,8 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   new_bhead_data->file_offset = new_bhead->file_offset;
   new_bhead_data->has_data = true;
   new_bhead_data->is_memchunk_identical = false;
+  new_bhead_data->has_data_decoded = false;
+  new_bhead_data->data_decoded = NULL;
   if (!blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)) {
     MEM_freeN(new_bhead_data);
     return NULL;
@@ -1344,6 +1354,13 @@ void blo_filedata_free(FileData *fd)
 {
   if (fd) {
 
+    /* Free data decoded ahead of time that was never read, e.g. for skipped data-blocks. */
+    LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+      if (new_bhead->data_decoded) {
+        MEM_freeN(new_bhead->data_decoded);
+      }
+    }
+
     /* Free all BHeadN data blocks */
 #ifndef NDEBUG
     BLI_freelistN(&fd->bhead_list);
@@ -1865,6 +1882,15 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 {
   void *temp = NULL;
 
+  BHeadN *bh_decoded = BHEADN_FROM_BHEAD(bh);
+  if (bh_decoded->has_data_decoded) {
+    /* Already converted by #read_file_decode_data_blocks, hand over ownership. */
+    temp = bh_decoded->data_decoded;
+    bh_decoded->has_data_decoded = false;
+    bh_decoded->data_decoded = NULL;
+    return temp;
+  }
+
   if (bh->len) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
     BHead *bh_orig = bh;
@@ -1938,6 +1964,151 @@ static const void *peek_struct_undo(FileData *fd, BHead *bhead)
   return (bhead->len) ? (const void *)(bhead + 1) : NULL;
 }
 
+/**
+ * Upper bound for the raw data read into memory at once by #read_file_decode_data_blocks,
+ * so files read on demand don't need to be held in memory as a whole.
+ */
+#define DECODE_DATA_BATCH_SIZE (64 * 1024 * 1024)
+
+typedef struct DecodeDataBlocksData {
+  FileData *fd;
+  /** The blocks to decode. */
+  BHeadN **bheads;
+  /** The blocks with their data in memory, differs from #bheads when read on demand. */
+  BHead **bheads_full;
+} DecodeDataBlocksData;
+
+/* Logic must match #read_struct. */
+static bool read_file_decode_data_block_test(const FileData *fd, const BHead *bhead)
+{
+  if (bhead->code != DATA || bhead->len == 0) {
+    return false;
+  }
+  if (fd->compflags[bhead->SDNAnr] == SDNA_CMP_REMOVED) {
+    return false;
+  }
+  return (fd->compflags[bhead->SDNAnr] == SDNA_CMP_NOT_EQUAL) ||
+         (bhead->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN));
+}
+
+static void read_file_decode_data_block_cb(void *__restrict userdata,
+                                           const int index,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DecodeDataBlocksData *data = userdata;
+  FileData *fd = data->fd;
+  BHeadN *new_bhead = data->bheads[index];
+  BHead *bh = data->bheads_full[index];
+
+  if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+    switch_endian_structs(fd->filesdna, bh);
+  }
+
+  if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+    new_bhead->data_decoded = DNA_struct_reconstruct(
+        fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+  }
+  else {
+    /* SDNA_CMP_EQUAL */
+    new_bhead->data_decoded = MEM_mallocN(bh->len, "decoded data");
+    memcpy(new_bhead->data_decoded, (bh + 1), bh->len);
+  }
+  new_bhead->has_data_decoded = true;
+}
+
+static void read_file_decode_data_batch(DecodeDataBlocksData *data, const int batch_len)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, batch_len, data, read_file_decode_data_block_cb, &settings);
+
+  for (int i = 0; i < batch_len; i++) {
+    if (data->bheads_full[i] != &data->bheads[i]->bhead) {
+      MEM_freeN(BHEADN_FROM_BHEAD(data->bheads_full[i]));
+    }
+  }
+}
+
+/**
+ * Files saved with a different DNA or endianness need every data block to be converted, which
+ * dominates loading time for large files. Do this for all #DATA blocks on multiple threads up
+ * front, so the serial #read_libblock pass only has to pick up the result in #read_struct.
+ * Reading from the file itself is still done on the calling thread, and pointers are remapped
+ * when linking, as before.
+ */
+static void read_file_decode_data_blocks(FileData *fd)
+{
+  /* Undo steps always match the current DNA. */
+  if ((fd->flags & FD_FLAGS_IS_MEMFILE) || (fd->skip_flags & BLO_READ_SKIP_DATA)) {
+    return;
+  }
+
+  bool needs_conversion = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
+  for (int i = 0; i < fd->filesdna->structs_len && !needs_conversion; i++) {
+    needs_conversion = (fd->compflags[i] == SDNA_CMP_NOT_EQUAL);
+  }
+  if (!needs_conversion) {
+    return;
+  }
+
+  int bheads_len = 0;
+  for (BHead *bhead = blo_bhead_first(fd); bhead && bhead->code != ENDB;
+       bhead = blo_bhead_next(fd, bhead)) {
+    if (read_file_decode_data_block_test(fd, bhead)) {
+      bheads_len++;
+    }
+  }
+  if (bheads_len == 0) {
+    return;
+  }
+
+  DecodeDataBlocksData data = {
+      .fd = fd,
+      .bheads = MEM_mallocN(sizeof(*data.bheads) * bheads_len, __func__),
+      .bheads_full = MEM_mallocN(sizeof(*data.bheads_full) * bheads_len, __func__),
+  };
+
+  int batch_len = 0;
+  size_t batch_size = 0;
+
+  for (BHead *bhead = blo_bhead_first(fd); bhead && bhead->code != ENDB;
+       bhead = blo_bhead_next(fd, bhead)) {
+    if (!read_file_decode_data_block_test(fd, bhead)) {
+      continue;
+    }
+
+    BHead *bh_full = bhead;
+#ifdef USE_BHEAD_READ_ON_DEMAND
+    if (BHEADN_FROM_BHEAD(bhead)->has_data == false) {
+      bh_full = blo_bhead_read_full(fd, bhead);
+      if (UNLIKELY(bh_full == NULL)) {
+        /* Leave the remaining blocks to #read_struct, which reports the error. */
+        break;
+      }
+      batch_size += (size_t)bhead->len;
+    }
+#endif
+
+    data.bheads[batch_len] = BHEADN_FROM_BHEAD(bhead);
+    data.bheads_full[batch_len] = bh_full;
+    batch_len++;
+
+    if (batch_size >= DECODE_DATA_BATCH_SIZE) {
+      read_file_decode_data_batch(&data, batch_len);
+      batch_len = 0;
+      batch_size = 0;
+    }
+  }
+
+  if (batch_len) {
+    read_file_decode_data_batch(&data, batch_len);
+  }
+
+  MEM_freeN(data.bheads);
+  MEM_freeN(data.bheads_full);
+}
+
 static void link_glob_list(FileData *fd, ListBase *lb) /* for glob data */
 {
   Link *ln, *prev;
@@ -3883,6 +4054,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  read_file_decode_data_blocks(fd);
+
   while (bhead) {
     switch (bhead->code) {
       case DATA:
@@ -68,6 +68,37 @@ void BLO_memfile_free(MemFile *memfile)
   memfile->size = 0;
 }
 
+/* Size of the chunks of a copied memfile, the small chunks of undo steps are joined together. */
+#define MEMFILE_COPY_CHUNK_SIZE (16 * 1024 * 1024)
+
+MemFile *BLO_memfile_copy(const MemFile *memfile)
+{
+  MemFile *memfile_copy = MEM_callocN(sizeof(MemFile), __func__);
+
+  MemFileChunk *chunk_copy = NULL;
+  char *chunk_copy_buf = NULL;
+
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+    size_t offset = 0;
+    while (offset < chunk->size) {
+      if (chunk_copy == NULL || chunk_copy->size == MEMFILE_COPY_CHUNK_SIZE) {
+        chunk_copy = MEM_callocN(sizeof(MemFileChunk), "MemFileChunk copy");
+        chunk_copy_buf = MEM_mallocN(MEMFILE_COPY_CHUNK_SIZE, "Chunk buffer copy");
+        chunk_copy->buf = chunk_copy_buf;
+        BLI_addtail(&memfile_copy->chunks, chunk_copy);
+      }
+
+      const size_t size = MIN2(chunk->size - offset, MEMFILE_COPY_CHUNK_SIZE - chunk_copy->size);
+      memcpy(chunk_copy_buf + chunk_copy->size, chunk->buf + offset, size);
+      chunk_copy->size += size;
+      memfile_copy->size += size;
+      offset += size;
+    }
+  }
+
+  return memfile_copy;
+}
+
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
   /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
@@ -213,6 +244,14 @@ struct Main *BLO_memfile_main_get(struct MemFile *memfile,
 }
 
 bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
+{
+  return BLO_memfile_write_file_ex(memfile, filename, NULL, NULL);
+}
+
+bool BLO_memfile_write_file_ex(struct MemFile *memfile,
+                               const char *filename,
+                               const short *stop,
+                               float *progress)
 {
   MemFileChunk *chunk;
   int file, oflags;
@@ -243,6 +282,14 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
     return false;
   }
 
+  size_t written_size = 0;
+  size_t total_size = 0;
+  if (progress) {
+    LISTBASE_FOREACH (MemFileChunk *, chunk_iter, &memfile->chunks) {
+      total_size += chunk_iter->size;
+    }
+  }
+
   for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
 #ifdef _WIN32
     if ((size_t)write(file, chunk->buf, (uint)chunk->size) != chunk->size)
@@ -252,6 +299,15 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
     {
       break;
     }
+
+    if (progress && total_size) {
+      written_size += chunk->size;
+      *progress = (float)((double)written_size / (double)total_size);
+    }
+    if (stop && *stop) {
+      close(file);
+      return false;
+    }
   }
 
   close(file);
@@ -1113,6 +1113,8 @@ typedef struct DNA_ReconstructInfo {
 
   int *step_counts;
   ReconstructStep **steps;
+  /** Index in newsdna->structs for every struct in oldsdna, or -1 when it was removed. */
+  int *new_struct_nrs;
 } DNA_ReconstructInfo;
 
 static void reconstruct_structs(const DNA_ReconstructInfo *reconstruct_info,
@@ -1209,12 +1211,8 @@ void *DNA_struct_reconstruct(const DNA_ReconstructInfo *reconstruct_info,
                              int blocks,
                              const void *old_blocks)
 {
-  const SDNA *oldsdna = reconstruct_info->oldsdna;
   const SDNA *newsdna = reconstruct_info->newsdna;
-
-  const SDNA_Struct *old_struct = oldsdna->structs[old_struct_nr];
-  const char *type_name = oldsdna->types[old_struct->type];
-  const int new_struct_nr = DNA_struct_find_nr(newsdna, type_name);
+  const int new_struct_nr = reconstruct_info->new_struct_nrs[old_struct_nr];
 
   if (new_struct_nr == -1) {
     return NULL;
@@ -1501,6 +1499,124 @@ static int compress_reconstruct_steps(ReconstructStep *steps, const int old_step
   return new_step_count;
 }
 
+/**
+ * Upper bound for the number of steps a substruct step is replaced with when flattening. Larger
+ * arrays of structs are left as substruct steps, to keep the step arrays small.
+ */
+#define RECONSTRUCT_FLATTEN_MAX_STEPS 64
+
+static void offset_reconstruct_step(ReconstructStep *step,
+                                    const int old_offset,
+                                    const int new_offset)
+{
+  switch (step->type) {
+    case RECONSTRUCT_STEP_MEMCPY:
+      step->data.memcpy.old_offset += old_offset;
+      step->data.memcpy.new_offset += new_offset;
+      break;
+    case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+      step->data.cast_primitive.old_offset += old_offset;
+      step->data.cast_primitive.new_offset += new_offset;
+      break;
+    case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
+    case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
+      step->data.cast_pointer.old_offset += old_offset;
+      step->data.cast_pointer.new_offset += new_offset;
+      break;
+    case RECONSTRUCT_STEP_SUBSTRUCT:
+      step->data.substruct.old_offset += old_offset;
+      step->data.substruct.new_offset += new_offset;
+      break;
+    case RECONSTRUCT_STEP_INIT_ZERO:
+      break;
+  }
+}
+
+static bool reconstruct_step_can_flatten(const DNA_ReconstructInfo *reconstruct_info,
+                                         const ReconstructStep *step)
+{
+  if (step->type != RECONSTRUCT_STEP_SUBSTRUCT) {
+    return false;
+  }
+  const int substeps_len = reconstruct_info->step_counts[step->data.substruct.new_struct_nr];
+  return step->data.substruct.array_len * substeps_len <= RECONSTRUCT_FLATTEN_MAX_STEPS;
+}
+
+/**
+ * Replace substruct steps with the (already flattened) steps of the substruct, so that most
+ * structs are converted with a single flat list of steps, and memcpy steps of neighboring
+ * members of the substruct and the parent struct can be merged.
+ */
+static void flatten_reconstruct_steps(DNA_ReconstructInfo *reconstruct_info,
+                                      const int new_struct_nr,
+                                      bool *flattened)
+{
+  if (flattened[new_struct_nr]) {
+    return;
+  }
+  flattened[new_struct_nr] = true;
+
+  const SDNA *oldsdna = reconstruct_info->oldsdna;
+  const SDNA *newsdna = reconstruct_info->newsdna;
+  ReconstructStep *steps = reconstruct_info->steps[new_struct_nr];
+  const int steps_len = reconstruct_info->step_counts[new_struct_nr];
+
+  int flat_steps_len = 0;
+  bool can_flatten = false;
+  for (int a = 0; a < steps_len; a++) {
+    const ReconstructStep *step = &steps[a];
+    if (step->type == RECONSTRUCT_STEP_SUBSTRUCT) {
+      flatten_reconstruct_steps(reconstruct_info, step->data.substruct.new_struct_nr, flattened);
+    }
+    if (reconstruct_step_can_flatten(reconstruct_info, step)) {
+      flat_steps_len += step->data.substruct.array_len *
+                        reconstruct_info->step_counts[step->data.substruct.new_struct_nr];
+      can_flatten = true;
+    }
+    else {
+      flat_steps_len++;
+    }
+  }
+
+  if (!can_flatten) {
+    return;
+  }
+
+  ReconstructStep *flat_steps = MEM_malloc_arrayN(
+      MAX2(flat_steps_len, 1), sizeof(ReconstructStep), __func__);
+  int flat_step_index = 0;
+  for (int a = 0; a < steps_len; a++) {
+    const ReconstructStep *step = &steps[a];
+    if (!reconstruct_step_can_flatten(reconstruct_info, step)) {
+      flat_steps[flat_step_index++] = *step;
+      continue;
+    }
+
+    const int sub_new_struct_nr = step->data.substruct.new_struct_nr;
+    const int sub_old_struct_nr = step->data.substruct.old_struct_nr;
+    const ReconstructStep *substeps = reconstruct_info->steps[sub_new_struct_nr];
+    const int substeps_len = reconstruct_info->step_counts[sub_new_struct_nr];
+    const int old_size = oldsdna->types_size[oldsdna->structs[sub_old_struct_nr]->type];
+    const int new_size = newsdna->types_size[newsdna->structs[sub_new_struct_nr]->type];
+
+    for (int elem = 0; elem < step->data.substruct.array_len; elem++) {
+      for (int b = 0; b < substeps_len; b++) {
+        ReconstructStep *flat_step = &flat_steps[flat_step_index++];
+        *flat_step = substeps[b];
+        offset_reconstruct_step(flat_step,
+                                step->data.substruct.old_offset + elem * old_size,
+                                step->data.substruct.new_offset + elem * new_size);
+      }
+    }
+  }
+  BLI_assert(flat_step_index == flat_steps_len);
+
+  MEM_freeN(steps);
+  reconstruct_info->steps[new_struct_nr] = flat_steps;
+  reconstruct_info->step_counts[new_struct_nr] = compress_reconstruct_steps(flat_steps,
+                                                                            flat_steps_len);
+}
+
 DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
                                                  const SDNA *newsdna,
                                                  const char *compare_flags)
@@ -1512,6 +1628,11 @@ DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
   reconstruct_info->step_counts = MEM_malloc_arrayN(newsdna->structs_len, sizeof(int), __func__);
   reconstruct_info->steps = MEM_malloc_arrayN(
       newsdna->structs_len, sizeof(ReconstructStep *), __func__);
+  reconstruct_info->new_struct_nrs = MEM_malloc_arrayN(
+      oldsdna->structs_len, sizeof(int), __func__);
+  for (int old_struct_nr = 0; old_struct_nr < oldsdna->structs_len; old_struct_nr++) {
+    reconstruct_info->new_struct_nrs[old_struct_nr] = -1;
+  }
 
   /* Generate reconstruct steps for all structs. */
   for (int new_struct_nr = 0; new_struct_nr < newsdna->structs_len; new_struct_nr++) {
@@ -1523,6 +1644,7 @@ DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
       reconstruct_info->step_counts[new_struct_nr] = 0;
       continue;
     }
+    reconstruct_info->new_struct_nrs[old_struct_nr] = new_struct_nr;
     const SDNA_Struct *old_struct = oldsdna->structs[old_struct_nr];
     ReconstructStep *steps = create_reconstruct_steps_for_struct(
         oldsdna, newsdna, compare_flags, old_struct, new_struct);
@@ -1545,6 +1667,12 @@ DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
     UNUSED_VARS(print_reconstruct_step);
   }
 
+  bool *flattened = MEM_calloc_arrayN(newsdna->structs_len, sizeof(bool), __func__);
+  for (int new_struct_nr = 0; new_struct_nr < newsdna->structs_len; new_struct_nr++) {
+    flatten_reconstruct_steps(reconstruct_info, new_struct_nr, flattened);
+  }
+  MEM_freeN(flattened);
+
   return reconstruct_info;
 }
 
@@ -1557,6 +1685,7 @@ void DNA_reconstruct_info_free(DNA_ReconstructInfo *reconstruct_info)
   }
   MEM_freeN(reconstruct_info->steps);
   MEM_freeN(reconstruct_info->step_counts);
+  MEM_freeN(reconstruct_info->new_struct_nrs);
   MEM_freeN(reconstruct_info);
 }
 
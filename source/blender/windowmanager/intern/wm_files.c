@@ -1922,6 +1922,79 @@ static void wm_autosave_location(char *filepath)
   BLI_join_dirfile(filepath, FILE_MAX, BKE_tempdir_base(), path);
 }
 
+typedef struct AutosaveJob {
+  /** Copy of the undo memfile, so the undo stack can change while writing. */
+  MemFile *memfile;
+  char filepath[FILE_MAX];
+  bool success;
+  bool stopped;
+} AutosaveJob;
+
+static void wm_autosave_job_startjob(void *customdata,
+                                     short *stop,
+                                     short *UNUSED(do_update),
+                                     float *progress)
+{
+  AutosaveJob *job = customdata;
+
+  /* Write to a temporary file first, so a previous auto-save isn't lost when this one
+   * is interrupted. */
+  char tempname[FILE_MAX + 1];
+  BLI_snprintf(tempname, sizeof(tempname), "%s@", job->filepath);
+
+  job->success = BLO_memfile_write_file_ex(job->memfile, tempname, stop, progress);
+  job->stopped = *stop;
+
+  if (job->success) {
+    job->success = (BLI_rename(tempname, job->filepath) == 0);
+  }
+  else if (BLI_exists(tempname)) {
+    BLI_delete(tempname, false, false);
+  }
+}
+
+static void wm_autosave_job_endjob(void *customdata)
+{
+  AutosaveJob *job = customdata;
+
+  if (!job->success && !job->stopped) {
+    WM_reportf(RPT_ERROR, "Unable to auto-save to '%s'", job->filepath);
+  }
+}
+
+static void wm_autosave_job_free(void *customdata)
+{
+  AutosaveJob *job = customdata;
+
+  BLO_memfile_free(job->memfile);
+  MEM_freeN(job->memfile);
+  MEM_freeN(job);
+}
+
+/**
+ * Write the undo memfile in a job, only copying it in memory is done on the main thread.
+ */
+static void wm_autosave_write_job(wmWindowManager *wm, MemFile *memfile, const char *filepath)
+{
+  if (WM_jobs_test(wm, wm, WM_JOB_TYPE_AUTOSAVE)) {
+    /* The previous auto-save is still being written, skip this one. */
+    CLOG_INFO(&LOG, 1, "previous auto-save still running, skipping");
+    return;
+  }
+
+  AutosaveJob *job = MEM_callocN(sizeof(AutosaveJob), __func__);
+  job->memfile = BLO_memfile_copy(memfile);
+  BLI_strncpy(job->filepath, filepath, sizeof(job->filepath));
+
+  wmJob *wm_job = WM_jobs_get(
+      wm, wm->winactive, wm, "Auto-Saving...", WM_JOB_PROGRESS, WM_JOB_TYPE_AUTOSAVE);
+  WM_jobs_customdata_set(wm_job, job, wm_autosave_job_free);
+  WM_jobs_timer(wm_job, 0.1, 0, 0);
+  WM_jobs_callbacks(wm_job, wm_autosave_job_startjob, NULL, NULL, wm_autosave_job_endjob);
+
+  WM_jobs_start(wm, wm_job);
+}
+
 static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
 {
   char filepath[FILE_MAX];
@@ -1932,7 +2005,7 @@ static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
   const bool use_memfile = (U.uiflag & USER_GLOBALUNDO) != 0;
   MemFile *memfile = use_memfile ? ED_undosys_stack_memfile_get_active(wm->undo_stack) : NULL;
   if (memfile != NULL) {
-    BLO_memfile_write_file(memfile, filepath);
+    wm_autosave_write_job(wm, memfile, filepath);
   }
   else {
     if (use_memfile) {
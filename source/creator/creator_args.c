@@ -517,6 +517,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--render-output");
   BLI_args_print_arg_doc(ba, "--engine");
   BLI_args_print_arg_doc(ba, "--threads");
+  BLI_args_print_arg_doc(ba, "--use-persistent-data");
 
   printf("\n");
   printf("Format Options:\n");
@@ -1553,6 +1554,42 @@ static int arg_handle_extension_set(int argc, const char **argv, void *data)
   return 0;
 }
 
+static const char arg_handle_persistent_data_set_doc[] =
+    "<bool>\n"
+    "\tKeep render data between frames of an animation render, so that the render engine only\n"
+    "\tupdates what changed instead of converting the whole scene for every frame.\n"
+    "\tThis uses more memory, since the data is not freed while rendering.";
+static int arg_handle_persistent_data_set(int argc, const char **argv, void *data)
+{
+  bContext *C = data;
+  if (argc > 1) {
+    Scene *scene = CTX_data_scene(C);
+    if (scene) {
+      if (argv[1][0] == '0') {
+        scene->r.mode &= ~R_PERSISTENT_DATA;
+        DEG_id_tag_update(&scene->id, ID_RECALC_COPY_ON_WRITE);
+      }
+      else if (argv[1][0] == '1') {
+        scene->r.mode |= R_PERSISTENT_DATA;
+        DEG_id_tag_update(&scene->id, ID_RECALC_COPY_ON_WRITE);
+      }
+      else {
+        printf(
+            "\nError: Use '--use-persistent-data 1 / --use-persistent-data 0' To set the "
+            "persistent data option\n");
+      }
+    }
+    else {
+      printf(
+          "\nError: no blend loaded. "
+          "order the arguments so '--use-persistent-data' is after the blend is loaded.\n");
+    }
+    return 1;
+  }
+  printf("\nError: you must specify 0 or 1 after '--use-persistent-data'.\n");
+  return 0;
+}
+
 static const char arg_handle_render_frame_doc[] =
     "<frame>\n"
     "\tRender frame <frame> and save it.\n"
@@ -2248,6 +2285,7 @@ void main_args_setup(bContext *C, bArgs *ba)
 
   BLI_args_add(ba, "-F", "--render-format", CB(arg_handle_image_type_set), C);
   BLI_args_add(ba, "-x", "--use-extension", CB(arg_handle_extension_set), C);
+  BLI_args_add(ba, NULL, "--use-persistent-data", CB(arg_handle_persistent_data_set), C);
 
   BLI_args_add(ba, NULL, "--open-last", CB(arg_handle_load_last_file), C);
 
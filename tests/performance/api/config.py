@@ -246,6 +246,9 @@ class TestConfig:
             test_category = test.category()
 
             for device in self.devices:
+                if not test.use_device_type(device.type):
+                    continue
+
                 entry = self.queue.find(revision_name, test_name, test_category, device.id)
                 if entry:
                     # Test if revision hash or executable changed.
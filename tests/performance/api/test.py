@@ -24,6 +24,12 @@ class Test:
         """
         return False
 
+    def use_device_type(self, device_type: str) -> bool:
+        """
+        Test runs on devices of this type.
+        """
+        return True
+
     @abc.abstractmethod
     def run(self, env, device_id: str) -> Dict:
         """
@@ -0,0 +1,58 @@
+# Apache License, Version 2.0
+
+import api
+import pathlib
+import tempfile
+
+
+def _run(args):
+    import bpy
+    import time
+
+    filepath = args['filepath']
+    resaved_filepath = args['resaved_filepath']
+
+    # Load once to ensure it's cached by OS, and save a copy in the current version
+    # to compare against.
+    bpy.ops.wm.open_mainfile(filepath=filepath)
+    bpy.ops.wm.save_as_mainfile(filepath=resaved_filepath, compress=False, copy=True)
+    bpy.ops.wm.read_homefile()
+
+    # Measure loading the file as saved by the older version, including versioning.
+    start_time = time.time()
+    bpy.ops.wm.open_mainfile(filepath=filepath)
+    elapsed_time = time.time() - start_time
+    bpy.ops.wm.read_homefile()
+
+    # Measure loading the copy saved by the current version.
+    start_time = time.time()
+    bpy.ops.wm.open_mainfile(filepath=resaved_filepath)
+    resaved_elapsed_time = time.time() - start_time
+
+    result = {'time': elapsed_time, 'time_resaved': resaved_elapsed_time}
+    return result
+
+
+class BlendLoadVersioningTest(api.Test):
+    def __init__(self, filepath):
+        self.filepath = filepath
+
+    def name(self):
+        return self.filepath.stem
+
+    def category(self):
+        return "blend_load_versioning"
+
+    def run(self, env, device_id):
+        with tempfile.TemporaryDirectory() as tempdir:
+            args = {'filepath': str(self.filepath),
+                    'resaved_filepath': str(pathlib.Path(tempdir) / self.filepath.name)}
+            result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    # Files saved by older Blender versions, so that loading them goes through
+    # DNA struct reconstruction.
+    filepaths = env.find_blend_files('blend_load_versioning/*')
+    return [BlendLoadVersioningTest(filepath) for filepath in filepaths]
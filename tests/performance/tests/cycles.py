@@ -16,6 +16,7 @@ def _run(args):
     scene.render.filepath = args['render_filepath']
     scene.render.image_settings.file_format = 'PNG'
     scene.cycles.device = 'CPU' if device_type == 'CPU' else 'GPU'
+    scene.cycles.debug_use_cpu_wavefront = args['use_wavefront']
 
     if scene.cycles.use_adaptive_sampling:
         # Render samples specified in file, no other way to measure
@@ -52,10 +53,14 @@ def _run(args):
 
 
 class CyclesTest(api.Test):
-    def __init__(self, filepath):
+    def __init__(self, filepath, use_wavefront=False):
         self.filepath = filepath
+        self.use_wavefront = use_wavefront
 
     def name(self):
+        # Wavefront CPU path tracing, compare against the default megakernel.
+        if self.use_wavefront:
+            return self.filepath.stem + "_wavefront"
         return self.filepath.stem
 
     def category(self):
@@ -64,13 +69,18 @@ class CyclesTest(api.Test):
     def use_device(self):
         return True
 
+    def use_device_type(self, device_type):
+        # Wavefront is a CPU only option, on other devices it would render the same as the default.
+        return device_type == 'CPU' or not self.use_wavefront
+
     def run(self, env, device_id):
         tokens = device_id.split('_')
         device_type = tokens[0]
         device_index = int(tokens[1]) if len(tokens) > 1 else 0
         args = {'device_type': device_type,
                 'device_index': device_index,
-                'render_filepath': str(env.log_file.parent / (env.log_file.stem + '.png'))}
+                'render_filepath': str(env.log_file.parent / (env.log_file.stem + '.png')),
+                'use_wavefront': self.use_wavefront}
 
         _, lines = env.run_in_blender(_run, args, ['--debug-cycles', '--verbose', '2', self.filepath])
 
@@ -109,4 +119,8 @@ class CyclesTest(api.Test):
 
 def generate(env):
     filepaths = env.find_blend_files('cycles/*')
-    return [CyclesTest(filepath) for filepath in filepaths]
+    tests = []
+    for filepath in filepaths:
+        tests.append(CyclesTest(filepath))
+        tests.append(CyclesTest(filepath, use_wavefront=True))
+    return tests